@@ -33,25 +33,25 @@
 namespace DRAMSim
 {
 
-void addressMapping(uint64_t physicalAddress, unsigned &newTransactionChan, unsigned &newTransactionRank, unsigned &newTransactionBank, unsigned &newTransactionRow, unsigned &newTransactionColumn)
+void addressMapping(const Config &config, uint64_t physicalAddress, unsigned &newTransactionChan, unsigned &newTransactionRank, unsigned &newTransactionBank, unsigned &newTransactionRow, unsigned &newTransactionColumn)
 {
 	uint64_t origAddress = physicalAddress;
 	uint64_t tempA, tempB;
-	unsigned transactionSize = TRANSACTION_SIZE;
+	unsigned transactionSize = config.TRANSACTION_SIZE;
 	uint64_t transactionMask =  transactionSize - 1; //ex: (64 bit bus width) x (8 Burst Length) - 1 = 64 bytes - 1 = 63 = 0x3f mask
-	unsigned channelBitWidth = NUM_CHANS_LOG;
-	unsigned rankBitWidth = NUM_RANKS_LOG;
-	unsigned bankBitWidth = NUM_BANKS_LOG;
-	unsigned rowBitWidth = NUM_ROWS_LOG;
-	unsigned colBitWidth = NUM_COLS_LOG;
+	unsigned channelBitWidth = config.NUM_CHANS_LOG;
+	unsigned rankBitWidth = config.NUM_RANKS_LOG;
+	unsigned bankBitWidth = config.NUM_BANKS_LOG;
+	unsigned rowBitWidth = config.NUM_ROWS_LOG;
+	unsigned colBitWidth = config.NUM_COLS_LOG;
 	// this forces the alignment to the width of a single burst (64 bits = 8 bytes = 3 address bits for DDR parts)
-	unsigned byteOffsetWidth = BYTE_OFFSET_WIDTH;
+	unsigned byteOffsetWidth = config.BYTE_OFFSET_WIDTH;
 	// Since we're assuming that a request is for BL*BUS_WIDTH, the bottom bits
 	// of this address *should* be all zeros if it's not, issue a warning
 
 	if ((physicalAddress & transactionMask) != 0)
 	{
-		DEBUG("WARNING: address 0x"<<std::hex<<physicalAddress<<std::dec<<" is not aligned to the request size of "<<transactionSize); 
+		DEBUG_LIMITED("WARNING: address 0x"<<std::hex<<physicalAddress<<std::dec<<" is not aligned to the request size of "<<transactionSize);
 	}
 
 	// each burst will contain JEDEC_DATA_BUS_BITS/8 bytes of data, so the bottom bits (3 bits for a single channel DDR system) are
@@ -75,11 +75,11 @@ void addressMapping(uint64_t physicalAddress, unsigned &newTransactionChan, unsi
 	// from the bottom bits of the column 
 	// 
 	// For example: cowLowBits = log2(64bytes) - 3 bits = 3 bits 
-	unsigned colLowBitWidth = COL_LOW_BIT_WIDTH;
+	unsigned colLowBitWidth = config.COL_LOW_BIT_WIDTH;
 
 	physicalAddress >>= colLowBitWidth;
 	unsigned colHighBitWidth = colBitWidth - colLowBitWidth; 
-	if (DEBUG_ADDR_MAP)
+	if (config.DEBUG_ADDR_MAP)
 	{
 		DEBUG("Bit widths: ch:"<<channelBitWidth<<" r:"<<rankBitWidth<<" b:"<<bankBitWidth
 				<<" row:"<<rowBitWidth<<" colLow:"<<colLowBitWidth
@@ -88,7 +88,7 @@ void addressMapping(uint64_t physicalAddress, unsigned &newTransactionChan, unsi
 	}
 
 	//perform various address mapping schemes
-	if (addressMappingScheme == Scheme1)
+	if (config.addressMappingScheme == Scheme1)
 	{
 		//chan:rank:row:col:bank
 		tempA = physicalAddress;
@@ -117,7 +117,7 @@ void addressMapping(uint64_t physicalAddress, unsigned &newTransactionChan, unsi
 		newTransactionChan = tempA ^ tempB;
 
 	}
-	else if (addressMappingScheme == Scheme2)
+	else if (config.addressMappingScheme == Scheme2)
 	{
 		//chan:row:col:bank:rank
 		
@@ -140,7 +140,7 @@ void addressMapping(uint64_t physicalAddress, unsigned &newTransactionChan, unsi
 		newTransactionChan = 0;
 		
 	}
-	else if (addressMappingScheme == Scheme3)
+	else if (config.addressMappingScheme == Scheme3)
 	{
 		//chan:rank:bank:col:row
 		tempA = physicalAddress;
@@ -169,7 +169,7 @@ void addressMapping(uint64_t physicalAddress, unsigned &newTransactionChan, unsi
 		newTransactionChan = tempA ^ tempB;
 
 	}
-	else if (addressMappingScheme == Scheme4)
+	else if (config.addressMappingScheme == Scheme4)
 	{
 		//chan:rank:bank:row:col
 		tempA = physicalAddress;
@@ -198,7 +198,7 @@ void addressMapping(uint64_t physicalAddress, unsigned &newTransactionChan, unsi
 		newTransactionChan = tempA ^ tempB;
 
 	}
-	else if (addressMappingScheme == Scheme5)
+	else if (config.addressMappingScheme == Scheme5)
 	{
 		//chan:row:col:rank:bank
 
@@ -229,7 +229,7 @@ void addressMapping(uint64_t physicalAddress, unsigned &newTransactionChan, unsi
 
 
 	}
-	else if (addressMappingScheme == Scheme6)
+	else if (config.addressMappingScheme == Scheme6)
 	{
 		//chan:row:bank:rank:col
 
@@ -261,7 +261,7 @@ void addressMapping(uint64_t physicalAddress, unsigned &newTransactionChan, unsi
 
 	}
 	// clone of scheme 5, but channel moved to lower bits
-	else if (addressMappingScheme == Scheme7)
+	else if (config.addressMappingScheme == Scheme7)
 	{
 		//row:col:rank:bank:chan
 		tempA = physicalAddress;
@@ -296,7 +296,7 @@ void addressMapping(uint64_t physicalAddress, unsigned &newTransactionChan, unsi
 		ERROR("== Error - Unknown Address Mapping Scheme");
 		exit(-1);
 	}
-	if (DEBUG_ADDR_MAP)
+	if (config.DEBUG_ADDR_MAP)
 	{
 		DEBUG("Mapped Ch="<<newTransactionChan<<" Rank="<<newTransactionRank
 				<<" Bank="<<newTransactionBank<<" Row="<<newTransactionRow
@@ -304,4 +304,33 @@ void addressMapping(uint64_t physicalAddress, unsigned &newTransactionChan, unsi
 	}
 
 }
+
+ChannelSelect channelSelect(const Config &config)
+{
+	//schemes 1 and 3-6 put the channel above the rank, bank, row and column
+	//high fields, scheme 7 right at the bottom
+	unsigned colHighBitWidth = config.NUM_COLS_LOG - config.COL_LOW_BIT_WIDTH;
+	unsigned below = 0;
+	switch (config.addressMappingScheme)
+	{
+		case Scheme1:
+		case Scheme3:
+		case Scheme4:
+		case Scheme5:
+		case Scheme6:
+			below = config.NUM_RANKS_LOG + config.NUM_BANKS_LOG + config.NUM_ROWS_LOG + colHighBitWidth;
+			break;
+		case Scheme7:
+			below = 0;
+			break;
+		default:
+			break;
+	}
+
+	ChannelSelect select;
+	select.shift = config.BYTE_OFFSET_WIDTH + config.COL_LOW_BIT_WIDTH + below;
+	//scheme 2 always maps to channel 0
+	select.mask = config.addressMappingScheme == Scheme2 ? 0 : (1ULL << config.NUM_CHANS_LOG) - 1;
+	return select;
+}
 };
@@ -29,9 +29,24 @@
 *********************************************************************************/
 #ifndef ADDRESS_MAPPING_H
 #define ADDRESS_MAPPING_H
+#include "SystemConfiguration.h"
+
 namespace DRAMSim
 {
-	void addressMapping(uint64_t physicalAddress, unsigned &channel, unsigned &rank, unsigned &bank, unsigned &row, unsigned &col);
+	void addressMapping(const Config &config, uint64_t physicalAddress, unsigned &channel, unsigned &rank, unsigned &bank, unsigned &row, unsigned &col);
+
+	// the channel field of addressMapping() as a shift and mask, for picking
+	// a channel without mapping the rest of the address
+	struct ChannelSelect
+	{
+		unsigned shift;
+		uint64_t mask;
+		unsigned channel(uint64_t physicalAddress) const
+		{
+			return (physicalAddress >> shift) & mask;
+		}
+	};
+	ChannelSelect channelSelect(const Config &config);
 }
 
 #endif
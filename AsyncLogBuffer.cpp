@@ -0,0 +1,195 @@
+/*********************************************************************************
+*  Copyright (c) 2010-2011, Elliott Cooper-Balis
+*                             Paul Rosenfeld
+*                             Bruce Jacob
+*                             University of Maryland 
+*                             dramninjas [at] gmail [dot] com
+*  All rights reserved.
+*  
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*  
+*     * Redistributions of source code must retain the above copyright notice,
+*        this list of conditions and the following disclaimer.
+*  
+*     * Redistributions in binary form must reproduce the above copyright notice,
+*        this list of conditions and the following disclaimer in the documentation
+*        and/or other materials provided with the distribution.
+*  
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+*  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+*  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+*  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************************/
+
+//AsyncLogBuffer.cpp
+//
+//Block buffering and the background writer for logs
+//
+
+#include "AsyncLogBuffer.h"
+
+using namespace DRAMSim;
+using namespace std;
+
+AsyncLogBuffer::AsyncLogBuffer(size_t blockSize_) :
+	blockSize(blockSize_),
+	stream(NULL),
+	target(NULL),
+	writing(false),
+	stopping(false)
+{
+}
+
+AsyncLogBuffer::~AsyncLogBuffer()
+{
+	detach();
+}
+
+// everything written to the stream from now on goes through this buffer
+void AsyncLogBuffer::attach(ostream &stream_)
+{
+	detach();
+	stream = &stream_;
+	target = stream->rdbuf(this);
+	stopping = false;
+	startBlock();
+	thread = std::thread(&AsyncLogBuffer::writer, this);
+}
+
+// writes out everything and gives the stream its own buffer back
+void AsyncLogBuffer::detach()
+{
+	if (stream == NULL)
+	{
+		return;
+	}
+	flush();
+	{
+		lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	blocksReady.notify_one();
+	thread.join();
+	stream->rdbuf(target);
+	stream = NULL;
+	target = NULL;
+	setp(NULL, NULL);
+}
+
+// returns once everything written so far has reached the target
+void AsyncLogBuffer::flush()
+{
+	if (stream == NULL)
+	{
+		return;
+	}
+	handOff();
+	unique_lock<std::mutex> lock(mutex);
+	while (!fullBlocks.empty() || writing)
+	{
+		blocksWritten.wait(lock);
+	}
+	target->pubsync();
+}
+
+int AsyncLogBuffer::overflow(int c)
+{
+	handOff();
+	if (c != traits_type::eof())
+	{
+		*pptr() = c;
+		pbump(1);
+	}
+	return traits_type::not_eof(c);
+}
+
+streamsize AsyncLogBuffer::xsputn(const char *s, streamsize n)
+{
+	streamsize written = 0;
+	while (written < n)
+	{
+		if (pptr() == epptr())
+		{
+			handOff();
+		}
+		streamsize chunk = min<streamsize>(n - written, epptr() - pptr());
+		traits_type::copy(pptr(), s + written, chunk);
+		pbump(chunk);
+		written += chunk;
+	}
+	return n;
+}
+
+// endl flushes the stream after every line; the blocks are written when
+// they are full instead
+int AsyncLogBuffer::sync()
+{
+	return 0;
+}
+
+// queues the current block (if anything is in it) for the writer
+void AsyncLogBuffer::handOff()
+{
+	if (pptr() == pbase())
+	{
+		return;
+	}
+	block.resize(pptr() - pbase());
+	{
+		lock_guard<std::mutex> lock(mutex);
+		fullBlocks.push_back(std::vector<char>());
+		fullBlocks.back().swap(block);
+	}
+	blocksReady.notify_one();
+	startBlock();
+}
+
+void AsyncLogBuffer::startBlock()
+{
+	{
+		lock_guard<std::mutex> lock(mutex);
+		if (!spareBlocks.empty())
+		{
+			block.swap(spareBlocks.back());
+			spareBlocks.pop_back();
+		}
+	}
+	block.resize(blockSize);
+	setp(&block[0], &block[0] + block.size());
+}
+
+void AsyncLogBuffer::writer()
+{
+	unique_lock<std::mutex> lock(mutex);
+	while (true)
+	{
+		while (fullBlocks.empty() && !stopping)
+		{
+			blocksReady.wait(lock);
+		}
+		if (fullBlocks.empty())
+		{
+			return;
+		}
+		std::vector<char> full;
+		full.swap(fullBlocks.front());
+		fullBlocks.pop_front();
+		writing = true;
+		lock.unlock();
+
+		target->sputn(&full[0], full.size());
+
+		lock.lock();
+		writing = false;
+		spareBlocks.push_back(std::vector<char>());
+		spareBlocks.back().swap(full);
+		blocksWritten.notify_all();
+	}
+}
@@ -0,0 +1,89 @@
+/*********************************************************************************
+*  Copyright (c) 2010-2011, Elliott Cooper-Balis
+*                             Paul Rosenfeld
+*                             Bruce Jacob
+*                             University of Maryland 
+*                             dramninjas [at] gmail [dot] com
+*  All rights reserved.
+*  
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*  
+*     * Redistributions of source code must retain the above copyright notice,
+*        this list of conditions and the following disclaimer.
+*  
+*     * Redistributions in binary form must reproduce the above copyright notice,
+*        this list of conditions and the following disclaimer in the documentation
+*        and/or other materials provided with the distribution.
+*  
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+*  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+*  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+*  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************************/
+#ifndef ASYNCLOGBUFFER_H
+#define ASYNCLOGBUFFER_H
+
+//AsyncLogBuffer.h
+//
+//Output buffer for logs that are written a line at a time
+//
+
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace DRAMSim
+{
+// Takes over the output of a stream, collects it in large blocks and has a
+// background thread write the full blocks to the stream's own buffer, so a
+// line (even one ended with endl) only costs a copy. Nothing is written
+// until a block fills or flush() is called.
+class AsyncLogBuffer : public std::streambuf
+{
+public:
+	AsyncLogBuffer(size_t blockSize_ = 1<<20);
+	~AsyncLogBuffer();
+	void attach(std::ostream &stream_);
+	void detach();
+	void flush();
+
+protected:
+	int overflow(int c);
+	std::streamsize xsputn(const char *s, std::streamsize n);
+	int sync();
+
+private:
+	AsyncLogBuffer(const AsyncLogBuffer &);
+	AsyncLogBuffer &operator=(const AsyncLogBuffer &);
+	void handOff();
+	void startBlock();
+	void writer();
+
+	size_t blockSize;
+	std::ostream *stream;
+	std::streambuf *target;
+	std::vector<char> block;
+
+	//shared with the writer thread
+	std::mutex mutex;
+	std::condition_variable blocksReady;
+	std::condition_variable blocksWritten;
+	std::deque< std::vector<char> > fullBlocks;
+	std::vector< std::vector<char> > spareBlocks;
+	bool writing;
+	bool stopping;
+	std::thread thread;
+};
+}
+
+#endif
@@ -35,66 +35,67 @@
 
 #include "Bank.h"
 #include "BusPacket.h"
+#include <string.h>
+#include <algorithm>
 
 using namespace std;
 using namespace DRAMSim;
 
-Bank::Bank(ostream &dramsim_log_):
-		currentState(dramsim_log_), 
-		rowEntries(NUM_COLS),
-		dramsim_log(dramsim_log_)
-{}
+Bank::Bank(const Config &config_, ostream &dramsim_log_):
+		config(config_),
+		dramsim_log(dramsim_log_),
+		columnsPerRow(config.NUM_COLS >> config.COL_LOW_BIT_WIDTH),
+		unwritten(config.TRANSACTION_SIZE, 0)
+{
+	// tracer value
+	uint64_t deadbeef = 0xdeadbeef;
+	memcpy(&unwritten[0], &deadbeef, min(sizeof(deadbeef), unwritten.size()));
+}
 
 /* The bank class is just a glorified sparse storage data structure
  * that keeps track of written data in case the simulator wants a
  * function DRAM model
  *
- * A vector of size NUM_COLS keeps a linked list of rows and their
- * associated values.
+ * A hash table maps each row that has been written to a page with a
+ * TRANSACTION_SIZE cell for each of its columns, so memory grows with
+ * the rows a run touches rather than with the size of the device.
  *
- * write() adds an entry to the proper linked list or replaces the
- * 	value in a row that was already written
+ * write() copies the data of a write into its cell, allocating the page
+ * 	on the first write to the row
  *
- * read() searches for a node with the right row value, if not found
- * 	returns the tracer value 0xDEADBEEF
+ * read() points the packet at the cell, or at the shared cell holding the
+ * 	tracer value 0xDEADBEEF if the row or column was never written; the
+ * 	data stays valid until the next write to the same column
  * 
  *	TODO: if anyone wants to actually store data, see the 'data_storage' branch and perhaps try to merge that into master
  */
 
-
-
-Bank::DataStruct *Bank::searchForRow(unsigned row, DataStruct *head)
+void Bank::checkColumn(const BusPacket *busPacket) const
 {
-	while (head != NULL)
+	//TODO: move all the error checking to BusPacket so once we have a bus packet,
+	//			we know the fields are all legal
+
+	if (busPacket->column >= columnsPerRow)
 	{
-		if (head->row == row)
-		{
-			//found it
-			return head;
-		}
-		//keep looking
-		head = head->next;
+		ERROR("== Error - Bus Packet column "<< busPacket->column <<" out of bounds");
+		exit(-1);
 	}
-	//if we get here, didn't find it
-	return NULL;
 }
 
 void Bank::read(BusPacket *busPacket)
 {
-	DataStruct *rowHeadNode = rowEntries[busPacket->column];
-	DataStruct *foundNode = NULL;
+	checkColumn(busPacket);
 
-	if ((foundNode = Bank::searchForRow(busPacket->row, rowHeadNode)) == NULL)
+	unordered_map<unsigned, Page>::iterator page = pages.find(busPacket->row);
+	if (page == pages.end())
 	{
-		// the row hasn't been written before, so it isn't in the list
+		// the row hasn't been written before
 		//if(SHOW_SIM_OUTPUT) DEBUG("== Warning - Read from previously unwritten row " << busPacket->row);
-		void *garbage = calloc(BL * (JEDEC_DATA_BUS_BITS/8),1);
-		((long *)garbage)[0] = 0xdeadbeef; // tracer value
-		busPacket->data = garbage;
+		busPacket->data = &unwritten[0];
 	}
 	else // found it
 	{
-		busPacket->data = foundNode->data;
+		busPacket->data = &page->second[busPacket->column * config.TRANSACTION_SIZE];
 	}
 
 	//the return packet should be a data packet, not a read packet
@@ -104,41 +105,28 @@ void Bank::read(BusPacket *busPacket)
 
 void Bank::write(const BusPacket *busPacket)
 {
-	//TODO: move all the error checking to BusPacket so once we have a bus packet,
-	//			we know the fields are all legal
-
-	if (busPacket->column >= NUM_COLS)
+	checkColumn(busPacket);
+	if (busPacket->data == NULL)
 	{
-		ERROR("== Error - Bus Packet column "<< busPacket->column <<" out of bounds");
-		exit(-1);
+		return;
 	}
 
-	// head of the list we need to search
-	DataStruct *rowHeadNode = rowEntries[busPacket->column];
-	DataStruct *foundNode = NULL;
-
-	if ((foundNode = Bank::searchForRow(busPacket->row, rowHeadNode)) == NULL)
-	{
-		//not found
-		DataStruct *newRowNode = (DataStruct *)malloc(sizeof(DataStruct));
-
-		//insert at the head for speed
-		//TODO: Optimize this data structure for speedier lookups?
-		newRowNode->row = busPacket->row;
-		newRowNode->data = busPacket->data;
-		newRowNode->next = rowHeadNode;
-		rowEntries[busPacket->column] = newRowNode;
-	}
-	else
+	Page &page = pages[busPacket->row];
+	if (page.empty())
 	{
-		// found it, just plaster in the new data
-		foundNode->data = busPacket->data;
-		if (DEBUG_BANKS)
+		//every column of a new page reads as unwritten until it is written
+		page.resize(columnsPerRow * config.TRANSACTION_SIZE);
+		for (size_t i=0; i<columnsPerRow; i++)
 		{
-			PRINTN(" -- Bank "<<busPacket->bank<<" writing to physical address 0x" << hex << busPacket->physicalAddress<<dec<<":");
-			busPacket->printData();
-			PRINT("");
+			memcpy(&page[i * config.TRANSACTION_SIZE], &unwritten[0], config.TRANSACTION_SIZE);
 		}
 	}
-}
+	memcpy(&page[busPacket->column * config.TRANSACTION_SIZE], busPacket->data, config.TRANSACTION_SIZE);
 
+	if (config.DEBUG_BANKS)
+	{
+		PRINTN(" -- Bank "<<busPacket->bank<<" writing to physical address 0x" << hex << busPacket->physicalAddress<<dec<<":");
+		busPacket->printData();
+		PRINT("");
+	}
+}
@@ -48,33 +48,32 @@
 #include "BankState.h"
 #include "BusPacket.h"
 #include <iostream>
+#include <vector>
+#include <unordered_map>
 
 namespace DRAMSim
 {
 class Bank
 {
-	typedef struct _DataStruct
-	{
-		unsigned row;
-		void *data;
-		struct _DataStruct *next;
-	} DataStruct;
+	// a row's data, one TRANSACTION_SIZE cell per column the controller
+	// addresses; allocated on the first write to the row
+	typedef std::vector<unsigned char> Page;
 
 public:
 	//functions
-	Bank(ostream &dramsim_log_);
+	Bank(const Config &config_, ostream &dramsim_log_);
 	void read(BusPacket *busPacket);
 	void write(const BusPacket *busPacket);
 
-	//fields
-	BankState currentState;
-
 private:
 	// private member
-	std::vector<DataStruct *> rowEntries;
+	const Config &config;
 	ostream &dramsim_log; 
+	unsigned columnsPerRow;
+	std::unordered_map<unsigned, Page> pages; //by row
+	Page unwritten; //one cell, what every column nobody wrote reads as
 
-	static DataStruct *searchForRow(unsigned row, DataStruct *head);
+	void checkColumn(const BusPacket *busPacket) const;
 };
 }
 
@@ -46,43 +46,178 @@ using namespace std;
 using namespace DRAMSim;
 
 //All banks start precharged
-BankState::BankState(ostream &dramsim_log_):
+BankStates::BankStates(unsigned numBanks, ostream &dramsim_log_):
 		dramsim_log(dramsim_log_),
-		currentBankState(Idle),
-		openRowAddress(0),
-		nextRead(0),
-		nextWrite(0),
-		nextActivate(0),
-		nextPrecharge(0),
-		nextPowerUp(0),
-		lastCommand(READ),
-		stateChangeCountdown(0)
+		currentBankState(numBanks, Idle),
+		openRowAddress(numBanks, 0),
+		nextRead(numBanks, 0),
+		nextWrite(numBanks, 0),
+		nextActivate(numBanks, 0),
+		nextPrecharge(numBanks, 0),
+		nextPowerUp(numBanks, 0),
+		lastCommand(numBanks, READ),
+		stateChangeCountdown(numBanks, 0),
+		stateChanges(0),
+		expired(numBanks, 0)
 {}
 
-void BankState::print()
+void BankStates::delay(vector<uint64_t> &next, uint64_t cycle)
+{
+	uint64_t *n = next.data();
+	for (size_t b=0; b<next.size(); b++)
+	{
+		n[b] = max(n[b], cycle);
+	}
+}
+
+void BankStates::delayActive(vector<uint64_t> &next, uint64_t cycle)
+{
+	uint64_t *n = next.data();
+	const CurrentBankState *state = currentBankState.data();
+	for (size_t b=0; b<next.size(); b++)
+	{
+		n[b] = state[b] == RowActive ? max(n[b], cycle) : n[b];
+	}
+}
+
+bool BankStates::all(CurrentBankState state) const
+{
+	unsigned count = 0;
+	for (size_t b=0; b<size(); b++)
+	{
+		count += currentBankState[b] == state;
+	}
+	return count == size();
+}
+
+bool BankStates::any(CurrentBankState state) const
+{
+	unsigned count = 0;
+	for (size_t b=0; b<size(); b++)
+	{
+		count += currentBankState[b] == state;
+	}
+	return count != 0;
+}
+
+void BankStates::set(CurrentBankState state)
+{
+	fill(currentBankState.begin(), currentBankState.end(), state);
+	stateChanges++;
+}
+
+bool BankStates::isCountingDown() const
+{
+	unsigned pending = 0;
+	for (size_t b=0; b<size(); b++)
+	{
+		pending |= stateChangeCountdown[b];
+	}
+	return pending != 0;
+}
+
+// decrements every bank's state change countdown; the few banks whose
+// countdown reached 0 this cycle then make their implicit state change
+void BankStates::countDown(unsigned tRP)
+{
+	unsigned *countdown = stateChangeCountdown.data();
+	unsigned char *e = expired.data();
+	unsigned anyExpired = 0;
+	for (size_t b=0; b<size(); b++)
+	{
+		e[b] = countdown[b] == 1;
+		countdown[b] -= countdown[b] != 0;
+		anyExpired |= e[b];
+	}
+	if (!anyExpired)
+	{
+		return;
+	}
+	stateChanges++;
+
+	for (size_t b=0; b<size(); b++)
+	{
+		if (!e[b])
+		{
+			continue;
+		}
+		switch (lastCommand[b])
+		{
+			//only these commands have an implicit state change
+		case WRITE_P:
+		case READ_P:
+			currentBankState[b] = Precharging;
+			lastCommand[b] = PRECHARGE;
+			stateChangeCountdown[b] = tRP;
+			break;
+
+		case REFRESH:
+		case PRECHARGE:
+			currentBankState[b] = Idle;
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+void BankStates::print(size_t bank)
 {
 	PRINT(" == Bank State ");
-	if (currentBankState == Idle)
+	if (currentBankState[bank] == Idle)
 	{
 		PRINT("    State : Idle" );
 	}
-	else if (currentBankState == RowActive)
+	else if (currentBankState[bank] == RowActive)
 	{
 		PRINT("    State : Active" );
 	}
-	else if (currentBankState == Refreshing)
+	else if (currentBankState[bank] == Refreshing)
 	{
 		PRINT("    State : Refreshing" );
 	}
-	else if (currentBankState == PowerDown)
+	else if (currentBankState[bank] == PowerDown)
 	{
 		PRINT("    State : Power Down" );
 	}
 
-	PRINT("    OpenRowAddress : " << openRowAddress );
-	PRINT("    nextRead       : " << nextRead );
-	PRINT("    nextWrite      : " << nextWrite );
-	PRINT("    nextActivate   : " << nextActivate );
-	PRINT("    nextPrecharge  : " << nextPrecharge );
-	PRINT("    nextPowerUp    : " << nextPowerUp );
+	PRINT("    OpenRowAddress : " << openRowAddress[bank] );
+	PRINT("    nextRead       : " << nextRead[bank] );
+	PRINT("    nextWrite      : " << nextWrite[bank] );
+	PRINT("    nextActivate   : " << nextActivate[bank] );
+	PRINT("    nextPrecharge  : " << nextPrecharge[bank] );
+	PRINT("    nextPowerUp    : " << nextPowerUp[bank] );
+}
+
+// one bank after the other, as the checkpoint format has always had it
+void BankStates::serialize(CheckpointOut &cp) const
+{
+	for (size_t b=0; b<size(); b++)
+	{
+		cp.put(currentBankState[b]);
+		cp.put(openRowAddress[b]);
+		cp.put(nextRead[b]);
+		cp.put(nextWrite[b]);
+		cp.put(nextActivate[b]);
+		cp.put(nextPrecharge[b]);
+		cp.put(nextPowerUp[b]);
+		cp.put(lastCommand[b]);
+		cp.put(stateChangeCountdown[b]);
+	}
+}
+
+void BankStates::unserialize(CheckpointIn &cp)
+{
+	for (size_t b=0; b<size(); b++)
+	{
+		cp.get(currentBankState[b]);
+		cp.get(openRowAddress[b]);
+		cp.get(nextRead[b]);
+		cp.get(nextWrite[b]);
+		cp.get(nextActivate[b]);
+		cp.get(nextPrecharge[b]);
+		cp.get(nextPowerUp[b]);
+		cp.get(lastCommand[b]);
+		cp.get(stateChangeCountdown[b]);
+	}
 }
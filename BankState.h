@@ -45,6 +45,10 @@
 
 #include "SystemConfiguration.h"
 #include "BusPacket.h"
+#include "Checkpoint.h"
+#include <vector>
+
+using namespace std;
 
 namespace DRAMSim
 {
@@ -57,25 +61,49 @@ enum CurrentBankState
 	PowerDown
 };
 
-class BankState
+// The states of the banks of one rank. Every field is an array indexed by
+// bank, so the walks the controller and the ranks do over all the banks of a
+// rank every cycle are loops over contiguous arrays the compiler vectorises.
+class BankStates
 {
 	ostream &dramsim_log; 
 public:
 	//Fields
-	CurrentBankState currentBankState;
-	unsigned openRowAddress;
-	uint64_t nextRead;
-	uint64_t nextWrite;
-	uint64_t nextActivate;
-	uint64_t nextPrecharge;
-	uint64_t nextPowerUp;
+	vector<CurrentBankState> currentBankState;
+	vector<unsigned> openRowAddress;
+	vector<uint64_t> nextRead;
+	vector<uint64_t> nextWrite;
+	vector<uint64_t> nextActivate;
+	vector<uint64_t> nextPrecharge;
+	vector<uint64_t> nextPowerUp;
+
+	vector<BusPacketType> lastCommand;
+	vector<unsigned> stateChangeCountdown;
 
-	BusPacketType lastCommand;
-	unsigned stateChangeCountdown;
+	//bumped when a bank changes state on its own (a countdown running out,
+	//power down/up) rather than because of a command from the queue
+	unsigned stateChanges;
 
 	//Functions
-	BankState(ostream &dramsim_log_);
-	void print();
+	BankStates(unsigned numBanks, ostream &dramsim_log_);
+	size_t size() const { return currentBankState.size(); }
+
+	// next[b] = max(next[b], cycle) for every bank, or only the banks with an open row
+	static void delay(vector<uint64_t> &next, uint64_t cycle);
+	void delayActive(vector<uint64_t> &next, uint64_t cycle);
+
+	bool all(CurrentBankState state) const;
+	bool any(CurrentBankState state) const;
+	void set(CurrentBankState state);
+	bool isCountingDown() const;
+	void countDown(unsigned tRP);
+
+	void print(size_t bank);
+	void serialize(CheckpointOut &cp) const;
+	void unserialize(CheckpointIn &cp);
+
+private:
+	vector<unsigned char> expired;
 };
 }
 
@@ -60,45 +60,49 @@ BusPacket::BusPacket(BusPacketType packtype, uint64_t physicalAddr,
         securityDomain(securityDomain)
 {}
 
-void BusPacket::print(uint64_t currentClockCycle, bool dataStart)
+// writes the command in the format modelsim expects (VERIFICATION_OUTPUT)
+void BusPacket::print(ostream &verifyOut, uint64_t currentClockCycle, bool dataStart)
 {
 	if (this == NULL)
 	{
 		return;
 	}
 
-	if (VERIFICATION_OUTPUT)
+	printVerification(verifyOut, currentClockCycle, busPacketType, rank, bank, row, column);
+}
+
+// the command trace decoder prints recorded commands the same way
+void BusPacket::printVerification(ostream &verifyOut, uint64_t currentClockCycle, BusPacketType type, unsigned rank, unsigned bank, unsigned row, unsigned column)
+{
+	switch (type)
 	{
-		switch (busPacketType)
-		{
-		case READ:
-			cmd_verify_out << currentClockCycle << ": read ("<<rank<<","<<bank<<","<<column<<",0);"<<endl;
-			break;
-		case READ_P:
-			cmd_verify_out << currentClockCycle << ": read ("<<rank<<","<<bank<<","<<column<<",1);"<<endl;
-			break;
-		case WRITE:
-			cmd_verify_out << currentClockCycle << ": write ("<<rank<<","<<bank<<","<<column<<",0 , 0, 'h0);"<<endl;
-			break;
-		case WRITE_P:
-			cmd_verify_out << currentClockCycle << ": write ("<<rank<<","<<bank<<","<<column<<",1, 0, 'h0);"<<endl;
-			break;
-		case ACTIVATE:
-			cmd_verify_out << currentClockCycle <<": activate (" << rank << "," << bank << "," << row <<");"<<endl;
-			break;
-		case PRECHARGE:
-			cmd_verify_out << currentClockCycle <<": precharge (" << rank << "," << bank << "," << row <<");"<<endl;
-			break;
-		case REFRESH:
-			cmd_verify_out << currentClockCycle <<": refresh (" << rank << ");"<<endl;
-			break;
-		case DATA:
-			//TODO: data verification?
-			break;
-		default:
-			ERROR("Trying to print unknown kind of bus packet");
-			exit(-1);
-		}
+	case READ:
+		verifyOut << currentClockCycle << ": read ("<<rank<<","<<bank<<","<<column<<",0);"<<endl;
+		break;
+	case READ_P:
+		verifyOut << currentClockCycle << ": read ("<<rank<<","<<bank<<","<<column<<",1);"<<endl;
+		break;
+	case WRITE:
+		verifyOut << currentClockCycle << ": write ("<<rank<<","<<bank<<","<<column<<",0 , 0, 'h0);"<<endl;
+		break;
+	case WRITE_P:
+		verifyOut << currentClockCycle << ": write ("<<rank<<","<<bank<<","<<column<<",1, 0, 'h0);"<<endl;
+		break;
+	case ACTIVATE:
+		verifyOut << currentClockCycle <<": activate (" << rank << "," << bank << "," << row <<");"<<endl;
+		break;
+	case PRECHARGE:
+		verifyOut << currentClockCycle <<": precharge (" << rank << "," << bank << "," << row <<");"<<endl;
+		break;
+	case REFRESH:
+		verifyOut << currentClockCycle <<": refresh (" << rank << ");"<<endl;
+		break;
+	case DATA:
+		//TODO: data verification?
+		break;
+	default:
+		ERROR("Trying to print unknown kind of bus packet");
+		exit(-1);
 	}
 }
 void BusPacket::print()
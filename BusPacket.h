@@ -72,7 +72,8 @@ public:
 	BusPacket(BusPacketType packtype, uint64_t physicalAddr, unsigned col, unsigned rw, unsigned r, unsigned b, void *dat, bool isFake, uint64_t securityDomain, ostream &dramsim_log_);
 
 	void print();
-	void print(uint64_t currentClockCycle, bool dataStart);
+	void print(ostream &verifyOut, uint64_t currentClockCycle, bool dataStart);
+	static void printVerification(ostream &verifyOut, uint64_t currentClockCycle, BusPacketType type, unsigned rank, unsigned bank, unsigned row, unsigned column);
 	void printData() const;
 
 };
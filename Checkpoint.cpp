@@ -0,0 +1,227 @@
+/*********************************************************************************
+*  Copyright (c) 2010-2011, Elliott Cooper-Balis
+*                             Paul Rosenfeld
+*                             Bruce Jacob
+*                             University of Maryland 
+*                             dramninjas [at] gmail [dot] com
+*  All rights reserved.
+*  
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*  
+*     * Redistributions of source code must retain the above copyright notice,
+*        this list of conditions and the following disclaimer.
+*  
+*     * Redistributions in binary form must reproduce the above copyright notice,
+*        this list of conditions and the following disclaimer in the documentation
+*        and/or other materials provided with the distribution.
+*  
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+*  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+*  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+*  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************************/
+
+
+
+//Checkpoint.cpp
+//
+//Binary checkpoint streams used to save and restore simulator state
+//
+
+#include "Checkpoint.h"
+#include "BusPacket.h"
+#include "Transaction.h"
+
+using namespace std;
+
+namespace DRAMSim
+{
+CheckpointOut::CheckpointOut(ostream &out_) :
+	out(out_)
+{}
+
+void CheckpointOut::put(const string &value)
+{
+	put<uint64_t>(value.length());
+	out.write(value.data(), value.length());
+}
+
+void CheckpointOut::put(const nlohmann::json &value)
+{
+	put(value.dump());
+}
+
+void CheckpointOut::putBusPacket(const BusPacket *packet)
+{
+	put<bool>(packet != NULL);
+	if (packet == NULL)
+	{
+		return;
+	}
+	put(packet->busPacketType);
+	put(packet->column);
+	put(packet->row);
+	put(packet->bank);
+	put(packet->rank);
+	put(packet->physicalAddress);
+	put(packet->isFake);
+	put(packet->securityDomain);
+}
+
+void CheckpointOut::putBusPackets(const vector<BusPacket *> &packets)
+{
+	put<uint64_t>(packets.size());
+	for (size_t i=0; i<packets.size(); i++)
+	{
+		putBusPacket(packets[i]);
+	}
+}
+
+void CheckpointOut::putTransaction(const Transaction *trans)
+{
+	put<bool>(trans != NULL);
+	if (trans == NULL)
+	{
+		return;
+	}
+	put(trans->transactionType);
+	put(trans->address);
+	put(trans->securityDomain);
+	put(trans->timeAdded);
+	put(trans->timeReturned);
+	put(trans->nodeID);
+	put(trans->isFake);
+	put(trans->fakeBank);
+}
+
+void CheckpointOut::putTransactions(const vector<Transaction *> &transactions)
+{
+	put<uint64_t>(transactions.size());
+	for (size_t i=0; i<transactions.size(); i++)
+	{
+		putTransaction(transactions[i]);
+	}
+}
+
+void CheckpointOut::putTransactions(const deque<Transaction *> &transactions)
+{
+	put<uint64_t>(transactions.size());
+	for (size_t i=0; i<transactions.size(); i++)
+	{
+		putTransaction(transactions[i]);
+	}
+}
+
+bool CheckpointOut::good() const
+{
+	return out.good();
+}
+
+CheckpointIn::CheckpointIn(istream &in_) :
+	in(in_)
+{}
+
+// a truncated checkpoint reads as empty containers rather than garbage sizes
+uint64_t CheckpointIn::getSize()
+{
+	uint64_t size = 0;
+	get(size);
+	return in.good() ? size : 0;
+}
+
+void CheckpointIn::get(string &value)
+{
+	uint64_t length = getSize();
+	value.assign(length, '\0');
+	in.read(&value[0], length);
+}
+
+void CheckpointIn::get(nlohmann::json &value)
+{
+	string dump;
+	get(dump);
+	value = in.good() ? nlohmann::json::parse(dump) : nlohmann::json();
+}
+
+BusPacket *CheckpointIn::getBusPacket(ostream &dramsim_log)
+{
+	bool present = false;
+	get(present);
+	if (!present || !in.good())
+	{
+		return NULL;
+	}
+	BusPacket *packet = new BusPacket(READ, 0, 0, 0, 0, 0, NULL, false, 0, dramsim_log);
+	get(packet->busPacketType);
+	get(packet->column);
+	get(packet->row);
+	get(packet->bank);
+	get(packet->rank);
+	get(packet->physicalAddress);
+	get(packet->isFake);
+	get(packet->securityDomain);
+	return packet;
+}
+
+void CheckpointIn::getBusPackets(vector<BusPacket *> &packets, ostream &dramsim_log)
+{
+	packets.clear();
+	uint64_t size = getSize();
+	for (uint64_t i=0; i<size; i++)
+	{
+		packets.push_back(getBusPacket(dramsim_log));
+	}
+}
+
+Transaction *CheckpointIn::getTransaction()
+{
+	bool present = false;
+	get(present);
+	if (!present || !in.good())
+	{
+		return NULL;
+	}
+	Transaction *trans = new Transaction(DATA_READ, 0, NULL, 0, -1, false, -1);
+	get(trans->transactionType);
+	get(trans->address);
+	get(trans->securityDomain);
+	get(trans->timeAdded);
+	get(trans->timeReturned);
+	get(trans->nodeID);
+	get(trans->isFake);
+	get(trans->fakeBank);
+	return trans;
+}
+
+void CheckpointIn::getTransactions(vector<Transaction *> &transactions)
+{
+	transactions.clear();
+	uint64_t size = getSize();
+	for (uint64_t i=0; i<size; i++)
+	{
+		transactions.push_back(getTransaction());
+	}
+}
+
+void CheckpointIn::getTransactions(deque<Transaction *> &transactions)
+{
+	transactions.clear();
+	uint64_t size = getSize();
+	for (uint64_t i=0; i<size; i++)
+	{
+		transactions.push_back(getTransaction());
+	}
+}
+
+bool CheckpointIn::good() const
+{
+	return in.good();
+}
+}
@@ -0,0 +1,165 @@
+/*********************************************************************************
+*  Copyright (c) 2010-2011, Elliott Cooper-Balis
+*                             Paul Rosenfeld
+*                             Bruce Jacob
+*                             University of Maryland 
+*                             dramninjas [at] gmail [dot] com
+*  All rights reserved.
+*  
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*  
+*     * Redistributions of source code must retain the above copyright notice,
+*        this list of conditions and the following disclaimer.
+*  
+*     * Redistributions in binary form must reproduce the above copyright notice,
+*        this list of conditions and the following disclaimer in the documentation
+*        and/or other materials provided with the distribution.
+*  
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+*  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+*  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+*  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************************/
+
+
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+//Checkpoint.h
+//
+//Binary checkpoint streams used to save and restore simulator state
+//
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <type_traits>
+
+#include "json.hpp"
+
+namespace DRAMSim
+{
+class BusPacket;
+class Transaction;
+
+/**
+ * Every object writes its own fields in serialize() and reads them back in
+ * the same order in unserialize(); there are no tags, so the two have to be
+ * kept in step. Plain values are written in host byte order, so checkpoints
+ * are only portable between builds on the same kind of machine.
+ */
+class CheckpointOut
+{
+public:
+	CheckpointOut(std::ostream &out_);
+
+	template <typename T>
+	void put(const T &value)
+	{
+		static_assert(std::is_trivially_copyable<T>::value && !std::is_pointer<T>::value,
+				"only plain values can be written directly");
+		out.write((const char *)&value, sizeof(T));
+	}
+	void put(const std::string &value);
+	void put(const nlohmann::json &value);
+	template <typename T>
+	void put(const std::vector<T> &values)
+	{
+		put<uint64_t>(values.size());
+		for (size_t i=0; i<values.size(); i++)
+		{
+			const T &value = values[i];
+			put(value);
+		}
+	}
+	template <typename K, typename V>
+	void put(const std::map<K,V> &values)
+	{
+		put<uint64_t>(values.size());
+		for (typename std::map<K,V>::const_iterator it=values.begin(); it!=values.end(); it++)
+		{
+			put(it->first);
+			put(it->second);
+		}
+	}
+
+	//packets and transactions are owned by whichever queue holds them, so
+	//they are written out by value; a NULL pointer is allowed
+	void putBusPacket(const BusPacket *packet);
+	void putBusPackets(const std::vector<BusPacket *> &packets);
+	void putTransaction(const Transaction *trans);
+	void putTransactions(const std::vector<Transaction *> &transactions);
+	void putTransactions(const std::deque<Transaction *> &transactions);
+
+	bool good() const;
+
+private:
+	std::ostream &out;
+};
+
+class CheckpointIn
+{
+public:
+	CheckpointIn(std::istream &in_);
+
+	template <typename T>
+	void get(T &value)
+	{
+		static_assert(std::is_trivially_copyable<T>::value && !std::is_pointer<T>::value,
+				"only plain values can be read directly");
+		in.read((char *)&value, sizeof(T));
+	}
+	void get(std::string &value);
+	void get(nlohmann::json &value);
+	template <typename T>
+	void get(std::vector<T> &values)
+	{
+		values.clear();
+		uint64_t size = getSize();
+		for (uint64_t i=0; i<size; i++)
+		{
+			T value = T();
+			get(value);
+			values.push_back(value);
+		}
+	}
+	template <typename K, typename V>
+	void get(std::map<K,V> &values)
+	{
+		values.clear();
+		uint64_t size = getSize();
+		for (uint64_t i=0; i<size; i++)
+		{
+			K key = K();
+			get(key);
+			get(values[key]);
+		}
+	}
+
+	//restored packets and transactions carry no data payload
+	BusPacket *getBusPacket(std::ostream &dramsim_log);
+	void getBusPackets(std::vector<BusPacket *> &packets, std::ostream &dramsim_log);
+	Transaction *getTransaction();
+	void getTransactions(std::vector<Transaction *> &transactions);
+	void getTransactions(std::deque<Transaction *> &transactions);
+
+	bool good() const;
+
+private:
+	uint64_t getSize();
+
+	std::istream &in;
+};
+}
+
+#endif
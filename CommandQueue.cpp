@@ -43,10 +43,12 @@
 #include "CommandQueue.h"
 #include "MemoryController.h"
 #include <assert.h>
+#include <limits>
 
 using namespace DRAMSim;
 
-CommandQueue::CommandQueue(vector< vector<BankState> > &states, ostream &dramsim_log_) :
+CommandQueue::CommandQueue(const Config &config_, vector<BankStates> &states, ostream &dramsim_log_) :
+		config(config_),
 		dramsim_log(dramsim_log_),
 		bankStates(states),
 		nextBank(0),
@@ -55,7 +57,11 @@ CommandQueue::CommandQueue(vector< vector<BankState> > &states, ostream &dramsim
 		nextRankPRE(0),
 		refreshRank(0),
 		refreshWaiting(false),
-		sendAct(true)
+		sendAct(true),
+		popFunction(selectPop(config_)),
+		nextReadyCycle(0),
+		nextPrechargeCycle(0),
+		seenStateChanges(config_.NUM_RANKS, 0)
 {
 	//set here to avoid compile errors
 	currentClockCycle = 0;
@@ -63,13 +69,13 @@ CommandQueue::CommandQueue(vector< vector<BankState> > &states, ostream &dramsim
 
 	//use numBankQueus below to create queue structure
 	size_t numBankQueues;
-	if (queuingStructure==PerRank)
+	if (config.queuingStructure==PerRank)
 	{
 		numBankQueues = 1;
 	}
-	else if (queuingStructure==PerRankPerBank)
+	else if (config.queuingStructure==PerRankPerBank)
 	{
-		numBankQueues = NUM_BANKS;
+		numBankQueues = config.NUM_BANKS;
 	}
 	else
 	{
@@ -78,13 +84,13 @@ CommandQueue::CommandQueue(vector< vector<BankState> > &states, ostream &dramsim
 	}
 
 	//vector of counters used to ensure rows don't stay open too long
-	rowAccessCounters = vector< vector<unsigned> >(NUM_RANKS, vector<unsigned>(NUM_BANKS,0));
+	rowAccessCounters = vector< vector<unsigned> >(config.NUM_RANKS, vector<unsigned>(config.NUM_BANKS,0));
 
 	//create queue based on the structure we want
 	BusPacket1D actualQueue;
 	BusPacket2D perBankQueue = BusPacket2D();
 	queues = BusPacket3D();
-	for (size_t rank=0; rank<NUM_RANKS; rank++)
+	for (size_t rank=0; rank<config.NUM_RANKS; rank++)
 	{
 		//this loop will run only once for per-rank and NUM_BANKS times for per-rank-per-bank
 		for (size_t bank=0; bank<numBankQueues; bank++)
@@ -94,6 +100,7 @@ CommandQueue::CommandQueue(vector< vector<BankState> > &states, ostream &dramsim
 		}
 		queues.push_back(perBankQueue);
 	}
+	readyCycle = vector< vector<uint64_t> >(config.NUM_RANKS, vector<uint64_t>(numBankQueues, 0));
 
 
 	//FOUR-bank activation window
@@ -102,8 +109,8 @@ CommandQueue::CommandQueue(vector< vector<BankState> > &states, ostream &dramsim
 	//
 	//countdown vector will have decrementing counters starting at tFAW
 	//  when the 0th element reaches 0, remove it
-	tFAWCountdown.reserve(NUM_RANKS);
-	for (size_t i=0;i<NUM_RANKS;i++)
+	tFAWCountdown.reserve(config.NUM_RANKS);
+	for (size_t i=0;i<config.NUM_RANKS;i++)
 	{
 		//init the empty vectors here so we don't seg fault later
 		tFAWCountdown.push_back(vector<unsigned>());
@@ -112,11 +119,11 @@ CommandQueue::CommandQueue(vector< vector<BankState> > &states, ostream &dramsim
 CommandQueue::~CommandQueue()
 {
 	//ERROR("COMMAND QUEUE destructor");
-	size_t bankMax = NUM_RANKS;
-	if (queuingStructure == PerRank) {
+	size_t bankMax = config.NUM_RANKS;
+	if (config.queuingStructure == PerRank) {
 		bankMax = 1; 
 	}
-	for (size_t r=0; r< NUM_RANKS; r++)
+	for (size_t r=0; r< config.NUM_RANKS; r++)
 	{
 		for (size_t b=0; b<bankMax; b++) 
 		{
@@ -133,20 +140,22 @@ void CommandQueue::enqueue(BusPacket *newBusPacket)
 {
 	unsigned rank = newBusPacket->rank;
 	unsigned bank = newBusPacket->bank;
-	if (queuingStructure==PerRank)
+	if (config.queuingStructure==PerRank)
 	{
 		queues[rank][0].push_back(newBusPacket);
-		if (queues[rank][0].size()>CMD_QUEUE_DEPTH)
+		readyCycle[rank][0] = 0;
+		if (queues[rank][0].size()>config.CMD_QUEUE_DEPTH)
 		{
 			ERROR("== Error - Enqueued more than allowed in command queue");
 			ERROR("						Need to call .hasRoomFor(int numberToEnqueue, unsigned rank, unsigned bank) first");
 			exit(0);
 		}
 	}
-	else if (queuingStructure==PerRankPerBank)
+	else if (config.queuingStructure==PerRankPerBank)
 	{
 		queues[rank][bank].push_back(newBusPacket);
-		if (queues[rank][bank].size()>CMD_QUEUE_DEPTH)
+		readyCycle[rank][bank] = 0;
+		if (queues[rank][bank].size()>config.CMD_QUEUE_DEPTH)
 		{
 			ERROR("== Error - Enqueued more than allowed in command queue");
 			ERROR("						Need to call .hasRoomFor(int numberToEnqueue, unsigned rank, unsigned bank) first");
@@ -158,6 +167,8 @@ void CommandQueue::enqueue(BusPacket *newBusPacket)
 		ERROR("== Error - Unknown queuing structure");
 		exit(0);
 	}
+	nextReadyCycle = 0;
+	nextPrechargeCycle = 0;
 }
 
 //Adds a command to appropriate queue
@@ -170,13 +181,24 @@ void CommandQueue::setDefenceDomains(uint64_t iDomain, uint64_t dDomain)
 //Removes the next item from the command queue based on the system's
 //command scheduling policy
 bool CommandQueue::pop(BusPacket **busPacket)
+{
+	return (this->*popFunction)(busPacket);
+}
+
+/**
+ * pop() for one page policy and queuing structure, with the fixed rate
+ * protection on or off. The checks on the configuration fold away in
+ * each copy; selectPop() picks the copy when the queue is built.
+ */
+template <RowBufferPolicy R, QueuingStructure Q, bool fixedRate>
+bool CommandQueue::popCommand(BusPacket **busPacket)
 {
 	//this can be done here because pop() is called every clock cycle by the parent MemoryController
 	//	figures out the sliding window requirement for tFAW
 	//
 	//deal with tFAW book-keeping
 	//	each rank has it's own counter since the restriction is on a device level
-	for (size_t i=0;i<NUM_RANKS;i++)
+	for (size_t i=0;i<config.NUM_RANKS;i++)
 	{
 		//decrement all the counters we have going
 		for (size_t j=0;j<tFAWCountdown[i].size();j++)
@@ -189,6 +211,13 @@ bool CommandQueue::pop(BusPacket **busPacket)
 		{
 			tFAWCountdown[i].erase(tFAWCountdown[i].begin());
 		}
+
+		//a bank changing state can make a command issuable before the queue said it could be
+		if (bankStates[i].stateChanges != seenStateChanges[i])
+		{
+			seenStateChanges[i] = bankStates[i].stateChanges;
+			rankChanged(i);
+		}
 	}
 
 	/* Now we need to find a packet to issue. When the code picks a packet, it will set
@@ -199,7 +228,7 @@ bool CommandQueue::pop(BusPacket **busPacket)
 		 Otherwise, it starts looking for rows to close (in open page)
 	*/
 
-	if (rowBufferPolicy==ClosePage)
+	if (R == ClosePage)
 	{
 		bool sendingREF = false;
 		//if the memory controller set the flags signaling that we need to issue a refresh
@@ -207,11 +236,11 @@ bool CommandQueue::pop(BusPacket **busPacket)
 		{
 			bool foundActiveOrTooEarly = false;
 			//look for an open bank
-			for (size_t b=0;b<NUM_BANKS;b++)
+			for (size_t b=0;b<config.NUM_BANKS;b++)
 			{
-				vector<BusPacket *> &queue = getCommandQueue(refreshRank,b);
+				vector<BusPacket *> &queue = commandQueue<Q>(refreshRank,b);
 				//checks to make sure that all banks are idle
-				if (bankStates[refreshRank][b].currentBankState == RowActive)
+				if (bankStates[refreshRank].currentBankState[b] == RowActive)
 				{
 					foundActiveOrTooEarly = true;
 					//if the bank is open, make sure there is nothing else
@@ -219,7 +248,7 @@ bool CommandQueue::pop(BusPacket **busPacket)
 					for (size_t j=0;j<queue.size();j++)
 					{
 						BusPacket *packet = queue[j];
-						if (packet->row == bankStates[refreshRank][b].openRowAddress &&
+						if (packet->row == bankStates[refreshRank].openRowAddress[b] &&
 								packet->bank == b)
 						{
 							if (packet->busPacketType != ACTIVATE && isIssuable(packet))
@@ -238,7 +267,7 @@ bool CommandQueue::pop(BusPacket **busPacket)
 				//				satisfied.	the next ACT and next REF can be issued at the same
 				//				point in the future, so just use nextActivate field instead of
 				//				creating a nextRefresh field
-				else if (bankStates[refreshRank][b].nextActivate > currentClockCycle)
+				else if (bankStates[refreshRank].nextActivate[b] > currentClockCycle)
 				{
 					foundActiveOrTooEarly = true;
 					break;
@@ -247,7 +276,7 @@ bool CommandQueue::pop(BusPacket **busPacket)
 
 			//if there are no open banks and timing has been met, send out the refresh
 			//	reset flags and rank pointer
-			if (!foundActiveOrTooEarly && bankStates[refreshRank][0].currentBankState != PowerDown)
+			if (!foundActiveOrTooEarly && bankStates[refreshRank].currentBankState[0] != PowerDown)
 			{
 				*busPacket = new BusPacket(REFRESH, 0, 0, 0, refreshRank, 0, 0, false, 0, dramsim_log);
 				refreshRank = -1;
@@ -259,19 +288,33 @@ bool CommandQueue::pop(BusPacket **busPacket)
 		//if we're not sending a REF, proceed as normal
 		if (!sendingREF)
 		{
+			//none of the queues can issue anything yet (the fixed rate
+			//protection adds its own commands, so always looks)
+			if (!fixedRate && currentClockCycle < nextReadyCycle)
+			{
+				return false;
+			}
+
 			bool foundIssuable = false;
 			unsigned startingRank = nextRank;
 			unsigned startingBank = nextBank;
+			uint64_t earliestReady = std::numeric_limits<uint64_t>::max();
 			do
 			{
-				vector<BusPacket *> &queue = getCommandQueue(nextRank, nextBank);
+				vector<BusPacket *> &queue = commandQueue<Q>(nextRank, nextBank);
+				uint64_t &ready = readyCycle[nextRank][Q == PerRank ? 0 : nextBank];
+				if (queue.empty())
+				{
+					ready = std::numeric_limits<uint64_t>::max();
+				}
 				//make sure there is something in this queue first
 				//	also make sure a rank isn't waiting for a refresh
 				//	if a rank is waiting for a refesh, don't issue anything to it until the
 				//		refresh logic above has sent one out (ie, letting banks close)
-				if ((!queue.empty() || (protection == FixedRate && currentClockCycle == nextFRClockCycle)) && !((nextRank == refreshRank) && refreshWaiting))
+				if ((!queue.empty() || (fixedRate && currentClockCycle == nextFRClockCycle)) && !((nextRank == refreshRank) && refreshWaiting) &&
+						(fixedRate || currentClockCycle >= ready))
 				{
-					if (queuingStructure == PerRank)
+					if (Q == PerRank)
 					{
 						//search from beginning to find first issuable bus packet
 						for (size_t i=0;i<queue.size();i++)
@@ -292,8 +335,8 @@ bool CommandQueue::pop(BusPacket **busPacket)
 					}
 					else
 					{
-						if (protection == FixedRate) {
-							if (!queue.empty() && isIssuable(queue[0]) && (queue[0]->busPacketType!=ACTIVATE || (BANK_PARTITION_CYCLES + currentClockCycle < nextFRClockCycle)) && !(queue[0]->securityDomain == iDefenceDomain || queue[0]->securityDomain == dDefenceDomain)) {
+						if (fixedRate) {
+							if (!queue.empty() && isIssuable(queue[0]) && (queue[0]->busPacketType!=ACTIVATE || (config.BANK_PARTITION_CYCLES + currentClockCycle < nextFRClockCycle)) && !(queue[0]->securityDomain == iDefenceDomain || queue[0]->securityDomain == dDefenceDomain)) {
 								*busPacket = queue[0];
 								queue.erase(queue.begin());
 								foundIssuable = true;
@@ -345,15 +388,20 @@ bool CommandQueue::pop(BusPacket **busPacket)
 						
 					}
 
+					if (!foundIssuable)
+					{
+						ready = earliestIssuable(queue, Q == PerRank);
+					}
 				}
 
 				//if we found something, break out of do-while
 				if (foundIssuable) break;
+				earliestReady = min(earliestReady, ready);
 
 				//rank round robin
-				if (queuingStructure == PerRank)
+				if (Q == PerRank)
 				{
-					nextRank = (nextRank + 1) % NUM_RANKS;
+					nextRank = (nextRank + 1) % config.NUM_RANKS;
 					if (startingRank == nextRank)
 					{
 						break;
@@ -371,31 +419,35 @@ bool CommandQueue::pop(BusPacket **busPacket)
 			while (true);
 
 			//if we couldn't find anything to send, return false
-			if (!foundIssuable) return false;
+			if (!foundIssuable)
+			{
+				nextReadyCycle = earliestReady;
+				return false;
+			}
 		}
 	}
-	else if (rowBufferPolicy==OpenPage)
+	else if (R == OpenPage)
 	{
 		bool sendingREForPRE = false;
 		if (refreshWaiting)
 		{
 			bool sendREF = true;
 			//make sure all banks idle and timing met for a REF
-			for (size_t b=0;b<NUM_BANKS;b++)
+			for (size_t b=0;b<config.NUM_BANKS;b++)
 			{
 				//if a bank is active we can't send a REF yet
-				if (bankStates[refreshRank][b].currentBankState == RowActive)
+				if (bankStates[refreshRank].currentBankState[b] == RowActive)
 				{
 					sendREF = false;
 					bool closeRow = true;
 					//search for commands going to an open row
-					vector <BusPacket *> &refreshQueue = getCommandQueue(refreshRank,b);
+					vector <BusPacket *> &refreshQueue = commandQueue<Q>(refreshRank,b);
 
 					for (size_t j=0;j<refreshQueue.size();j++)
 					{
 						BusPacket *packet = refreshQueue[j];
 						//if a command in the queue is going to the same row . . .
-						if (bankStates[refreshRank][b].openRowAddress == packet->row &&
+						if (bankStates[refreshRank].openRowAddress[b] == packet->row &&
 								b == packet->bank)
 						{
 							// . . . and is not an activate . . .
@@ -421,7 +473,7 @@ bool CommandQueue::pop(BusPacket **busPacket)
 					}
 
 					//if the bank is open and we are allowed to close it, then send a PRE
-					if (closeRow && currentClockCycle >= bankStates[refreshRank][b].nextPrecharge)
+					if (closeRow && currentClockCycle >= bankStates[refreshRank].nextPrecharge[b])
 					{
 						rowAccessCounters[refreshRank][b]=0;
 						*busPacket = new BusPacket(PRECHARGE, 0, 0, 0, refreshRank, b, 0, false, 0, dramsim_log);
@@ -432,7 +484,7 @@ bool CommandQueue::pop(BusPacket **busPacket)
 				//	NOTE: the next ACT and next REF can be issued at the same
 				//				point in the future, so just use nextActivate field instead of
 				//				creating a nextRefresh field
-				else if (bankStates[refreshRank][b].nextActivate > currentClockCycle) //and this bank doesn't have an open row
+				else if (bankStates[refreshRank].nextActivate[b] > currentClockCycle) //and this bank doesn't have an open row
 				{
 					sendREF = false;
 					break;
@@ -441,7 +493,7 @@ bool CommandQueue::pop(BusPacket **busPacket)
 
 			//if there are no open banks and timing has been met, send out the refresh
 			//	reset flags and rank pointer
-			if (sendREF && bankStates[refreshRank][0].currentBankState != PowerDown)
+			if (sendREF && bankStates[refreshRank].currentBankState[0] != PowerDown)
 			{
 				*busPacket = new BusPacket(REFRESH, 0, 0, 0, refreshRank, 0, 0, false, 0, dramsim_log);
 				refreshRank = -1;
@@ -455,11 +507,18 @@ bool CommandQueue::pop(BusPacket **busPacket)
 			unsigned startingRank = nextRank;
 			unsigned startingBank = nextBank;
 			bool foundIssuable = false;
-			do // round robin over queues
+			uint64_t earliestReady = std::numeric_limits<uint64_t>::max();
+			//skip the round robin if none of the queues can issue anything yet
+			while (currentClockCycle >= nextReadyCycle) // round robin over queues
 			{
-				vector<BusPacket *> &queue = getCommandQueue(nextRank,nextBank);
+				vector<BusPacket *> &queue = commandQueue<Q>(nextRank,nextBank);
+				uint64_t &ready = readyCycle[nextRank][Q == PerRank ? 0 : nextBank];
+				if (queue.empty())
+				{
+					ready = std::numeric_limits<uint64_t>::max();
+				}
 				//make sure there is something there first
-				if (!queue.empty() && !((nextRank == refreshRank) && refreshWaiting))
+				if (!queue.empty() && !((nextRank == refreshRank) && refreshWaiting) && currentClockCycle >= ready)
 				{
 					//search from the beginning to find first issuable bus packet
 					for (size_t i=0;i<queue.size();i++)
@@ -506,17 +565,24 @@ bool CommandQueue::pop(BusPacket **busPacket)
 							break;
 						}
 					}
+
+					if (!foundIssuable)
+					{
+						ready = earliestIssuable(queue, true);
+					}
 				}
 
-				//if we found something, break out of do-while
+				//if we found something, break out of the round robin
 				if (foundIssuable) break;
+				earliestReady = min(earliestReady, ready);
 
 				//rank round robin
-				if (queuingStructure == PerRank)
+				if (Q == PerRank)
 				{
-					nextRank = (nextRank + 1) % NUM_RANKS;
+					nextRank = (nextRank + 1) % config.NUM_RANKS;
 					if (startingRank == nextRank)
 					{
+						nextReadyCycle = earliestReady;
 						break;
 					}
 				}
@@ -525,33 +591,40 @@ bool CommandQueue::pop(BusPacket **busPacket)
 					nextRankAndBank(nextRank, nextBank); 
 					if (startingRank == nextRank && startingBank == nextBank)
 					{
+						nextReadyCycle = earliestReady;
 						break;
 					}
 				}
 			}
-			while (true);
 
 			//if nothing was issuable, see if we can issue a PRE to an open bank
 			//	that has no other commands waiting
 			if (!foundIssuable)
 			{
+				//no open bank can be closed yet
+				if (currentClockCycle < nextPrechargeCycle)
+				{
+					return false;
+				}
+
 				//search for banks to close
 				bool sendingPRE = false;
 				unsigned startingRank = nextRankPRE;
 				unsigned startingBank = nextBankPRE;
+				uint64_t earliestPrecharge = std::numeric_limits<uint64_t>::max();
 
 				do // round robin over all ranks and banks
 				{
-					vector <BusPacket *> &queue = getCommandQueue(nextRankPRE, nextBankPRE);
+					vector <BusPacket *> &queue = commandQueue<Q>(nextRankPRE, nextBankPRE);
 					bool found = false;
 					//check if bank is open
-					if (bankStates[nextRankPRE][nextBankPRE].currentBankState == RowActive)
+					if (bankStates[nextRankPRE].currentBankState[nextBankPRE] == RowActive)
 					{
 						for (size_t i=0;i<queue.size();i++)
 						{
 							//if there is something going to that bank and row, then we don't want to send a PRE
 							if (queue[i]->bank == nextBankPRE &&
-									queue[i]->row == bankStates[nextRankPRE][nextBankPRE].openRowAddress)
+									queue[i]->row == bankStates[nextRankPRE].openRowAddress[nextBankPRE])
 							{
 								found = true;
 								break;
@@ -559,15 +632,16 @@ bool CommandQueue::pop(BusPacket **busPacket)
 						}
 
 						//if nothing found going to that bank and row or too many accesses have happend, close it
-						if (!found || rowAccessCounters[nextRankPRE][nextBankPRE]==TOTAL_ROW_ACCESSES)
+						if (!found || rowAccessCounters[nextRankPRE][nextBankPRE]==config.TOTAL_ROW_ACCESSES)
 						{
-							if (currentClockCycle >= bankStates[nextRankPRE][nextBankPRE].nextPrecharge)
+							if (currentClockCycle >= bankStates[nextRankPRE].nextPrecharge[nextBankPRE])
 							{
 								sendingPRE = true;
 								rowAccessCounters[nextRankPRE][nextBankPRE] = 0;
 								*busPacket = new BusPacket(PRECHARGE, 0, 0, 0, nextRankPRE, nextBankPRE, 0, false, 0, dramsim_log);
 								break;
 							}
+							earliestPrecharge = min(earliestPrecharge, bankStates[nextRankPRE].nextPrecharge[nextBankPRE]);
 						}
 					}
 					nextRankAndBank(nextRankPRE, nextBankPRE);
@@ -575,7 +649,11 @@ bool CommandQueue::pop(BusPacket **busPacket)
 				while (!(startingRank == nextRankPRE && startingBank == nextBankPRE));
 
 				//if no PREs could be sent, just return false
-				if (!sendingPRE) return false;
+				if (!sendingPRE)
+				{
+					nextPrechargeCycle = earliestPrecharge;
+					return false;
+				}
 			}
 		}
 	}
@@ -584,7 +662,7 @@ bool CommandQueue::pop(BusPacket **busPacket)
 	//  posted-cas is enabled when AL>0
 	//  when sendAct is true, when don't want to increment our indexes
 	//  so we send the column access that is paid with this act
-	if (AL>0 && sendAct)
+	if (config.AL>0 && sendAct)
 	{
 		sendAct = false;
 	}
@@ -597,26 +675,47 @@ bool CommandQueue::pop(BusPacket **busPacket)
 	//if its an activate, add a tfaw counter
 	if ((*busPacket)->busPacketType==ACTIVATE)
 	{
-		tFAWCountdown[(*busPacket)->rank].push_back(tFAW);
+		tFAWCountdown[(*busPacket)->rank].push_back(config.tFAW);
 	}
 
+	//the command changes the state of its rank
+	rankChanged((*busPacket)->rank);
+
 	return true;
 }
 
 //check if a rank/bank queue has room for a certain number of bus packets
+CommandQueue::PopFunction CommandQueue::selectPop(const Config &config)
+{
+	bool fixedRate = config.protection == FixedRate;
+	if (config.rowBufferPolicy == OpenPage)
+	{
+		if (config.queuingStructure == PerRank)
+		{
+			return fixedRate ? &CommandQueue::popCommand<OpenPage, PerRank, true> : &CommandQueue::popCommand<OpenPage, PerRank, false>;
+		}
+		return fixedRate ? &CommandQueue::popCommand<OpenPage, PerRankPerBank, true> : &CommandQueue::popCommand<OpenPage, PerRankPerBank, false>;
+	}
+	if (config.queuingStructure == PerRank)
+	{
+		return fixedRate ? &CommandQueue::popCommand<ClosePage, PerRank, true> : &CommandQueue::popCommand<ClosePage, PerRank, false>;
+	}
+	return fixedRate ? &CommandQueue::popCommand<ClosePage, PerRankPerBank, true> : &CommandQueue::popCommand<ClosePage, PerRankPerBank, false>;
+}
+
 bool CommandQueue::hasRoomFor(unsigned numberToEnqueue, unsigned rank, unsigned bank)
 {
 	vector<BusPacket *> &queue = getCommandQueue(rank, bank); 
-	return (CMD_QUEUE_DEPTH - queue.size() >= numberToEnqueue);
+	return (config.CMD_QUEUE_DEPTH - queue.size() >= numberToEnqueue);
 }
 
 //prints the contents of the command queue
 void CommandQueue::print()
 {
-	if (queuingStructure==PerRank)
+	if (config.queuingStructure==PerRank)
 	{
 		PRINT(endl << "== Printing Per Rank Queue" );
-		for (size_t i=0;i<NUM_RANKS;i++)
+		for (size_t i=0;i<config.NUM_RANKS;i++)
 		{
 			PRINT(" = Rank " << i << "  size : " << queues[i][0].size() );
 			for (size_t j=0;j<queues[i][0].size();j++)
@@ -626,14 +725,14 @@ void CommandQueue::print()
 			}
 		}
 	}
-	else if (queuingStructure==PerRankPerBank)
+	else if (config.queuingStructure==PerRankPerBank)
 	{
 		PRINT("\n== Printing Per Rank, Per Bank Queue" );
 
-		for (size_t i=0;i<NUM_RANKS;i++)
+		for (size_t i=0;i<config.NUM_RANKS;i++)
 		{
 			PRINT(" = Rank " << i );
-			for (size_t j=0;j<NUM_BANKS;j++)
+			for (size_t j=0;j<config.NUM_BANKS;j++)
 			{
 				PRINT("    Bank "<< j << "   size : " << queues[i][j].size() );
 
@@ -654,11 +753,11 @@ void CommandQueue::print()
  */
 vector<BusPacket *> &CommandQueue::getCommandQueue(unsigned rank, unsigned bank)
 {
-	if (queuingStructure == PerRankPerBank)
+	if (config.queuingStructure == PerRankPerBank)
 	{
 		return queues[rank][bank];
 	}
-	else if (queuingStructure == PerRank)
+	else if (config.queuingStructure == PerRank)
 	{
 		return queues[rank][0];
 	}
@@ -679,9 +778,9 @@ bool CommandQueue::isIssuable(BusPacket *busPacket)
 
 		break;
 	case ACTIVATE:
-		if ((bankStates[busPacket->rank][busPacket->bank].currentBankState == Idle ||
-		        bankStates[busPacket->rank][busPacket->bank].currentBankState == Refreshing) &&
-		        currentClockCycle >= bankStates[busPacket->rank][busPacket->bank].nextActivate &&
+		if ((bankStates[busPacket->rank].currentBankState[busPacket->bank] == Idle ||
+		        bankStates[busPacket->rank].currentBankState[busPacket->bank] == Refreshing) &&
+		        currentClockCycle >= bankStates[busPacket->rank].nextActivate[busPacket->bank] &&
 		        tFAWCountdown[busPacket->rank].size() < 4)
 		{
 			return true;
@@ -693,10 +792,10 @@ bool CommandQueue::isIssuable(BusPacket *busPacket)
 		break;
 	case WRITE:
 	case WRITE_P:
-		if (bankStates[busPacket->rank][busPacket->bank].currentBankState == RowActive &&
-		        currentClockCycle >= bankStates[busPacket->rank][busPacket->bank].nextWrite &&
-		        busPacket->row == bankStates[busPacket->rank][busPacket->bank].openRowAddress &&
-		        rowAccessCounters[busPacket->rank][busPacket->bank] < TOTAL_ROW_ACCESSES)
+		if (bankStates[busPacket->rank].currentBankState[busPacket->bank] == RowActive &&
+		        currentClockCycle >= bankStates[busPacket->rank].nextWrite[busPacket->bank] &&
+		        busPacket->row == bankStates[busPacket->rank].openRowAddress[busPacket->bank] &&
+		        rowAccessCounters[busPacket->rank][busPacket->bank] < config.TOTAL_ROW_ACCESSES)
 		{
 			return true;
 		}
@@ -707,10 +806,10 @@ bool CommandQueue::isIssuable(BusPacket *busPacket)
 		break;
 	case READ_P:
 	case READ:
-		if (bankStates[busPacket->rank][busPacket->bank].currentBankState == RowActive &&
-		        currentClockCycle >= bankStates[busPacket->rank][busPacket->bank].nextRead &&
-		        busPacket->row == bankStates[busPacket->rank][busPacket->bank].openRowAddress &&
-		        rowAccessCounters[busPacket->rank][busPacket->bank] < TOTAL_ROW_ACCESSES)
+		if (bankStates[busPacket->rank].currentBankState[busPacket->bank] == RowActive &&
+		        currentClockCycle >= bankStates[busPacket->rank].nextRead[busPacket->bank] &&
+		        busPacket->row == bankStates[busPacket->rank].openRowAddress[busPacket->bank] &&
+		        rowAccessCounters[busPacket->rank][busPacket->bank] < config.TOTAL_ROW_ACCESSES)
 		{
 			return true;
 		}
@@ -720,8 +819,8 @@ bool CommandQueue::isIssuable(BusPacket *busPacket)
 		}
 		break;
 	case PRECHARGE:
-		if (bankStates[busPacket->rank][busPacket->bank].currentBankState == RowActive &&
-		        currentClockCycle >= bankStates[busPacket->rank][busPacket->bank].nextPrecharge)
+		if (bankStates[busPacket->rank].currentBankState[busPacket->bank] == RowActive &&
+		        currentClockCycle >= bankStates[busPacket->rank].nextPrecharge[busPacket->bank])
 		{
 			return true;
 		}
@@ -738,16 +837,88 @@ bool CommandQueue::isIssuable(BusPacket *busPacket)
 	return false;
 }
 
+// the earliest cycle busPacket could pass isIssuable() if only time goes
+// by; a command that first needs its bank to change state never can
+uint64_t CommandQueue::earliestIssuable(BusPacket *busPacket)
+{
+	const BankStates &states = bankStates[busPacket->rank];
+	unsigned bank = busPacket->bank;
+	switch (busPacket->busPacketType)
+	{
+	case ACTIVATE:
+		if (states.currentBankState[bank] == Idle || states.currentBankState[bank] == Refreshing)
+		{
+			//the oldest activate of a full tFAW window has to run out first
+			if (tFAWCountdown[busPacket->rank].size() >= 4)
+			{
+				return max(states.nextActivate[bank], currentClockCycle + tFAWCountdown[busPacket->rank][0]);
+			}
+			return states.nextActivate[bank];
+		}
+		break;
+	case WRITE:
+	case WRITE_P:
+	case READ_P:
+	case READ:
+		if (states.currentBankState[bank] == RowActive && busPacket->row == states.openRowAddress[bank] &&
+		        rowAccessCounters[busPacket->rank][bank] < config.TOTAL_ROW_ACCESSES)
+		{
+			bool isWrite = busPacket->busPacketType == WRITE || busPacket->busPacketType == WRITE_P;
+			return isWrite ? states.nextWrite[bank] : states.nextRead[bank];
+		}
+		break;
+	case PRECHARGE:
+		if (states.currentBankState[bank] == RowActive)
+		{
+			return states.nextPrecharge[bank];
+		}
+		break;
+	default:
+		break;
+	}
+	return std::numeric_limits<uint64_t>::max();
+}
+
+// the earliest cycle anything in the queue (or only its head) could issue.
+// Bank timing only ever moves later unless a command goes to the rank or a
+// bank changes state, and both reset the readiness of the rank
+uint64_t CommandQueue::earliestIssuable(const vector<BusPacket *> &queue, bool wholeQueue)
+{
+	uint64_t earliest = std::numeric_limits<uint64_t>::max();
+	size_t count = wholeQueue ? queue.size() : min(queue.size(), (size_t)1);
+	for (size_t i=0; i<count; i++)
+	{
+		earliest = min(earliest, earliestIssuable(queue[i]));
+	}
+	return earliest;
+}
+
+void CommandQueue::rankChanged(unsigned rank)
+{
+	fill(readyCycle[rank].begin(), readyCycle[rank].end(), 0);
+	nextReadyCycle = 0;
+	nextPrechargeCycle = 0;
+}
+
+//forget what was known about the queues, e.g. after the bank states were loaded
+void CommandQueue::resetReadiness()
+{
+	for (size_t r=0; r<readyCycle.size(); r++)
+	{
+		rankChanged(r);
+	}
+}
+
 //figures out if a rank's queue is empty
 bool CommandQueue::isEmpty(unsigned rank)
 {
-	if (queuingStructure == PerRank)
+	if (config.queuingStructure == PerRank)
 	{
 		return queues[rank][0].empty();
 	}
-	else if (queuingStructure == PerRankPerBank)
+	else if (config.queuingStructure == PerRankPerBank)
 	{
-		for (size_t i=0;i<NUM_BANKS;i++)
+		for (size_t i=0;i<config.NUM_BANKS;i++)
 		{
 			if (!queues[rank][i].empty()) return false;
 		}
@@ -760,6 +931,23 @@ bool CommandQueue::isEmpty(unsigned rank)
 	}
 }
 
+//true if nothing is queued and no refresh is waiting to go out
+bool CommandQueue::isIdle() const
+{
+	if (refreshWaiting)
+	{
+		return false;
+	}
+	for (size_t r=0; r<queues.size(); r++)
+	{
+		for (size_t b=0; b<queues[r].size(); b++)
+		{
+			if (!queues[r][b].empty()) return false;
+		}
+	}
+	return true;
+}
+
 //tells the command queue that a particular rank is in need of a refresh
 void CommandQueue::needRefresh(unsigned rank)
 {
@@ -769,28 +957,28 @@ void CommandQueue::needRefresh(unsigned rank)
 
 void CommandQueue::nextRankAndBank(unsigned &rank, unsigned &bank)
 {
-	if (schedulingPolicy == RankThenBankRoundRobin)
+	if (config.schedulingPolicy == RankThenBankRoundRobin)
 	{
 		rank++;
-		if (rank == NUM_RANKS)
+		if (rank == config.NUM_RANKS)
 		{
 			rank = 0;
 			bank++;
-			if (bank == NUM_BANKS)
+			if (bank == config.NUM_BANKS)
 			{
 				bank = 0;
 			}
 		}
 	}
 	//bank-then-rank round robin
-	else if (schedulingPolicy == BankThenRankRoundRobin)
+	else if (config.schedulingPolicy == BankThenRankRoundRobin)
 	{
 		bank++;
-		if (bank == NUM_BANKS)
+		if (bank == config.NUM_BANKS)
 		{
 			bank = 0;
 			rank++;
-			if (rank == NUM_RANKS)
+			if (rank == config.NUM_RANKS)
 			{
 				rank = 0;
 			}
@@ -810,3 +998,53 @@ void CommandQueue::update()
 	//needed for SimulatorObject
 	//TODO: make CommandQueue not a SimulatorObject
 }
+
+// the bank states belong to the memory controller, which saves them itself
+void CommandQueue::serialize(CheckpointOut &cp) const
+{
+	cp.put(currentClockCycle);
+	cp.put(nextFRClockCycle);
+	for (size_t r=0; r<queues.size(); r++)
+	{
+		for (size_t b=0; b<queues[r].size(); b++)
+		{
+			cp.putBusPackets(queues[r][b]);
+		}
+	}
+	cp.put(nextBank);
+	cp.put(nextRank);
+	cp.put(nextBankPRE);
+	cp.put(nextRankPRE);
+	cp.put(refreshRank);
+	cp.put(refreshWaiting);
+	cp.put(tFAWCountdown);
+	cp.put(rowAccessCounters);
+	cp.put(sendAct);
+}
+
+void CommandQueue::unserialize(CheckpointIn &cp)
+{
+	cp.get(currentClockCycle);
+	cp.get(nextFRClockCycle);
+	for (size_t r=0; r<queues.size(); r++)
+	{
+		for (size_t b=0; b<queues[r].size(); b++)
+		{
+			for (size_t i=0; i<queues[r][b].size(); i++)
+			{
+				delete queues[r][b][i];
+			}
+			cp.getBusPackets(queues[r][b], dramsim_log);
+		}
+	}
+	cp.get(nextBank);
+	cp.get(nextRank);
+	cp.get(nextBankPRE);
+	cp.get(nextRankPRE);
+	cp.get(refreshRank);
+	cp.get(refreshWaiting);
+	cp.get(tFAWCountdown);
+	cp.get(rowAccessCounters);
+	cp.get(sendAct);
+	resetReadiness();
+}
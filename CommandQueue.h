@@ -46,6 +46,7 @@
 #include "Transaction.h"
 #include "SystemConfiguration.h"
 #include "SimulatorObject.h"
+#include "Checkpoint.h"
 
 using namespace std;
 
@@ -54,6 +55,7 @@ namespace DRAMSim
 class CommandQueue : public SimulatorObject
 {
 	CommandQueue();
+	const Config &config;
 	ostream &dramsim_log;
 public:
 	//typedefs
@@ -62,7 +64,7 @@ public:
 	typedef vector<BusPacket2D> BusPacket3D;
 
 	//functions
-	CommandQueue(vector< vector<BankState> > &states, ostream &dramsim_log);
+	CommandQueue(const Config &config_, vector<BankStates> &states, ostream &dramsim_log);
 	virtual ~CommandQueue(); 
 
 	void enqueue(BusPacket *newBusPacket);
@@ -70,8 +72,12 @@ public:
 	bool hasRoomFor(unsigned numberToEnqueue, unsigned rank, unsigned bank);
 	bool isIssuable(BusPacket *busPacket);
 	bool isEmpty(unsigned rank);
+	bool isIdle() const;
 	void needRefresh(unsigned rank);
+	void resetReadiness();
 	void print();
+	void serialize(CheckpointOut &cp) const;
+	void unserialize(CheckpointIn &cp);
 	void update(); //SimulatorObject requirement
 
 	void setDefenceDomains(uint64_t iDomain, uint64_t dDomain);
@@ -80,12 +86,29 @@ public:
 	//fields
 	
 	BusPacket3D queues; // 3D array of BusPacket pointers
-	vector< vector<BankState> > &bankStates;
+	vector<BankStates> &bankStates;
 	
     uint64_t iDefenceDomain;
 	uint64_t dDefenceDomain;
 private:
 	void nextRankAndBank(unsigned &rank, unsigned &bank);
+
+	//one specialised pop() per page policy and queuing structure
+	typedef bool (CommandQueue::*PopFunction)(BusPacket **busPacket);
+	static PopFunction selectPop(const Config &config);
+	template <RowBufferPolicy R, QueuingStructure Q, bool fixedRate>
+	bool popCommand(BusPacket **busPacket);
+	template <QueuingStructure Q>
+	vector<BusPacket *> &commandQueue(unsigned rank, unsigned bank)
+	{
+		return queues[rank][Q == PerRankPerBank ? bank : 0];
+	}
+
+	//readiness of the queues, so the cycles in which nothing can issue
+	//don't have to go through every queue
+	uint64_t earliestIssuable(BusPacket *busPacket);
+	uint64_t earliestIssuable(const vector<BusPacket *> &queue, bool wholeQueue);
+	void rankChanged(unsigned rank);
 	//fields
 	unsigned nextBank;
 	unsigned nextRank;
@@ -100,6 +123,15 @@ private:
 	vector< vector<unsigned> > rowAccessCounters;
 
 	bool sendAct;
+	PopFunction popFunction;
+
+	//per queue, nothing in it can issue before this cycle (0 if unknown)
+	vector< vector<uint64_t> > readyCycle;
+	//the earliest readyCycle once all the queues have been looked at
+	uint64_t nextReadyCycle;
+	//open page: no idle bank can be closed before this cycle
+	uint64_t nextPrechargeCycle;
+	vector<unsigned> seenStateChanges;
 
 };
 }
@@ -0,0 +1,170 @@
+/*********************************************************************************
+*  Copyright (c) 2010-2011, Elliott Cooper-Balis
+*                             Paul Rosenfeld
+*                             Bruce Jacob
+*                             University of Maryland 
+*                             dramninjas [at] gmail [dot] com
+*  All rights reserved.
+*  
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*  
+*     * Redistributions of source code must retain the above copyright notice,
+*        this list of conditions and the following disclaimer.
+*  
+*     * Redistributions in binary form must reproduce the above copyright notice,
+*        this list of conditions and the following disclaimer in the documentation
+*        and/or other materials provided with the distribution.
+*  
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+*  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+*  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+*  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************************/
+
+//CommandTrace.cpp
+//
+//Writing and reading binary command traces
+//
+
+#include "CommandTrace.h"
+#include "PrintMacros.h"
+
+using namespace DRAMSim;
+using namespace std;
+
+static_assert(sizeof(CommandTraceRecord) == 20, "command trace records are written as they are laid out");
+
+CommandTraceWriter::CommandTraceWriter() :
+	records(4096),
+	numRecords(0),
+	lastCycle(0)
+{
+}
+
+CommandTraceWriter::~CommandTraceWriter()
+{
+	close();
+}
+
+void CommandTraceWriter::open(const string &filename)
+{
+	close();
+	lastCycle = 0;
+	out.open(filename.c_str(), ios::binary);
+	if (!out)
+	{
+		ERROR("Cannot open "<<filename);
+		abort();
+	}
+	out.write(COMMAND_TRACE_MAGIC, sizeof(COMMAND_TRACE_MAGIC));
+	buffer.attach(out);
+}
+
+void CommandTraceWriter::close()
+{
+	if (!out.is_open())
+	{
+		return;
+	}
+	writeRecords();
+	buffer.detach();
+	out.close();
+}
+
+// everything recorded so far is on disk when this returns
+void CommandTraceWriter::flush()
+{
+	if (!out.is_open())
+	{
+		return;
+	}
+	writeRecords();
+	buffer.flush();
+}
+
+void CommandTraceWriter::record(unsigned channel, uint64_t cycle, const BusPacket &packet)
+{
+	if (numRecords + 2 > records.size())
+	{
+		writeRecords();
+	}
+
+	if (cycle < lastCycle || cycle - lastCycle > UINT32_MAX)
+	{
+		CommandTraceRecord &sync = records[numRecords++];
+		sync = CommandTraceRecord();
+		sync.type = COMMAND_TRACE_SYNC;
+		sync.row = cycle >> 32;
+		sync.domain = (uint32_t)cycle;
+		lastCycle = cycle;
+	}
+
+	CommandTraceRecord &r = records[numRecords++];
+	r.cycleDelta = cycle - lastCycle;
+	r.row = packet.row;
+	r.domain = packet.securityDomain;
+	r.bank = packet.bank;
+	r.column = packet.column;
+	r.type = packet.busPacketType;
+	r.channel = channel;
+	r.rank = packet.rank;
+	r.flags = packet.isFake ? COMMAND_TRACE_FAKE : 0;
+	lastCycle = cycle;
+}
+
+void CommandTraceWriter::writeRecords()
+{
+	out.write((const char *)&records[0], numRecords * sizeof(CommandTraceRecord));
+	numRecords = 0;
+}
+
+CommandTraceReader::CommandTraceReader(const string &filename) :
+	lastCycle(0)
+{
+	in.open(filename.c_str(), ios::binary);
+	if (!in)
+	{
+		ERROR("== Error - Could not open command trace '"<<filename<<"'");
+		exit(-1);
+	}
+	char magic[sizeof(COMMAND_TRACE_MAGIC)] = "";
+	in.read(magic, sizeof(magic));
+	if (in.gcount() != sizeof(magic) || string(magic, sizeof(magic)) != string(COMMAND_TRACE_MAGIC, sizeof(magic)))
+	{
+		ERROR("== Error - '"<<filename<<"' is not a command trace");
+		exit(-1);
+	}
+}
+
+bool CommandTraceReader::next(CommandTraceEntry &entry)
+{
+	CommandTraceRecord r;
+	while (in.read((char *)&r, sizeof(r)))
+	{
+		if (r.type == COMMAND_TRACE_SYNC)
+		{
+			lastCycle = ((uint64_t)r.row << 32) | r.domain;
+			continue;
+		}
+		lastCycle += r.cycleDelta;
+		entry.cycle = lastCycle;
+		entry.type = (BusPacketType)r.type;
+		entry.channel = r.channel;
+		entry.rank = r.rank;
+		entry.bank = r.bank;
+		entry.row = r.row;
+		entry.column = r.column;
+		// -1 (no domain) comes back as it went in
+		entry.domain = r.domain == UINT32_MAX ? (uint64_t)-1 : r.domain;
+		entry.isFake = r.flags & COMMAND_TRACE_FAKE;
+		return true;
+	}
+	return false;
+}
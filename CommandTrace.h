@@ -0,0 +1,115 @@
+/*********************************************************************************
+*  Copyright (c) 2010-2011, Elliott Cooper-Balis
+*                             Paul Rosenfeld
+*                             Bruce Jacob
+*                             University of Maryland 
+*                             dramninjas [at] gmail [dot] com
+*  All rights reserved.
+*  
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*  
+*     * Redistributions of source code must retain the above copyright notice,
+*        this list of conditions and the following disclaimer.
+*  
+*     * Redistributions in binary form must reproduce the above copyright notice,
+*        this list of conditions and the following disclaimer in the documentation
+*        and/or other materials provided with the distribution.
+*  
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+*  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+*  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+*  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************************/
+#ifndef COMMANDTRACE_H
+#define COMMANDTRACE_H
+
+//CommandTrace.h
+//
+//Binary record of every command the memory controllers put on the command
+//bus (COMMAND_TRACE), and the reader DRAMSimCommandTrace decodes it with
+//
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <fstream>
+
+#include "BusPacket.h"
+#include "AsyncLogBuffer.h"
+
+#define COMMAND_TRACE_MAGIC "DRAMSim2 ctrace"
+
+namespace DRAMSim
+{
+// a record whose type is COMMAND_TRACE_SYNC carries no command, only the
+// absolute cycle (row<<32 | domain) for when the delta doesn't fit
+#define COMMAND_TRACE_SYNC 0xff
+#define COMMAND_TRACE_FAKE 0x1 //flags
+
+struct CommandTraceRecord
+{
+	uint32_t cycleDelta; //since the previous record
+	uint32_t row;
+	uint32_t domain; //securityDomain, cut to 32 bits
+	uint16_t bank;
+	uint16_t column;
+	uint8_t type; //BusPacketType
+	uint8_t channel;
+	uint8_t rank;
+	uint8_t flags;
+};
+
+// a decoded record
+struct CommandTraceEntry
+{
+	uint64_t cycle;
+	BusPacketType type;
+	unsigned channel;
+	unsigned rank;
+	unsigned bank;
+	unsigned row;
+	unsigned column;
+	uint64_t domain;
+	bool isFake;
+};
+
+class CommandTraceWriter
+{
+public:
+	CommandTraceWriter();
+	~CommandTraceWriter();
+	void open(const std::string &filename);
+	void close();
+	void flush();
+	void record(unsigned channel, uint64_t cycle, const BusPacket &packet);
+
+private:
+	void writeRecords();
+
+	std::ofstream out;
+	AsyncLogBuffer buffer;
+	std::vector<CommandTraceRecord> records;
+	size_t numRecords;
+	uint64_t lastCycle;
+};
+
+class CommandTraceReader
+{
+public:
+	CommandTraceReader(const std::string &filename);
+	bool next(CommandTraceEntry &entry);
+
+private:
+	std::ifstream in;
+	uint64_t lastCycle;
+};
+}
+
+#endif
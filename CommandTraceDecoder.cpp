@@ -0,0 +1,158 @@
+/*********************************************************************************
+*  Copyright (c) 2010-2011, Elliott Cooper-Balis
+*                             Paul Rosenfeld
+*                             Bruce Jacob
+*                             University of Maryland 
+*                             dramninjas [at] gmail [dot] com
+*  All rights reserved.
+*  
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*  
+*     * Redistributions of source code must retain the above copyright notice,
+*        this list of conditions and the following disclaimer.
+*  
+*     * Redistributions in binary form must reproduce the above copyright notice,
+*        this list of conditions and the following disclaimer in the documentation
+*        and/or other materials provided with the distribution.
+*  
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+*  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+*  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+*  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************************/
+
+
+
+
+//CommandTraceDecoder.cpp
+//
+//Turns a binary command trace (COMMAND_TRACE) back into the modelsim text
+//VERIFICATION_OUTPUT writes, or into CSV
+//
+
+#include <iostream>
+#include <fstream>
+#include <getopt.h>
+
+#include "SystemConfiguration.h"
+#include "CommandTrace.h"
+
+
+using namespace DRAMSim;
+using namespace std;
+
+int SHOW_SIM_OUTPUT = 1;
+
+void usage()
+{
+	cout << "DRAMSimCommandTrace Usage: " << endl;
+	cout << "DRAMSimCommandTrace [-c] [-o out.txt] trace.ctrace" <<endl;
+	cout << "\t-c, --csv \t\t\tone line per command: cycle,channel,command,rank,bank,row,column,domain,fake"<<endl;
+	cout << "\t-o, --output=FILENAME \t\twrite to FILENAME instead of stdout"<<endl;
+	cout << "Without -c the output is what VERIFICATION_OUTPUT writes"<<endl;
+}
+
+static const char *commandName(BusPacketType type)
+{
+	switch (type)
+	{
+	case READ: return "READ";
+	case READ_P: return "READ_P";
+	case WRITE: return "WRITE";
+	case WRITE_P: return "WRITE_P";
+	case ACTIVATE: return "ACT";
+	case PRECHARGE: return "PRE";
+	case REFRESH: return "REF";
+	case DATA: return "DATA";
+	}
+	return "?";
+}
+
+int main(int argc, char **argv)
+{
+	int c;
+	bool csv = false;
+	string outputFilename;
+
+	while (1)
+	{
+		static struct option long_options[] =
+		{
+			{"csv", no_argument, 0, 'c'},
+			{"output", required_argument, 0, 'o'},
+			{"help", no_argument, 0, 'h'},
+			{0, 0, 0, 0}
+		};
+		int option_index=0; //for getopt
+		c = getopt_long (argc, argv, "co:h", long_options, &option_index);
+		if (c == -1)
+		{
+			break;
+		}
+		switch (c)
+		{
+		case 'h':
+			usage();
+			exit(0);
+			break;
+		case 'c':
+			csv = true;
+			break;
+		case 'o':
+			outputFilename = string(optarg);
+			break;
+		case '?':
+			usage();
+			exit(-1);
+			break;
+		}
+	}
+
+	if (optind != argc - 1)
+	{
+		usage();
+		exit(-1);
+	}
+
+	CommandTraceReader reader(argv[optind]);
+	ofstream outputFile;
+	if (outputFilename.length() > 0)
+	{
+		outputFile.open(outputFilename.c_str());
+		if (!outputFile)
+		{
+			ERROR("== Error - Could not open "<<outputFilename<<" for writing");
+			exit(-1);
+		}
+	}
+	ostream &out = outputFilename.length() > 0 ? outputFile : cout;
+	AsyncLogBuffer buffer;
+	buffer.attach(out);
+
+	if (csv)
+	{
+		out << "cycle,channel,command,rank,bank,row,column,domain,fake" << endl;
+	}
+	CommandTraceEntry entry;
+	while (reader.next(entry))
+	{
+		if (csv)
+		{
+			out << entry.cycle << "," << entry.channel << "," << commandName(entry.type) << "," << entry.rank << "," << entry.bank
+			    << "," << entry.row << "," << entry.column << "," << (int64_t)entry.domain << "," << entry.isFake << "\n";
+		}
+		else
+		{
+			BusPacket::printVerification(out, entry.cycle, entry.type, entry.rank, entry.bank, entry.row, entry.column);
+		}
+	}
+	buffer.detach();
+	return 0;
+}
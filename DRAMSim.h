@@ -44,7 +44,7 @@ namespace DRAMSim
 
 	class MultiChannelMemorySystem {
 		public: 
-			bool addTransaction(bool isWrite, uint64_t addr, uin64_t domain);
+			bool addTransaction(bool isWrite, uint64_t addr, uint64_t domain);
 			void setCPUClockSpeed(uint64_t cpuClkFreqHz);
 			void update();
 			void printStats(bool finalStats);
@@ -65,8 +65,14 @@ namespace DRAMSim
 			void updateDefence(uint64_t oldDomain, uint64_t newDomain, bool isdata);
 			void endDefence();
 
+			bool saveCheckpoint(const std::string &filename);
+			bool restoreCheckpoint(const std::string &filename);
+			bool setFastTiming(bool enable);
+
 	};
-	MultiChannelMemorySystem *getMemorySystemInstance(const string &dev, const string &sys, const string &pwd, const string &trc, unsigned megsOfMemory, std::string *visfilename=NULL);
+	// each instance reads its own ini files, so instances with different
+	// device/system configurations can live side by side in one process
+	MultiChannelMemorySystem *getMemorySystemInstance(const string &dev, const string &sys, const string &pwd, const string &trc, const string &def, const string &def2, unsigned megsOfMemory, const string &visfilename="");
 }
 
 #endif
@@ -0,0 +1,112 @@
+/*********************************************************************************
+*  Copyright (c) 2010-2011, Elliott Cooper-Balis
+*                             Paul Rosenfeld
+*                             Bruce Jacob
+*                             University of Maryland 
+*                             dramninjas [at] gmail [dot] com
+*  All rights reserved.
+*  
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*  
+*     * Redistributions of source code must retain the above copyright notice,
+*        this list of conditions and the following disclaimer.
+*  
+*     * Redistributions in binary form must reproduce the above copyright notice,
+*        this list of conditions and the following disclaimer in the documentation
+*        and/or other materials provided with the distribution.
+*  
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+*  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+*  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+*  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************************/
+
+
+
+
+//DagCompiler.cpp
+//
+//Compiles a json defence DAG into the binary image DRAMSim loads directly
+//
+
+#include <iostream>
+#include <getopt.h>
+
+#include "SystemConfiguration.h"
+#include "DefenceDag.h"
+
+
+using namespace DRAMSim;
+using namespace std;
+
+int SHOW_SIM_OUTPUT = 1;
+
+void usage()
+{
+	cout << "DRAMSimDagCompile Usage: " << endl;
+	cout << "DRAMSimDagCompile dag.json dag.bdag"<<endl;
+	cout << "The image can be passed to DRAMSim -D in place of the json"<<endl;
+}
+
+int main(int argc, char **argv)
+{
+	int c;
+
+	while (1)
+	{
+		static struct option long_options[] =
+		{
+			{"help", no_argument, 0, 'h'},
+			{0, 0, 0, 0}
+		};
+		int option_index=0; //for getopt
+		c = getopt_long (argc, argv, "h", long_options, &option_index);
+		if (c == -1)
+		{
+			break;
+		}
+		switch (c)
+		{
+		case 'h':
+			usage();
+			exit(0);
+			break;
+		case '?':
+			usage();
+			exit(-1);
+			break;
+		}
+	}
+
+	if (optind != argc - 2)
+	{
+		usage();
+		exit(-1);
+	}
+
+	string dagFilename(argv[optind]);
+	string imageFilename(argv[optind+1]);
+
+	DefenceDag dag;
+	dag.load(dagFilename);
+	if (!dag.save(imageFilename))
+	{
+		ERROR("== Error - Could not write "<<imageFilename);
+		exit(-1);
+	}
+
+	size_t numNodes = 0;
+	for (size_t i=0; i<dag.loops.size(); i++)
+	{
+		numNodes += dag.loops[i].bankID.size();
+	}
+	DEBUG("== Wrote "<<dag.loops.size()<<" loops and "<<numNodes<<" nodes to '"<<imageFilename<<"' == ");
+	return 0;
+}
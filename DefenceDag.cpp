@@ -0,0 +1,257 @@
+/*********************************************************************************
+*  Copyright (c) 2010-2011, Elliott Cooper-Balis
+*                             Paul Rosenfeld
+*                             Bruce Jacob
+*                             University of Maryland 
+*                             dramninjas [at] gmail [dot] com
+*  All rights reserved.
+*  
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*  
+*     * Redistributions of source code must retain the above copyright notice,
+*        this list of conditions and the following disclaimer.
+*  
+*     * Redistributions in binary form must reproduce the above copyright notice,
+*        this list of conditions and the following disclaimer in the documentation
+*        and/or other materials provided with the distribution.
+*  
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+*  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+*  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+*  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************************/
+
+//DefenceDag.cpp
+//
+//Loading, compiling and sharing of defence DAGs
+//
+
+#include <fstream>
+#include <sstream>
+
+#include "DefenceDag.h"
+#include "PrintMacros.h"
+
+using namespace DRAMSim;
+using namespace std;
+
+void DefenceDag::load(const string &filename)
+{
+	ifstream in(filename.c_str(), ios::binary);
+	if (!in.is_open())
+	{
+		ERROR("== Error - Could not open DAG file '"<<filename<<"'");
+		exit(-1);
+	}
+
+	char magic[sizeof(DAG_IMAGE_MAGIC)] = "";
+	in.read(magic, sizeof(magic));
+	if (in.gcount() == sizeof(magic) && string(magic, sizeof(magic)) == string(DAG_IMAGE_MAGIC, sizeof(magic)))
+	{
+		CheckpointIn cp(in);
+		unserialize(cp);
+		if (!cp.good() || !consistent())
+		{
+			ERROR("== Error - DAG image '"<<filename<<"' is damaged");
+			exit(-1);
+		}
+		return;
+	}
+
+	in.clear();
+	in.seekg(0);
+	nlohmann::json j;
+	try
+	{
+		in >> j;
+	}
+	catch (nlohmann::json::exception &e)
+	{
+		ERROR("== Error - Could not parse DAG file '"<<filename<<"': "<<e.what());
+		exit(-1);
+	}
+	fromJson(j, filename);
+}
+
+// Determine lineages: the nodes, parents, children and edge latencies of
+// every loop
+void DefenceDag::fromJson(const nlohmann::json &j, const string &name)
+{
+	loops = vector<DagLoop>(j.size());
+
+	for (size_t i = 0; i < loops.size(); i++) { // Per loop
+		nlohmann::json::const_iterator it = j.find(to_string(i));
+		if (it == j.end()) {
+			ERROR("== Error - DAG "<<name<<" has "<<loops.size()<<" loops but no loop "<<i);
+			exit(-1);
+		}
+		const nlohmann::json &body = *it;
+		DagLoop &loop = loops[i];
+		size_t numNodes = body["node"].size();
+
+		loop.iterations = body["loop"];
+		loop.parents.resize(numNodes);
+		loop.children.resize(numNodes);
+		loop.childLatency.resize(numNodes);
+
+		for (size_t n = 0; n < numNodes; n++) {
+			const nlohmann::json &node = body["node"][n];
+			if (node["nodeID"] != n) {
+				ERROR("== Error - Node "<<n<<" of loop "<<i<<" of DAG "<<name<<" has nodeID "<<node["nodeID"]);
+				exit(-1);
+			}
+			loop.bankID.push_back(node["bankID"]);
+			loop.combinedWB.push_back(node["combinedWB"]);
+			loop.combinedWBBankID.push_back(node["combinedWBBankID"]);
+		}
+
+		map<pair<int,int>, int> latency; //a repeated edge takes the last latency
+		for (auto& edge : body["edge"].items()) {
+			int srcNode = edge.value()["sourceID"];
+			int destNode = edge.value()["destID"];
+			if (srcNode < 0 || destNode < 0 || (size_t)srcNode >= numNodes || (size_t)destNode >= numNodes) {
+				ERROR("== Error - Edge "<<srcNode<<"->"<<destNode<<" of loop "<<i<<" of DAG "<<name<<" has no such node");
+				exit(-1);
+			}
+			loop.parents[destNode].push_back(srcNode);
+			loop.children[srcNode].push_back(destNode);
+			latency[make_pair(srcNode, destNode)] = edge.value()["latency"];
+		}
+		for (size_t n = 0; n < numNodes; n++) {
+			for (size_t c = 0; c < loop.children[n].size(); c++) {
+				loop.childLatency[n].push_back(latency[make_pair((int)n, loop.children[n][c])]);
+			}
+		}
+	}
+}
+
+// every per-node table has a row per node and names only nodes that exist
+bool DefenceDag::consistent() const
+{
+	for (size_t i=0; i<loops.size(); i++)
+	{
+		const DagLoop &loop = loops[i];
+		size_t numNodes = loop.bankID.size();
+		if (loop.combinedWB.size() != numNodes || loop.combinedWBBankID.size() != numNodes ||
+				loop.parents.size() != numNodes || loop.children.size() != numNodes ||
+				loop.childLatency.size() != numNodes)
+		{
+			return false;
+		}
+		for (size_t n=0; n<numNodes; n++)
+		{
+			if (loop.childLatency[n].size() != loop.children[n].size())
+			{
+				return false;
+			}
+			const vector<int> *lists[] = {&loop.parents[n], &loop.children[n]};
+			for (size_t l=0; l<2; l++)
+			{
+				for (size_t k=0; k<lists[l]->size(); k++)
+				{
+					if ((*lists[l])[k] < 0 || (size_t)(*lists[l])[k] >= numNodes)
+					{
+						return false;
+					}
+				}
+			}
+		}
+	}
+	return true;
+}
+
+bool DefenceDag::save(const string &filename) const
+{
+	ofstream out(filename.c_str(), ios::binary);
+	out.write(DAG_IMAGE_MAGIC, sizeof(DAG_IMAGE_MAGIC));
+	CheckpointOut cp(out);
+	serialize(cp);
+	return cp.good();
+}
+
+string DefenceDag::image() const
+{
+	ostringstream out;
+	CheckpointOut cp(out);
+	serialize(cp);
+	return out.str();
+}
+
+void DefenceDag::serialize(CheckpointOut &cp) const
+{
+	cp.put<uint64_t>(loops.size());
+	for (size_t i=0; i<loops.size(); i++)
+	{
+		const DagLoop &loop = loops[i];
+		cp.put(loop.iterations);
+		cp.put(loop.bankID);
+		cp.put(loop.combinedWB);
+		cp.put(loop.combinedWBBankID);
+		cp.put(loop.parents);
+		cp.put(loop.children);
+		cp.put(loop.childLatency);
+	}
+}
+
+void DefenceDag::unserialize(CheckpointIn &cp)
+{
+	uint64_t numLoops = 0;
+	cp.get(numLoops);
+	loops.clear();
+	for (uint64_t i=0; i<numLoops && cp.good(); i++)
+	{
+		DagLoop loop;
+		cp.get(loop.iterations);
+		cp.get(loop.bankID);
+		cp.get(loop.combinedWB);
+		cp.get(loop.combinedWBBankID);
+		cp.get(loop.parents);
+		cp.get(loop.children);
+		cp.get(loop.childLatency);
+		loops.push_back(loop);
+	}
+}
+
+DefenceDagCache::~DefenceDagCache()
+{
+	for (map<string, DefenceDag *>::iterator it=byImage.begin(); it!=byImage.end(); it++)
+	{
+		delete it->second;
+	}
+}
+
+const DefenceDag *DefenceDagCache::load(const string &filename)
+{
+	map<string, const DefenceDag *>::iterator it = byFile.find(filename);
+	if (it != byFile.end())
+	{
+		return it->second;
+	}
+	DefenceDag dag;
+	dag.load(filename);
+	const DefenceDag *shared = intern(dag.image());
+	byFile[filename] = shared;
+	return shared;
+}
+
+const DefenceDag *DefenceDagCache::intern(const string &image)
+{
+	map<string, DefenceDag *>::iterator it = byImage.find(image);
+	if (it != byImage.end())
+	{
+		return it->second;
+	}
+	DefenceDag *dag = new DefenceDag();
+	istringstream in(image);
+	CheckpointIn cp(in);
+	dag->unserialize(cp);
+	byImage[image] = dag;
+	return dag;
+}
@@ -0,0 +1,96 @@
+/*********************************************************************************
+*  Copyright (c) 2010-2011, Elliott Cooper-Balis
+*                             Paul Rosenfeld
+*                             Bruce Jacob
+*                             University of Maryland 
+*                             dramninjas [at] gmail [dot] com
+*  All rights reserved.
+*  
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*  
+*     * Redistributions of source code must retain the above copyright notice,
+*        this list of conditions and the following disclaimer.
+*  
+*     * Redistributions in binary form must reproduce the above copyright notice,
+*        this list of conditions and the following disclaimer in the documentation
+*        and/or other materials provided with the distribution.
+*  
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+*  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+*  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+*  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************************/
+#ifndef DEFENCEDAG_H
+#define DEFENCEDAG_H
+
+//DefenceDag.h
+//
+//A DAGguise defence DAG, compiled out of its json once and shared read-only
+//by every domain that runs it
+//
+
+#include <string>
+#include <vector>
+#include <map>
+
+#include "Checkpoint.h"
+
+#define DAG_IMAGE_MAGIC "DRAMSim2 dag"
+
+namespace DRAMSim
+{
+using std::string;
+using std::vector;
+using std::map;
+
+// one loop of a DAG; nodes are numbered 0..n-1 in the order they are listed
+struct DagLoop
+{
+	int iterations;
+	vector<int> bankID; //per node
+	vector<int> combinedWB;
+	vector<int> combinedWBBankID;
+	vector< vector<int> > parents;
+	vector< vector<int> > children;
+	vector< vector<int> > childLatency; //alongside children
+};
+
+class DefenceDag
+{
+public:
+	vector<DagLoop> loops;
+
+	// json or a compiled image, told apart by DAG_IMAGE_MAGIC
+	void load(const string &filename);
+	void fromJson(const nlohmann::json &j, const string &name);
+	bool consistent() const;
+	bool save(const string &filename) const;
+	string image() const;
+	void serialize(CheckpointOut &cp) const;
+	void unserialize(CheckpointIn &cp);
+};
+
+// each distinct DAG is kept once, however many files or domains name it
+class DefenceDagCache
+{
+public:
+	DefenceDagCache() {}
+	~DefenceDagCache();
+	const DefenceDag *load(const string &filename);
+	const DefenceDag *intern(const string &image);
+private:
+	DefenceDagCache(const DefenceDagCache &);
+	DefenceDagCache &operator=(const DefenceDagCache &);
+	map<string, const DefenceDag *> byFile;
+	map<string, DefenceDag *> byImage;
+};
+}
+
+#endif
@@ -0,0 +1,75 @@
+/*********************************************************************************
+*  Copyright (c) 2010-2011, Elliott Cooper-Balis
+*                             Paul Rosenfeld
+*                             Bruce Jacob
+*                             University of Maryland 
+*                             dramninjas [at] gmail [dot] com
+*  All rights reserved.
+*  
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*  
+*     * Redistributions of source code must retain the above copyright notice,
+*        this list of conditions and the following disclaimer.
+*  
+*     * Redistributions in binary form must reproduce the above copyright notice,
+*        this list of conditions and the following disclaimer in the documentation
+*        and/or other materials provided with the distribution.
+*  
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+*  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+*  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+*  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************************/
+
+
+#ifndef DEVICEPRESETS_H
+#define DEVICEPRESETS_H
+
+// The timing parameters of the devices in ini/ that the derived timing is
+// worked out from. Building with make DEVICE=<name> makes the derived timing
+// compile time constants for that device (see DerivedTiming); the ini file
+// passed at run time then has to agree with the preset.
+
+namespace DRAMSim
+{
+namespace DevicePreset
+{
+
+#define DEFINE_DEVICE_PRESET(name, cl, al, bl, trp, tccd, trtp, twtr, twr, trtrs) \
+	struct name \
+	{ \
+		static constexpr const char *NAME = #name; \
+		static constexpr unsigned CL = cl; \
+		static constexpr unsigned AL = al; \
+		static constexpr unsigned BL = bl; \
+		static constexpr unsigned tRP = trp; \
+		static constexpr unsigned tCCD = tccd; \
+		static constexpr unsigned tRTP = trtp; \
+		static constexpr unsigned tWTR = twtr; \
+		static constexpr unsigned tWR = twr; \
+		static constexpr unsigned tRTRS = trtrs; \
+	};
+
+//                   name                         CL  AL BL tRP tCCD tRTP tWTR tWR tRTRS
+DEFINE_DEVICE_PRESET(DDR3_micron_8M_8B_x16_sg15,  10, 0, 8, 10, 4,   5,   5,   10, 1)
+DEFINE_DEVICE_PRESET(DDR3_micron_16M_8B_x8_sg15,  10, 0, 8, 10, 4,   5,   5,   10, 1)
+DEFINE_DEVICE_PRESET(DDR3_micron_32M_8B_x4_sg15,  10, 0, 8, 10, 4,   5,   5,   10, 1)
+DEFINE_DEVICE_PRESET(DDR3_micron_32M_8B_x8_sg15,  10, 0, 8, 10, 4,   5,   5,   10, 1)
+DEFINE_DEVICE_PRESET(DDR3_micron_64M_8B_x4_sg15,  10, 0, 8, 10, 4,   5,   5,   10, 1)
+DEFINE_DEVICE_PRESET(DDR3_micron_32M_8B_x4_sg125, 11, 0, 8, 11, 4,   6,   6,   12, 1)
+DEFINE_DEVICE_PRESET(DDR3_micron_32M_8B_x8_sg125, 11, 0, 8, 11, 4,   6,   6,   12, 2)
+DEFINE_DEVICE_PRESET(DDR3_micron_32M_8B_x8_sg25E,  5, 0, 8,  5, 4,   4,   4,   6,  1)
+
+#undef DEFINE_DEVICE_PRESET
+
+} // namespace DevicePreset
+} // namespace DRAMSim
+
+#endif
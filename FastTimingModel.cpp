@@ -0,0 +1,181 @@
+/*********************************************************************************
+*  Copyright (c) 2010-2011, Elliott Cooper-Balis
+*                             Paul Rosenfeld
+*                             Bruce Jacob
+*                             University of Maryland 
+*                             dramninjas [at] gmail [dot] com
+*  All rights reserved.
+*  
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*  
+*     * Redistributions of source code must retain the above copyright notice,
+*        this list of conditions and the following disclaimer.
+*  
+*     * Redistributions in binary form must reproduce the above copyright notice,
+*        this list of conditions and the following disclaimer in the documentation
+*        and/or other materials provided with the distribution.
+*  
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+*  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+*  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+*  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************************/
+
+
+//FastTimingModel.cpp
+//
+//Analytical timing model of one channel, used for fast-forwarding
+//
+
+#include "FastTimingModel.h"
+#include "AddressMapping.h"
+
+using namespace std;
+
+namespace DRAMSim
+{
+FastTimingModel::FastTimingModel(const Config &config_) :
+	totalReads(0),
+	totalWrites(0),
+	totalReadLatency(0),
+	rowHits(0),
+	config(config_),
+	openRows(config_.NUM_RANKS, vector<int>(config_.NUM_BANKS, -1)),
+	nextColumn(config_.NUM_RANKS, vector<uint64_t>(config_.NUM_BANKS, 0)),
+	nextPrecharge(config_.NUM_RANKS, vector<uint64_t>(config_.NUM_BANKS, 0)),
+	nextActivate(config_.NUM_RANKS, vector<uint64_t>(config_.NUM_BANKS, 0)),
+	nextRankActivate(config_.NUM_RANKS, 0),
+	fawWindow(config_.NUM_RANKS, vector<uint64_t>(4, 0)),
+	fawIndex(config_.NUM_RANKS, 0),
+	nextRefresh(config_.NUM_RANKS, 0),
+	dataBusFree(0)
+{}
+
+void FastTimingModel::load(const FunctionalState &state, uint64_t clockCycle)
+{
+	openRows = state.openRows;
+	for (size_t r=0; r<config.NUM_RANKS; r++)
+	{
+		nextRefresh[r] = clockCycle + state.refreshCountdown[r];
+		for (size_t b=0; b<config.NUM_BANKS; b++)
+		{
+			nextColumn[r][b] = max(nextColumn[r][b], clockCycle);
+			nextPrecharge[r][b] = max(nextPrecharge[r][b], clockCycle);
+			nextActivate[r][b] = max(nextActivate[r][b], clockCycle);
+		}
+	}
+	dataBusFree = max(dataBusFree, clockCycle);
+}
+
+void FastTimingModel::save(FunctionalState &state, uint64_t clockCycle) const
+{
+	state.openRows = openRows;
+	state.refreshCountdown.resize(config.NUM_RANKS);
+	state.refreshRank = 0;
+	for (size_t r=0; r<config.NUM_RANKS; r++)
+	{
+		// refreshes are only applied when a request comes in, so one may
+		// already be due; the controller will issue it straight away
+		state.refreshCountdown[r] = nextRefresh[r] > clockCycle ? nextRefresh[r] - clockCycle : 0;
+		if (nextRefresh[r] < nextRefresh[state.refreshRank])
+		{
+			state.refreshRank = r;
+		}
+	}
+}
+
+void FastTimingModel::refreshUntil(uint64_t clockCycle)
+{
+	uint64_t refreshPeriod = config.REFRESH_PERIOD/config.tCK;
+	for (size_t r=0; r<config.NUM_RANKS; r++)
+	{
+		while (nextRefresh[r] <= clockCycle)
+		{
+			for (size_t b=0; b<config.NUM_BANKS; b++)
+			{
+				openRows[r][b] = -1;
+				nextActivate[r][b] = max(nextActivate[r][b], nextRefresh[r] + config.tRFC);
+			}
+			nextRefresh[r] += refreshPeriod;
+		}
+	}
+}
+
+/**
+ * Returns the cycle the request completes on: the end of its data burst.
+ * The command bus is not modelled and requests are served in the order
+ * they are added, so this is an estimate, not what the detailed
+ * controller would do.
+ */
+uint64_t FastTimingModel::access(bool isWrite, uint64_t address, uint64_t clockCycle)
+{
+	unsigned chan, rank, bank, row, col;
+	addressMapping(config, address, chan, rank, bank, row, col);
+	if (config.SINGLE_BANK) bank = 0;
+
+	refreshUntil(clockCycle);
+
+	int &openRow = openRows[rank][bank];
+	uint64_t column;
+	if (openRow == (int)row)
+	{
+		rowHits++;
+		column = max(clockCycle + 1, nextColumn[rank][bank]);
+	}
+	else
+	{
+		uint64_t activate = max(clockCycle + 1, nextActivate[rank][bank]);
+		if (openRow != -1)
+		{
+			activate = max(activate, max(clockCycle + 1, nextPrecharge[rank][bank]) + config.tRP);
+		}
+		activate = max(activate, nextRankActivate[rank]);
+		// the oldest of the last four activates in this rank
+		activate = max(activate, fawWindow[rank][fawIndex[rank]] + config.tFAW);
+		fawWindow[rank][fawIndex[rank]] = activate;
+		fawIndex[rank] = (fawIndex[rank] + 1) % 4;
+		nextRankActivate[rank] = activate + config.tRRD;
+		nextActivate[rank][bank] = activate + config.tRC;
+		nextPrecharge[rank][bank] = activate + config.tRAS;
+		column = activate + config.tRCD;
+	}
+
+	uint64_t dataStart = max(column + (isWrite ? config.timing.WL : config.timing.RL), dataBusFree);
+	dataBusFree = dataStart + config.timing.BURST_CYCLES;
+	// a late data slot pushes the column command back with it
+	column = dataStart - (isWrite ? config.timing.WL : config.timing.RL);
+
+	if (config.rowBufferPolicy == OpenPage)
+	{
+		openRow = row;
+		nextColumn[rank][bank] = column + config.tCCD;
+		nextPrecharge[rank][bank] = max(nextPrecharge[rank][bank],
+		                                column + (isWrite ? config.timing.WRITE_TO_PRE_DELAY : config.timing.READ_TO_PRE_DELAY));
+	}
+	else
+	{
+		openRow = -1;
+		nextActivate[rank][bank] = max(nextActivate[rank][bank],
+		                               column + (isWrite ? config.timing.WRITE_AUTOPRE_DELAY : config.timing.READ_AUTOPRE_DELAY));
+	}
+
+	uint64_t done = dataBusFree;
+	if (isWrite)
+	{
+		totalWrites++;
+	}
+	else
+	{
+		totalReads++;
+		totalReadLatency += done - clockCycle;
+	}
+	return done;
+}
+}
@@ -0,0 +1,85 @@
+/*********************************************************************************
+*  Copyright (c) 2010-2011, Elliott Cooper-Balis
+*                             Paul Rosenfeld
+*                             Bruce Jacob
+*                             University of Maryland 
+*                             dramninjas [at] gmail [dot] com
+*  All rights reserved.
+*  
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*  
+*     * Redistributions of source code must retain the above copyright notice,
+*        this list of conditions and the following disclaimer.
+*  
+*     * Redistributions in binary form must reproduce the above copyright notice,
+*        this list of conditions and the following disclaimer in the documentation
+*        and/or other materials provided with the distribution.
+*  
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+*  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+*  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+*  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************************/
+
+
+#ifndef FASTTIMINGMODEL_H
+#define FASTTIMINGMODEL_H
+
+//FastTimingModel.h
+//
+//Analytical timing model of one channel, used for fast-forwarding
+//
+
+#include <vector>
+
+#include "SystemConfiguration.h"
+#include "FunctionalModel.h"
+
+namespace DRAMSim
+{
+/**
+ * Works out when a request would complete from the bank it maps to, the
+ * row that bank has open, the activate constraints of its rank (tRRD, tRC,
+ * tFAW), refreshes and the shared data bus. Nothing is ticked: each access
+ * is handled once, in arrival order, when it is added. MemorySystem uses it
+ * in place of the MemoryController while fast timing is switched on; open
+ * rows and refresh positions are moved between the two with load() and
+ * save().
+ */
+class FastTimingModel
+{
+public:
+	FastTimingModel(const Config &config_);
+	void load(const FunctionalState &state, uint64_t clockCycle);
+	void save(FunctionalState &state, uint64_t clockCycle) const;
+	uint64_t access(bool isWrite, uint64_t address, uint64_t clockCycle);
+
+	uint64_t totalReads;
+	uint64_t totalWrites;
+	uint64_t totalReadLatency;
+	uint64_t rowHits;
+
+private:
+	void refreshUntil(uint64_t clockCycle);
+
+	const Config &config;
+	std::vector< std::vector<int> > openRows;
+	std::vector< std::vector<uint64_t> > nextColumn;    //earliest READ/WRITE to the open row
+	std::vector< std::vector<uint64_t> > nextPrecharge;
+	std::vector< std::vector<uint64_t> > nextActivate;  //per bank (tRC, tRP, refresh)
+	std::vector<uint64_t> nextRankActivate;             //per rank (tRRD)
+	std::vector< std::vector<uint64_t> > fawWindow;     //last four activates per rank
+	std::vector<unsigned> fawIndex;
+	std::vector<uint64_t> nextRefresh;
+	uint64_t dataBusFree;
+};
+}
+
+#endif
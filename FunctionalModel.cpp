@@ -0,0 +1,110 @@
+/*********************************************************************************
+*  Copyright (c) 2010-2011, Elliott Cooper-Balis
+*                             Paul Rosenfeld
+*                             Bruce Jacob
+*                             University of Maryland 
+*                             dramninjas [at] gmail [dot] com
+*  All rights reserved.
+*  
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*  
+*     * Redistributions of source code must retain the above copyright notice,
+*        this list of conditions and the following disclaimer.
+*  
+*     * Redistributions in binary form must reproduce the above copyright notice,
+*        this list of conditions and the following disclaimer in the documentation
+*        and/or other materials provided with the distribution.
+*  
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+*  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+*  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+*  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************************/
+
+
+
+//FunctionalModel.cpp
+//
+//Untimed model of the row buffers, used between sample windows
+//
+
+#include "FunctionalModel.h"
+#include "AddressMapping.h"
+
+using namespace std;
+
+namespace DRAMSim
+{
+FunctionalModel::FunctionalModel(const Config &config_) :
+	channels(config_.NUM_CHANS),
+	currentClockCycle(0),
+	totalAccesses(0),
+	rowHits(0),
+	config(config_)
+{}
+
+void FunctionalModel::access(uint64_t address)
+{
+	unsigned chan, rank, bank, row, col;
+	addressMapping(config, address, chan, rank, bank, row, col);
+	if (config.SINGLE_BANK) bank = 0;
+
+	int &openRow = channels[chan].openRows[rank][bank];
+	totalAccesses++;
+	if (openRow == (int)row)
+	{
+		rowHits++;
+	}
+	openRow = (config.rowBufferPolicy == OpenPage) ? (int)row : -1;
+}
+
+// same order as MemoryController::update(): a rank whose countdown has hit
+// zero is refreshed, then every countdown ticks down
+void FunctionalModel::refresh(FunctionalState &channel)
+{
+	unsigned rank = channel.refreshRank;
+	for (size_t b=0; b<channel.openRows[rank].size(); b++)
+	{
+		channel.openRows[rank][b] = -1;
+	}
+	channel.refreshCountdown[rank] = config.REFRESH_PERIOD/config.tCK;
+	channel.refreshRank = (rank + 1) % config.NUM_RANKS;
+}
+
+void FunctionalModel::advanceTo(uint64_t clockCycle)
+{
+	if (clockCycle <= currentClockCycle)
+	{
+		return;
+	}
+
+	for (size_t c=0; c<channels.size(); c++)
+	{
+		FunctionalState &channel = channels[c];
+		uint64_t cyclesLeft = clockCycle - currentClockCycle;
+		while (cyclesLeft > 0)
+		{
+			uint64_t step = channel.refreshCountdown[channel.refreshRank];
+			if (step == 0)
+			{
+				refresh(channel);
+				step = 1;
+			}
+			step = min(step, cyclesLeft);
+			for (size_t r=0; r<channel.refreshCountdown.size(); r++)
+			{
+				channel.refreshCountdown[r] -= step;
+			}
+			cyclesLeft -= step;
+		}
+	}
+	currentClockCycle = clockCycle;
+}
+}
@@ -0,0 +1,83 @@
+/*********************************************************************************
+*  Copyright (c) 2010-2011, Elliott Cooper-Balis
+*                             Paul Rosenfeld
+*                             Bruce Jacob
+*                             University of Maryland 
+*                             dramninjas [at] gmail [dot] com
+*  All rights reserved.
+*  
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*  
+*     * Redistributions of source code must retain the above copyright notice,
+*        this list of conditions and the following disclaimer.
+*  
+*     * Redistributions in binary form must reproduce the above copyright notice,
+*        this list of conditions and the following disclaimer in the documentation
+*        and/or other materials provided with the distribution.
+*  
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+*  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+*  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+*  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************************/
+
+
+
+#ifndef FUNCTIONALMODEL_H
+#define FUNCTIONALMODEL_H
+
+//FunctionalModel.h
+//
+//Untimed model of the row buffers, used between sample windows
+//
+
+#include <vector>
+
+#include "SystemConfiguration.h"
+
+namespace DRAMSim
+{
+// the part of one channel's state that survives a functional phase
+struct FunctionalState
+{
+	std::vector< std::vector<int> > openRows; //[rank][bank], -1 if closed
+	std::vector<unsigned> refreshCountdown;
+	unsigned refreshRank;
+};
+
+/**
+ * Replays requests without any timing: each access just opens its row
+ * (or leaves the bank closed with a close page policy) and refreshes close
+ * every row in their rank at the same points the memory controller would
+ * issue them. The state is taken from and given back to the detailed
+ * controllers with MultiChannelMemorySystem::saveFunctionalState() and
+ * loadFunctionalState().
+ */
+class FunctionalModel
+{
+public:
+	FunctionalModel(const Config &config_);
+	void access(uint64_t address);
+	void advanceTo(uint64_t clockCycle);
+
+	std::vector<FunctionalState> channels;
+	uint64_t currentClockCycle;
+
+	uint64_t totalAccesses;
+	uint64_t rowHits;
+
+private:
+	void refresh(FunctionalState &channel);
+
+	const Config &config;
+};
+}
+
+#endif
@@ -39,36 +39,27 @@
 #include "MemorySystem.h"
 #include "AddressMapping.h"
 #include "IniReader.h"
+#include <sstream>
 
-#define SEQUENTIAL(rank,bank) (rank*NUM_BANKS)+bank
-
-/* Power computations are localized to MemoryController.cpp */ 
-extern unsigned IDD0;
-extern unsigned IDD1;
-extern unsigned IDD2P;
-extern unsigned IDD2Q;
-extern unsigned IDD2N;
-extern unsigned IDD3Pf;
-extern unsigned IDD3Ps;
-extern unsigned IDD3N;
-extern unsigned IDD4W;
-extern unsigned IDD4R;
-extern unsigned IDD5;
-extern unsigned IDD6;
-extern unsigned IDD6L;
-extern unsigned IDD7;
-extern float Vdd; 
+#define SEQUENTIAL(rank,bank) (rank*config.NUM_BANKS)+bank
 
 using namespace DRAMSim;
 
-MemoryController::MemoryController(MemorySystem *parent, CSVWriter &csvOut_, ostream &dramsim_log_) :
+MemoryController::MemoryController(MemorySystem *parent, const Config &config_, CSVWriter &csvOut_, ostream &dramsim_log_) :
+		config(config_),
 		dramsim_log(dramsim_log_),
-		bankStates(NUM_RANKS, vector<BankState>(NUM_BANKS, dramsim_log)),
-		commandQueue(bankStates, dramsim_log_),
+		bankStates(config.NUM_RANKS, BankStates(config.NUM_BANKS, dramsim_log)),
+		commandQueue(config, bankStates, dramsim_log_),
 		poppedBusPacket(NULL),
 		csvOut(csvOut_),
 		totalTransactions(0),
-		refreshRank(0)
+		totalReads(0),
+		totalReadLatency(0),
+		refreshRank(0),
+		scheduleFunction(selectSchedule(config_)),
+		bankTransactions(config.NUM_RANKS * config.NUM_BANKS),
+		indexedTransactions(0),
+		transactionArrivals(0)
 {
 	//get handle on parent
 	parentMemorySystem = parent;
@@ -87,6 +78,10 @@ MemoryController::MemoryController(MemorySystem *parent, CSVWriter &csvOut_, ost
 
         numFakeFS = 0;
 
+	//DAGs and the command trace are handed over by MultiChannelMemorySystem
+	dagCache = NULL;
+	commandTrace = NULL;
+
 	/*
 	currentPhase = -1;
 	remainingInPhase = 0;
@@ -103,31 +98,36 @@ MemoryController::MemoryController(MemorySystem *parent, CSVWriter &csvOut_, ost
 	*/
 
 	//reserve memory for vectors
-	transactionQueue.reserve(TRANS_QUEUE_DEPTH);
-	defenceQueue.reserve(DEFENCE_QUEUE_DEPTH);
-	powerDown = vector<bool>(NUM_RANKS,false);
-	grandTotalBankAccesses = vector<uint64_t>(NUM_RANKS*NUM_BANKS,0);
-	totalReadsPerBank = vector<uint64_t>(NUM_RANKS*NUM_BANKS,0);
-	totalWritesPerBank = vector<uint64_t>(NUM_RANKS*NUM_BANKS,0);
-	totalReadsPerRank = vector<uint64_t>(NUM_RANKS,0);
-	totalWritesPerRank = vector<uint64_t>(NUM_RANKS,0);
-
-	writeDataCountdown.reserve(NUM_RANKS);
-	writeDataToSend.reserve(NUM_RANKS);
-	refreshCountdown.reserve(NUM_RANKS);
+	transactionQueue.reserve(config.TRANS_QUEUE_DEPTH);
+	defenceQueue.reserve(config.DEFENCE_QUEUE_DEPTH);
+	defenceByBank = vector< vector< deque<Transaction *> > >(2, vector< deque<Transaction *> >(config.NUM_BANKS));
+	powerDown = vector<bool>(config.NUM_RANKS,false);
+	grandTotalBankAccesses = vector<uint64_t>(config.NUM_RANKS*config.NUM_BANKS,0);
+	totalReadsPerBank = vector<uint64_t>(config.NUM_RANKS*config.NUM_BANKS,0);
+	totalWritesPerBank = vector<uint64_t>(config.NUM_RANKS*config.NUM_BANKS,0);
+	totalReadsPerRank = vector<uint64_t>(config.NUM_RANKS,0);
+	totalWritesPerRank = vector<uint64_t>(config.NUM_RANKS,0);
+
+	writeDataCountdown.reserve(config.NUM_RANKS);
+	writeDataToSend.reserve(config.NUM_RANKS);
+	refreshCountdown.reserve(config.NUM_RANKS);
 
 	//Power related packets
-	backgroundEnergy = vector <uint64_t >(NUM_RANKS,0);
-	burstEnergy = vector <uint64_t> (NUM_RANKS,0);
-	actpreEnergy = vector <uint64_t> (NUM_RANKS,0);
-	refreshEnergy = vector <uint64_t> (NUM_RANKS,0);
+	backgroundEnergy = vector <uint64_t >(config.NUM_RANKS,0);
+	burstEnergy = vector <uint64_t> (config.NUM_RANKS,0);
+	actpreEnergy = vector <uint64_t> (config.NUM_RANKS,0);
+	refreshEnergy = vector <uint64_t> (config.NUM_RANKS,0);
+	backgroundState = vector<BackgroundState>(config.NUM_RANKS, PrechargeStandby);
+	backgroundSince = vector<uint64_t>(config.NUM_RANKS, 0);
+	seenBackgroundChanges = vector<unsigned>(config.NUM_RANKS, 0);
+	backgroundCycles = vector< vector<uint64_t> >(config.NUM_RANKS, vector<uint64_t>(NUM_BACKGROUND_STATES, 0));
 
-	totalEpochLatency = vector<uint64_t> (NUM_RANKS*NUM_BANKS,0);
+	totalEpochLatency = vector<uint64_t> (config.NUM_RANKS*config.NUM_BANKS,0);
 
 	//staggers when each rank is due for a refresh
-	for (size_t i=0;i<NUM_RANKS;i++)
+	for (size_t i=0;i<config.NUM_RANKS;i++)
 	{
-		refreshCountdown.push_back((int)((REFRESH_PERIOD/tCK)/NUM_RANKS)*(i+1));
+		refreshCountdown.push_back((int)((config.REFRESH_PERIOD/config.tCK)/config.NUM_RANKS)*(i+1));
 	}
 }
 
@@ -141,14 +141,14 @@ void MemoryController::receiveFromBus(BusPacket *bpacket)
 		exit(0);
 	}
 
-	if (DEBUG_BUS)
+	if (config.DEBUG_BUS)
 	{
 		PRINTN(" -- MC Receiving From Data Bus : ");
 		bpacket->print();
 	}
 
 	//add to return read data queue
-	returnTransaction.push_back(new Transaction(RETURN_DATA, bpacket->physicalAddress, bpacket->data, -1, -1, false, -1));
+	returnTransaction.push_back(newTransaction(RETURN_DATA, bpacket->physicalAddress, bpacket->data, -1, -1, false, -1));
 	totalReadsPerBank[SEQUENTIAL(bpacket->rank,bpacket->bank)]++;
 
 	// this delete statement saves a mindboggling amount of memory
@@ -174,39 +174,15 @@ void MemoryController::attachRanks(vector<Rank *> *ranks)
 void MemoryController::initDefence(int domainID)
 {
 	/* Create bookkeeping maps for convenience */
-	numLoops.push_back(this->dag[domainID].size());
+	numLoops.push_back(dags[domainID]->loops.size());
 	currentLoop.push_back(0);
 	currentLoopIteration.push_back(0);
 
-	parentList.push_back(vector<map<int,vector<int>>>());
-	childrenList.push_back(vector<map<int,vector<int>>>());
-	weightList.push_back(vector<map<int,map<int, int>>>());
-	finishTimes.push_back(vector<map<int,uint64_t>>());
-
 	totalNodes.push_back(0);
 	totalFakeReadRequests.push_back(0);
 	totalFakeWriteRequests.push_back(0);
 
-
-    // Determine lineages
-	for (int i = 0; i < numLoops[domainID]; i++) { // Per loop
-		parentList[domainID].push_back(map<int,vector<int>>());
-		childrenList[domainID].push_back(map<int,vector<int>>());
-		weightList[domainID].push_back(map<int,map<int, int>>());
-		finishTimes[domainID].push_back(map<int,uint64_t>());
-
-		for (auto& edge : this->dag[domainID][to_string(i)]["edge"].items()) {
-			int srcNode = edge.value()["sourceID"];
-			int destNode = edge.value()["destID"];
-			parentList[domainID][i][destNode].push_back(srcNode);
-			childrenList[domainID][i][srcNode].push_back(destNode);
-			weightList[domainID][i][srcNode][destNode] = edge.value()["latency"];
-		}
-
-		for (auto& node : this->dag[domainID][to_string(i)]["node"].items()) {
-			finishTimes[domainID][i][node.value()["nodeID"]] = std::numeric_limits<uint64_t>::max();
-		}
-	}
+	buildDefenceLoops(domainID);
 
 	// Immediately schedule the initial node 
 	int scheduledTime = currentClockCycle + 1;
@@ -217,6 +193,90 @@ void MemoryController::initDefence(int domainID)
 	PRINT("Initializing Defence!");
 }
 
+// domain IDs are small numbers handed out by the CPU model, so they index a table
+#define MAX_DOMAIN_ID (1<<20)
+
+void MemoryController::rebuildDomainGroups()
+{
+	if (dataIDArr.size() > 64)
+	{
+		ERROR("== Error - At most 64 protection groups are supported, got "<<dataIDArr.size());
+		exit(-1);
+	}
+
+	size_t size = 0;
+	const map<int,int> *revs[] = {&revOldInst, &revOldData, &revInst, &revData};
+	for (size_t r=0; r<4; r++)
+	{
+		for (map<int,int>::const_iterator it=revs[r]->begin(); it!=revs[r]->end(); it++)
+		{
+			if (it->first >= MAX_DOMAIN_ID)
+			{
+				ERROR("== Error - Domain ID "<<it->first<<" is larger than "<<MAX_DOMAIN_ID);
+				exit(-1);
+			}
+			if (it->first >= 0)
+			{
+				size = max(size, (size_t)it->first + 1);
+			}
+		}
+	}
+
+	DomainGroup none = {-1, false, 0, 0};
+	domainGroups.assign(size, none);
+	// lowest priority first so the later maps win
+	for (size_t r=0; r<4; r++)
+	{
+		for (map<int,int>::const_iterator it=revs[r]->begin(); it!=revs[r]->end(); it++)
+		{
+			if (it->first < 0) continue;
+			domainGroups[it->first].group = it->second;
+			if (r >= 2) domainGroups[it->first].defended = true;
+		}
+	}
+
+	for (size_t g=0; g<dataIDArr.size(); g++)
+	{
+		int current[] = {dataIDArr[g], instIDArr[g]};
+		int old[] = {g < oldDataIDArr.size() ? oldDataIDArr[g] : -1, g < oldInstIDArr.size() ? oldInstIDArr[g] : -1};
+		for (size_t i=0; i<2; i++)
+		{
+			if (current[i] >= 0 && (size_t)current[i] < size)
+			{
+				domainGroups[current[i]].slots |= 1ULL << g;
+				domainGroups[current[i]].secure |= 1ULL << g;
+			}
+			if (old[i] >= 0 && (size_t)old[i] < size)
+			{
+				domainGroups[old[i]].slots |= 1ULL << g;
+			}
+		}
+	}
+}
+
+const MemoryController::DomainGroup &MemoryController::domainGroup(uint64_t securityDomain) const
+{
+	static const DomainGroup none = {-1, false, 0, 0};
+	return securityDomain < domainGroups.size() ? domainGroups[securityDomain] : none;
+}
+
+// every loop of a domain's DAG starts out with nothing finished
+void MemoryController::buildDefenceLoops(int domainID)
+{
+	if (defenceLoops.size() <= (size_t)domainID)
+	{
+		defenceLoops.resize(domainID + 1);
+	}
+	defenceLoops[domainID] = vector<DefenceLoop>(dags[domainID]->loops.size());
+
+	for (size_t i = 0; i < defenceLoops[domainID].size(); i++) { // Per loop
+		DefenceLoop &loop = defenceLoops[domainID][i];
+		loop.dag = &dags[domainID]->loops[i];
+		loop.finishTimes = vector<uint64_t>(loop.dag->bankID.size(), std::numeric_limits<uint64_t>::max());
+		loop.loopsBack = false;
+	}
+}
+
 void MemoryController::stopDefence()
 {
 	PRINT("Stopping Defence Deprecated!");
@@ -229,42 +289,13 @@ void MemoryController::update()
 	//PRINT(" ------------------------- [" << currentClockCycle << "/" << nextFRClockCycle << "] -------------------------");
 
 	if (currentClockCycle > nextFRClockCycle) {
-		nextFRClockCycle += FIXED_SERVICE_RATE;
-                commandQueue.nextFRClockCycle += FIXED_SERVICE_RATE;
+		nextFRClockCycle += config.FIXED_SERVICE_RATE;
+                commandQueue.nextFRClockCycle += config.FIXED_SERVICE_RATE;
 	}
 	//update bank states
-	for (size_t i=0;i<NUM_RANKS;i++)
+	for (size_t i=0;i<config.NUM_RANKS;i++)
 	{
-		for (size_t j=0;j<NUM_BANKS;j++)
-		{
-			if (bankStates[i][j].stateChangeCountdown>0)
-			{
-				//decrement counters
-				bankStates[i][j].stateChangeCountdown--;
-
-				//if counter has reached 0, change state
-				if (bankStates[i][j].stateChangeCountdown == 0)
-				{
-					switch (bankStates[i][j].lastCommand)
-					{
-						//only these commands have an implicit state change
-					case WRITE_P:
-					case READ_P:
-						bankStates[i][j].currentBankState = Precharging;
-						bankStates[i][j].lastCommand = PRECHARGE;
-						bankStates[i][j].stateChangeCountdown = tRP;
-						break;
-
-					case REFRESH:
-					case PRECHARGE:
-						bankStates[i][j].currentBankState = Idle;
-						break;
-					default:
-						break;
-					}
-				}
-			}
-		}
+		bankStates[i].countDown(config.tRP);
 	}
 
 
@@ -274,6 +305,10 @@ void MemoryController::update()
 		cmdCyclesLeft--;
 		if (cmdCyclesLeft == 0) //packet is ready to be received by rank
 		{
+			if (commandTrace != NULL)
+			{
+				commandTrace->record(parentMemorySystem->systemID, currentClockCycle, *outgoingCmdPacket);
+			}
 			(*ranks)[outgoingCmdPacket->rank]->receiveFromBus(outgoingCmdPacket);
 			outgoingCmdPacket = NULL;
 		}
@@ -312,7 +347,7 @@ void MemoryController::update()
 		if (writeDataCountdown[0]==0)
 		{
 			//send to bus and print debug stuff
-			if (DEBUG_BUS)
+			if (config.DEBUG_BUS)
 			{
 				PRINTN(" -- MC Issuing On Data Bus    : ");
 				writeDataToSend[0]->print();
@@ -326,7 +361,7 @@ void MemoryController::update()
 			}
 
 			outgoingDataPacket = writeDataToSend[0];
-			dataCyclesLeft = BL/2;
+			dataCyclesLeft = config.timing.BURST_CYCLES;
 
 			totalTransactions++;
 			totalWritesPerBank[SEQUENTIAL(writeDataToSend[0]->rank,writeDataToSend[0]->bank)]++;
@@ -342,15 +377,15 @@ void MemoryController::update()
 	{
 		commandQueue.needRefresh(refreshRank);
 		(*ranks)[refreshRank]->refreshWaiting = true;
-		refreshCountdown[refreshRank] =	 REFRESH_PERIOD/tCK;
+		refreshCountdown[refreshRank] =	 config.REFRESH_PERIOD/config.tCK;
 		refreshRank++;
-		if (refreshRank == NUM_RANKS)
+		if (refreshRank == config.NUM_RANKS)
 		{
 			refreshRank = 0;
 		}
 	}
 	//if a rank is powered down, make sure we power it up in time for a refresh
-	else if (powerDown[refreshRank] && refreshCountdown[refreshRank] <= tXP)
+	else if (powerDown[refreshRank] && refreshCountdown[refreshRank] <= config.tXP)
 	{
 		(*ranks)[refreshRank]->refreshWaiting = true;
 	}
@@ -366,7 +401,7 @@ void MemoryController::update()
 			writeDataToSend.push_back(new BusPacket(DATA, poppedBusPacket->physicalAddress, poppedBusPacket->column,
 			                                    poppedBusPacket->row, poppedBusPacket->rank, poppedBusPacket->bank,
 			                                    poppedBusPacket->data, poppedBusPacket->isFake, poppedBusPacket->securityDomain, dramsim_log));
-			writeDataCountdown.push_back(WL);
+			writeDataCountdown.push_back(config.timing.WL);
 		}
 
 		//
@@ -380,48 +415,40 @@ void MemoryController::update()
 			case READ_P:
 			case READ:
 				//add energy to account for total
-				if (DEBUG_POWER)
+				if (config.DEBUG_POWER)
 				{
 					PRINT(" ++ Adding Read energy to total energy");
 				}
-				burstEnergy[rank] += (IDD4R - IDD3N) * BL/2 * NUM_DEVICES;
+				burstEnergy[rank] += (config.IDD4R - config.IDD3N) * config.timing.BURST_CYCLES * config.NUM_DEVICES;
 				if (poppedBusPacket->busPacketType == READ_P) 
 				{
 					//Don't bother setting next read or write times because the bank is no longer active
-					//bankStates[rank][bank].currentBankState = Idle;
-					bankStates[rank][bank].nextActivate = max(currentClockCycle + READ_AUTOPRE_DELAY,
-							bankStates[rank][bank].nextActivate);
-					bankStates[rank][bank].lastCommand = READ_P;
-					bankStates[rank][bank].stateChangeCountdown = READ_TO_PRE_DELAY;
+					//bankStates[rank].currentBankState[bank] = Idle;
+					bankStates[rank].nextActivate[bank] = max(currentClockCycle + config.timing.READ_AUTOPRE_DELAY,
+							bankStates[rank].nextActivate[bank]);
+					bankStates[rank].lastCommand[bank] = READ_P;
+					bankStates[rank].stateChangeCountdown[bank] = config.timing.READ_TO_PRE_DELAY;
 				}
 				else if (poppedBusPacket->busPacketType == READ)
 				{
-					bankStates[rank][bank].nextPrecharge = max(currentClockCycle + READ_TO_PRE_DELAY,
-							bankStates[rank][bank].nextPrecharge);
-					bankStates[rank][bank].lastCommand = READ;
+					bankStates[rank].nextPrecharge[bank] = max(currentClockCycle + config.timing.READ_TO_PRE_DELAY,
+							bankStates[rank].nextPrecharge[bank]);
+					bankStates[rank].lastCommand[bank] = READ;
 
 				}
 
-				for (size_t i=0;i<NUM_RANKS;i++)
+				for (size_t i=0;i<config.NUM_RANKS;i++)
 				{
-					for (size_t j=0;j<NUM_BANKS;j++)
+					if (i!=poppedBusPacket->rank)
 					{
-						if (i!=poppedBusPacket->rank)
-						{
-							//check to make sure it is active before trying to set (save's time?)
-							if (bankStates[i][j].currentBankState == RowActive)
-							{
-								bankStates[i][j].nextRead = max(currentClockCycle + BL/2 + tRTRS, bankStates[i][j].nextRead);
-								bankStates[i][j].nextWrite = max(currentClockCycle + READ_TO_WRITE_DELAY,
-										bankStates[i][j].nextWrite);
-							}
-						}
-						else
-						{
-							bankStates[i][j].nextRead = max(currentClockCycle + max(tCCD, BL/2), bankStates[i][j].nextRead);
-							bankStates[i][j].nextWrite = max(currentClockCycle + READ_TO_WRITE_DELAY,
-									bankStates[i][j].nextWrite);
-						}
+						//only the banks with an open row can take a column command
+						bankStates[i].delayActive(bankStates[i].nextRead, currentClockCycle + config.timing.RANK_SWITCH_DELAY);
+						bankStates[i].delayActive(bankStates[i].nextWrite, currentClockCycle + config.timing.READ_TO_WRITE_DELAY);
+					}
+					else
+					{
+						BankStates::delay(bankStates[i].nextRead, currentClockCycle + config.timing.CCD_DELAY);
+						BankStates::delay(bankStates[i].nextWrite, currentClockCycle + config.timing.READ_TO_WRITE_DELAY);
 					}
 				}
 
@@ -430,8 +457,8 @@ void MemoryController::update()
 					//set read and write to nextActivate so the state table will prevent a read or write
 					//  being issued (in cq.isIssuable())before the bank state has been changed because of the
 					//  auto-precharge associated with this command
-					bankStates[rank][bank].nextRead = bankStates[rank][bank].nextActivate;
-					bankStates[rank][bank].nextWrite = bankStates[rank][bank].nextActivate;
+					bankStates[rank].nextRead[bank] = bankStates[rank].nextActivate[bank];
+					bankStates[rank].nextWrite[bank] = bankStates[rank].nextActivate[bank];
 				}
 
 				break;
@@ -439,45 +466,37 @@ void MemoryController::update()
 			case WRITE:
 				if (poppedBusPacket->busPacketType == WRITE_P) 
 				{
-					bankStates[rank][bank].nextActivate = max(currentClockCycle + WRITE_AUTOPRE_DELAY,
-							bankStates[rank][bank].nextActivate);
-					bankStates[rank][bank].lastCommand = WRITE_P;
-					bankStates[rank][bank].stateChangeCountdown = WRITE_TO_PRE_DELAY;
+					bankStates[rank].nextActivate[bank] = max(currentClockCycle + config.timing.WRITE_AUTOPRE_DELAY,
+							bankStates[rank].nextActivate[bank]);
+					bankStates[rank].lastCommand[bank] = WRITE_P;
+					bankStates[rank].stateChangeCountdown[bank] = config.timing.WRITE_TO_PRE_DELAY;
 				}
 				else if (poppedBusPacket->busPacketType == WRITE)
 				{
-					bankStates[rank][bank].nextPrecharge = max(currentClockCycle + WRITE_TO_PRE_DELAY,
-							bankStates[rank][bank].nextPrecharge);
-					bankStates[rank][bank].lastCommand = WRITE;
+					bankStates[rank].nextPrecharge[bank] = max(currentClockCycle + config.timing.WRITE_TO_PRE_DELAY,
+							bankStates[rank].nextPrecharge[bank]);
+					bankStates[rank].lastCommand[bank] = WRITE;
 				}
 
 
 				//add energy to account for total
-				if (DEBUG_POWER)
+				if (config.DEBUG_POWER)
 				{
 					PRINT(" ++ Adding Write energy to total energy");
 				}
-				burstEnergy[rank] += (IDD4W - IDD3N) * BL/2 * NUM_DEVICES;
+				burstEnergy[rank] += (config.IDD4W - config.IDD3N) * config.timing.BURST_CYCLES * config.NUM_DEVICES;
 
-				for (size_t i=0;i<NUM_RANKS;i++)
+				for (size_t i=0;i<config.NUM_RANKS;i++)
 				{
-					for (size_t j=0;j<NUM_BANKS;j++)
+					if (i!=poppedBusPacket->rank)
 					{
-						if (i!=poppedBusPacket->rank)
-						{
-							if (bankStates[i][j].currentBankState == RowActive)
-							{
-								bankStates[i][j].nextWrite = max(currentClockCycle + BL/2 + tRTRS, bankStates[i][j].nextWrite);
-								bankStates[i][j].nextRead = max(currentClockCycle + WRITE_TO_READ_DELAY_R,
-										bankStates[i][j].nextRead);
-							}
-						}
-						else
-						{
-							bankStates[i][j].nextWrite = max(currentClockCycle + max(BL/2, tCCD), bankStates[i][j].nextWrite);
-							bankStates[i][j].nextRead = max(currentClockCycle + WRITE_TO_READ_DELAY_B,
-									bankStates[i][j].nextRead);
-						}
+						bankStates[i].delayActive(bankStates[i].nextWrite, currentClockCycle + config.timing.RANK_SWITCH_DELAY);
+						bankStates[i].delayActive(bankStates[i].nextRead, currentClockCycle + config.timing.WRITE_TO_READ_DELAY_R);
+					}
+					else
+					{
+						BankStates::delay(bankStates[i].nextWrite, currentClockCycle + config.timing.CCD_DELAY);
+						BankStates::delay(bankStates[i].nextRead, currentClockCycle + config.timing.WRITE_TO_READ_DELAY_B);
 					}
 				}
 
@@ -486,70 +505,67 @@ void MemoryController::update()
 				//  auto-precharge associated with this command
 				if (poppedBusPacket->busPacketType == WRITE_P)
 				{
-					bankStates[rank][bank].nextRead = bankStates[rank][bank].nextActivate;
-					bankStates[rank][bank].nextWrite = bankStates[rank][bank].nextActivate;
+					bankStates[rank].nextRead[bank] = bankStates[rank].nextActivate[bank];
+					bankStates[rank].nextWrite[bank] = bankStates[rank].nextActivate[bank];
 				}
 
 				break;
 			case ACTIVATE:
 				//add energy to account for total
-				if (DEBUG_POWER)
+				if (config.DEBUG_POWER)
 				{
 					PRINT(" ++ Adding Activate and Precharge energy to total energy");
 				}
-				actpreEnergy[rank] += ((IDD0 * tRC) - ((IDD3N * tRAS) + (IDD2N * (tRC - tRAS)))) * NUM_DEVICES;
+				actpreEnergy[rank] += ((config.IDD0 * config.tRC) - ((config.IDD3N * config.tRAS) + (config.IDD2N * (config.tRC - config.tRAS)))) * config.NUM_DEVICES;
 
-				bankStates[rank][bank].currentBankState = RowActive;
-				bankStates[rank][bank].lastCommand = ACTIVATE;
-				bankStates[rank][bank].openRowAddress = poppedBusPacket->row;
-				bankStates[rank][bank].nextActivate = max(currentClockCycle + tRC, bankStates[rank][bank].nextActivate);
-				bankStates[rank][bank].nextPrecharge = max(currentClockCycle + tRAS, bankStates[rank][bank].nextPrecharge);
+				bankStates[rank].currentBankState[bank] = RowActive;
+				bankStates[rank].lastCommand[bank] = ACTIVATE;
+				bankStates[rank].openRowAddress[bank] = poppedBusPacket->row;
+				bankStates[rank].nextActivate[bank] = max(currentClockCycle + config.tRC, bankStates[rank].nextActivate[bank]);
+				bankStates[rank].nextPrecharge[bank] = max(currentClockCycle + config.tRAS, bankStates[rank].nextPrecharge[bank]);
 
 				//if we are using posted-CAS, the next column access can be sooner than normal operation
 
-				bankStates[rank][bank].nextRead = max(currentClockCycle + (tRCD-AL), bankStates[rank][bank].nextRead);
-				bankStates[rank][bank].nextWrite = max(currentClockCycle + (tRCD-AL), bankStates[rank][bank].nextWrite);
+				bankStates[rank].nextRead[bank] = max(currentClockCycle + (config.tRCD-config.AL), bankStates[rank].nextRead[bank]);
+				bankStates[rank].nextWrite[bank] = max(currentClockCycle + (config.tRCD-config.AL), bankStates[rank].nextWrite[bank]);
 
-				for (size_t i=0;i<NUM_BANKS;i++)
 				{
-					if (i!=poppedBusPacket->bank)
-					{
-						bankStates[rank][i].nextActivate = max(currentClockCycle + tRRD, bankStates[rank][i].nextActivate);
-					}
+					//tRRD holds for every other bank of the rank
+					uint64_t nextActivate = bankStates[rank].nextActivate[bank];
+					BankStates::delay(bankStates[rank].nextActivate, currentClockCycle + config.tRRD);
+					bankStates[rank].nextActivate[bank] = nextActivate;
 				}
 
 				break;
 			case PRECHARGE:
-				bankStates[rank][bank].currentBankState = Precharging;
-				bankStates[rank][bank].lastCommand = PRECHARGE;
-				bankStates[rank][bank].stateChangeCountdown = tRP;
-				bankStates[rank][bank].nextActivate = max(currentClockCycle + tRP, bankStates[rank][bank].nextActivate);
+				bankStates[rank].currentBankState[bank] = Precharging;
+				bankStates[rank].lastCommand[bank] = PRECHARGE;
+				bankStates[rank].stateChangeCountdown[bank] = config.tRP;
+				bankStates[rank].nextActivate[bank] = max(currentClockCycle + config.tRP, bankStates[rank].nextActivate[bank]);
 
 				break;
 			case REFRESH:
 				//add energy to account for total
-				if (DEBUG_POWER)
+				if (config.DEBUG_POWER)
 				{
 					PRINT(" ++ Adding Refresh energy to total energy");
 				}
-				refreshEnergy[rank] += (IDD5 - IDD3N) * tRFC * NUM_DEVICES;
+				refreshEnergy[rank] += (config.IDD5 - config.IDD3N) * config.tRFC * config.NUM_DEVICES;
 
-				for (size_t i=0;i<NUM_BANKS;i++)
-				{
-					bankStates[rank][i].nextActivate = currentClockCycle + tRFC;
-					bankStates[rank][i].currentBankState = Refreshing;
-					bankStates[rank][i].lastCommand = REFRESH;
-					bankStates[rank][i].stateChangeCountdown = tRFC;
-				}
+				fill(bankStates[rank].nextActivate.begin(), bankStates[rank].nextActivate.end(), currentClockCycle + config.tRFC);
+				bankStates[rank].set(Refreshing);
+				fill(bankStates[rank].lastCommand.begin(), bankStates[rank].lastCommand.end(), REFRESH);
+				fill(bankStates[rank].stateChangeCountdown.begin(), bankStates[rank].stateChangeCountdown.end(), config.tRFC);
 
 				break;
 			default:
 				ERROR("== Error - Popped a command we shouldn't have of type : " << poppedBusPacket->busPacketType);
 				exit(0);
 		}
+		updateBackgroundState(rank);
 
 		//issue on bus and print debug
-		if (DEBUG_BUS)
+		if (config.DEBUG_BUS)
 		{
 			PRINTN(" -- MC Issuing On Command Bus : ");
 			poppedBusPacket->print();
@@ -562,533 +578,55 @@ void MemoryController::update()
 			exit(-1);
 		}
 		outgoingCmdPacket = poppedBusPacket;
-		cmdCyclesLeft = tCMD;
-
-	}
-
-        // For regular protection domains, do nothing special
-	if (protection == Regular || protection == FixedService_Channel || protection == FixedRate) {
-		for (size_t i=0;i<transactionQueue.size();i++)
-		{
-			//pop off top transaction from queue
-			//
-			//	assuming simple scheduling at the moment
-			//	will eventually add policies here
-			Transaction *transaction = transactionQueue[i];
-
-			//map address to rank,bank,row,col
-			unsigned newTransactionChan, newTransactionRank, newTransactionBank, newTransactionRow, newTransactionColumn;
-
-			// pass these in as references so they get set by the addressMapping function
-			addressMapping(transaction->address, newTransactionChan, newTransactionRank, newTransactionBank, newTransactionRow, newTransactionColumn);
-
-            if (SINGLE_BANK) newTransactionBank = 0;
-
-			//if we have room, break up the transaction into the appropriate commands
-			//and add them to the command queue
-			if (commandQueue.hasRoomFor(2, newTransactionRank, newTransactionBank))
-			{
-				if (DEBUG_ADDR_MAP) 
-				{
-					PRINTN("== New Transaction - Mapping Address [0x" << hex << transaction->address << dec << "]");
-					if (transaction->transactionType == DATA_READ) 
-					{
-						PRINT(" (Read)");
-					}
-					else
-					{
-						PRINT(" (Write)");
-					}
-					PRINT("  Rank : " << newTransactionRank);
-					PRINT("  Bank : " << newTransactionBank);
-					PRINT("  Row  : " << newTransactionRow);
-					PRINT("  Col  : " << newTransactionColumn);
-					PRINT("  Domain  : " << transaction->securityDomain);
-					PRINT("  Time  : " << currentClockCycle);
-				}
-
-
-
-				//now that we know there is room in the command queue, we can remove from the transaction queue
-				transactionQueue.erase(transactionQueue.begin()+i);
-
-				//create activate command to the row we just translated
-				BusPacket *ACTcommand = new BusPacket(ACTIVATE, transaction->address,
-						newTransactionColumn, newTransactionRow, newTransactionRank,
-						newTransactionBank, 0, transaction->isFake, transaction->securityDomain, dramsim_log);
-
-				//create read or write command and enqueue it
-				BusPacketType bpType = transaction->getBusPacketType();
-				BusPacket *command = new BusPacket(bpType, transaction->address,
-						newTransactionColumn, newTransactionRow, newTransactionRank,
-						newTransactionBank, transaction->data, transaction->isFake, transaction->securityDomain, dramsim_log);
-
-
-
-				commandQueue.enqueue(ACTcommand);
-				commandQueue.enqueue(command);
-
-				// If we have a read, save the transaction so when the data comes back
-				// in a bus packet, we can staple it back into a transaction and return it
-				if (transaction->transactionType == DATA_READ)
-				{
-					pendingReadTransactions.push_back(transaction);
-				}
-				else
-				{
-					// just delete the transaction now that it's a buspacket
-					delete transaction; 
-				}
-				/* only allow one transaction to be scheduled per cycle -- this should
-				* be a reasonable assumption considering how much logic would be
-				* required to schedule multiple entries per cycle (parallel data
-				* lines, switching logic, decision logic)
-				*/
-				break;
-			}
-			else // no room, do nothing this cycle
-			{
-				//PRINT( "== Warning - No room in command queue" << endl;
-			}
-		}
-          // DAGguise Protection Logic
-	} else if (protection == DAG) {
-
-		// First, check if we have anything scheduled
-		int scheduledBank = -1;
-		int scheduledNode, scheduledDomain;
-
-		if (scheduleNode.count(currentClockCycle)) {
-			if (DEBUG_DEFENCE) PRINT("Executing scheduled node\n");
-			
-                        // Determine the scheduled defence node's information
-			scheduledNode = scheduleNode[currentClockCycle];
-			scheduledDomain = scheduleDomain[currentClockCycle];
-
-                        // Determine CPU -> Security Domain Mapping
-			int dataID = dataIDArr[scheduledDomain];
-			int instID = instIDArr[scheduledDomain];
-
-			int oldDataID = -100;
-			int oldInstID = -100;
-
-			if(oldDataIDArr.size() > scheduledDomain) {
-				oldDataID = oldDataIDArr[scheduledDomain];
-				oldInstID = oldInstIDArr[scheduledDomain];
-			}
-
-			if (DEBUG_DEFENCE) PRINT("currloop" << to_string(currentLoop[scheduledDomain]) << " curcycle " << currentClockCycle << " transqueue " << transactionQueue.size()) ;
-
-                        // Determine the scheduled bank to read from
-			scheduledBank = this->dag[scheduledDomain][to_string(currentLoop[scheduledDomain])]["node"][scheduledNode]["bankID"];
-
-			Transaction *transaction;
-
-			Transaction *readTransaction;
-			int readID = -1;
-
-			Transaction *writeTransaction;
-			int writeID = -1;
-
-                        // Check if we also need to write 
-			int writeRequested = this->dag[scheduledDomain][to_string(currentLoop[scheduledDomain])]["node"][scheduledNode]["combinedWB"];
-			int writeBank = this->dag[scheduledDomain][to_string(currentLoop[scheduledDomain])]["node"][scheduledNode]["combinedWBBankID"];
-			
-			unsigned newTransactionChan, newTransactionRank, newTransactionBank, newTransactionRow, newTransactionColumn;
-
-			// Search the defence queue for a match...
-			for (size_t i=0; i<defenceQueue.size(); i++) {
-				transaction = defenceQueue[i];
-
-                                // If this entry doesn't match our security domain requirements, skip it
-				if (transaction->securityDomain != dataID && transaction->securityDomain != instID && transaction->securityDomain != oldDataID && transaction->securityDomain != oldInstID) continue;
-                                // Calculate the address mapping
-				addressMapping(transaction->address, newTransactionChan, newTransactionRank, newTransactionBank, newTransactionRow, newTransactionColumn);
-          
-                                // If we're doing a single bank simulation, map everything to bank 0
-				if (SINGLE_BANK) newTransactionBank = 0;
-
-				// Did we find a matching read transaction?
-				if (transaction->transactionType == DATA_READ && readID == -1 && scheduledBank == newTransactionBank) {
-					readTransaction = transaction;
-					readID = i;
-                    defenceQueue.erase(defenceQueue.begin()+readID);
-                    i--;
-				} // Maybe a matching write transaction instead? 
-				else if (transaction->transactionType == DATA_WRITE && writeID == -1 && writeRequested && writeBank == newTransactionBank) {
-					writeTransaction = transaction;
-					writeID = i;
-                	defenceQueue.erase(defenceQueue.begin()+writeID);
-                    i--;
-				} // If neither, go to the next
-				else continue;
-
-				transaction->nodeID = scheduledNode;
-
-				if ((readID != -1) && (writeID != -1 || !writeRequested)) break;
-
-			}
-
-                        // Issue fake read request, if no matching transactions found
-			if (readID == -1) {
-				if(DEBUG_DEFENCE) PRINT("No matching read transaction, enqueuing fake request")
-
-				totalFakeReadRequests[scheduledDomain]++;
-				readTransaction = new Transaction(DATA_READ, 0, nullptr, dataID, scheduledNode, true, scheduledBank);
-				readTransaction->timeAdded = currentClockCycle;
-			} 
-			transactionQueue.push_back(readTransaction);
-  
-                        // If we need to issue a write request, and no matching request was found, issue one of those as well
-			if(writeRequested) {
-				if (writeID == -1) {
-					if(DEBUG_DEFENCE) PRINT("No matching write transaction, enqueuing fake request")
-
-					totalFakeWriteRequests[scheduledDomain]++;                    
-					writeTransaction = new Transaction(DATA_WRITE, 0, nullptr, dataID, scheduledNode, true, writeBank);
-					writeTransaction->timeAdded = currentClockCycle;
-				}
-
-				transactionQueue.push_back(writeTransaction);
-			}
-
-
-		}
-
-		for (size_t i=0;i<transactionQueue.size();i++)
-		{
-			Transaction *transaction;
-			unsigned newTransactionChan, newTransactionRank, newTransactionBank, newTransactionRow, newTransactionColumn;
-			//pop off top transaction from queue
-			//
-			//	assuming simple scheduling at the moment
-			//	will eventually add policies here
-			transaction = transactionQueue[i];
-
-			//map address to rank,bank,row,col
-
-			// pass these in as references so they get set by the addressMapping function
-			addressMapping(transaction->address, newTransactionChan, newTransactionRank, newTransactionBank, newTransactionRow, newTransactionColumn);
-
-                        // Again, map all single bank tests to bank 0, and mark fake transactions as special
-                        // This is done so we don't accidentally return fake requests to the CPU!
-			if (SINGLE_BANK) newTransactionBank = 0;
-			else if (transaction->isFake) newTransactionBank = transaction->fakeBank;
-                        //PRINT("index " << i << " contains address" << transaction->address);
-
-			// If we have a request scheduled, try to match the bank with a transaction in the queue
-
-			//if we have room, break up the transaction into the appropriate commands
-			//and add them to the command queue
-			if (commandQueue.hasRoomFor(2, newTransactionRank, newTransactionBank))
-			{
-				if (DEBUG_ADDR_MAP) 
-				{
-					PRINTN("== New Transaction - Mapping Address [0x" << hex << transaction->address << dec << "]");
-					if (transaction->transactionType == DATA_READ) 
-					{
-						PRINT(" (Read)");
-					}
-					else
-					{
-						PRINT(" (Write)");
-					}
-					PRINT("  Rank : " << newTransactionRank);
-					PRINT("  Bank : " << newTransactionBank);
-					PRINT("  Row  : " << newTransactionRow);
-					PRINT("  Col  : " << newTransactionColumn);
-					PRINT("  Domain  : " << transaction->securityDomain);
-					PRINT("  Time  : " << currentClockCycle);
-					PRINT("  Fake? : " << transaction->isFake);
-				}
-
-				//now that we know there is room in the command queue, we can remove from the transaction queue
-				transactionQueue.erase(transactionQueue.begin()+i);
-
-				//create activate command to the row we just translated
-				BusPacket *ACTcommand = new BusPacket(ACTIVATE, transaction->address,
-						newTransactionColumn, newTransactionRow, newTransactionRank,
-						newTransactionBank, 0, transaction->isFake, transaction->securityDomain, dramsim_log);
-
-				//create read or write command and enqueue it
-				BusPacketType bpType = transaction->getBusPacketType();
-				BusPacket *command = new BusPacket(bpType, transaction->address,
-						newTransactionColumn, newTransactionRow, newTransactionRank,
-						newTransactionBank, transaction->data, transaction->isFake, transaction->securityDomain, dramsim_log);
+		cmdCyclesLeft = config.tCMD;
 
-				commandQueue.enqueue(ACTcommand);
-				commandQueue.enqueue(command);
-
-				// If we have a read, save the transaction so when the data comes back
-				// in a bus packet, we can staple it back into a transaction and return it
-				if (transaction->transactionType == DATA_READ)
-				{
-					pendingReadTransactions.push_back(transaction);
-				}
-				else
-				{
-					// just delete the transaction now that it's a buspacket
-					delete transaction; 
-				}
-				/* only allow one transaction to be scheduled per cycle -- this should
-				* be a reasonable assumption considering how much logic would be
-				* required to schedule multiple entries per cycle (parallel data
-				* lines, switching logic, decision logic)
-				*/
-				break;
-			}
-			else // no room, do nothing this cycle
-			{
-				//PRINT( "== Warning - No room in command queue" << endl;
-			}
-		}
 	}
-	else {
-  
-                // Do the FS-BTA cyclewise math (as outlined in their paper)
-		int skip = 1;
-		if (protection == FixedService_Rank && currentClockCycle % 7 == 0) {
-			skip = 0;
-		} else if (protection == FixedService_Bank && currentClockCycle % 15 == 0) {
-			skip = 0;
-		} else if (protection == FixedService_BTA && currentClockCycle % 43 == 0 && SINGLE_BANK) {
-			skip = 0;
-		} else if (protection == FixedService_BTA && currentClockCycle % 15 == 0 && !SINGLE_BANK) {
-			skip = 0;
-		}
-		
-		if (!skip) {
-			// Search for transaction we can issue
-			currentDomain = (currentDomain + 1) % NUM_DOMAINS;
-			BTAPhase = (BTAPhase + 1) % 3;
-                        
-                        // Speculatively increment the fake FS counter (decrement it later if we were wrong) 
-                        numFakeFS++;
-			
-                        //if (!SINGLE_BANK) PRINT("BTA PHASE: " << BTAPhase);
-                        //PRINT("CURRENT DOMAIN: " << currentDomain);
-
-			for (size_t i=0;i<transactionQueue.size();i++)
-			{
-				//pop off top transaction from queue
-				//
-				//	assuming simple scheduling at the moment
-				//	will eventually add policies here
-				Transaction *transaction = transactionQueue[i];
-
-				//map address to rank,bank,row,col
-				unsigned newTransactionChan, newTransactionRank, newTransactionBank, newTransactionRow, newTransactionColumn;
-
-				// pass these in as references so they get set by the addressMapping function
-				addressMapping(transaction->address, newTransactionChan, newTransactionRank, newTransactionBank, newTransactionRow, newTransactionColumn);
-
-				if (SINGLE_BANK) newTransactionBank = 0;
-				//Technically NUM_DOMAINS must be a power, but that's too hard to check.
-				assert(NUM_DOMAINS % 2 == 0);
-
-				if (!SINGLE_BANK) {
-					if (newTransactionBank % 3 != BTAPhase) {
-						continue;
-					}
-				}
-
-                                // Calculate the security domain status of the current transaction
-				bool isSecure0 = !(dataIDArr.size() < 1) && (transaction->securityDomain == dataIDArr[0] || transaction->securityDomain == instIDArr[0]);
-				bool isSecure1 = !(dataIDArr.size() < 2) && (transaction->securityDomain == dataIDArr[1] || transaction->securityDomain == instIDArr[1]);
-				bool isSecure2 = !(dataIDArr.size() < 3) && (transaction->securityDomain == dataIDArr[2] || transaction->securityDomain == instIDArr[2]);
-				bool isSecure3 = !(dataIDArr.size() < 4) && (transaction->securityDomain == dataIDArr[3] || transaction->securityDomain == instIDArr[3]);
-
-                                // Now, check if we can issue it!
-				if (NUM_DOMAINS == 2) {
-					if (currentDomain == 0 && !isSecure0) {
-						continue;
-					} else if (currentDomain == 1 && isSecure0) {
-						continue;
-					}
-				} else if (NUM_DOMAINS == 4) {
-					if (currentDomain == 0 && !isSecure0) {
-						continue;
-					} else if (currentDomain == 1 && !isSecure1) {
-						continue;
-					} else if (currentDomain > 1 && (isSecure0 || isSecure1)) {
-						continue;
-					}
-				} else if (NUM_DOMAINS == 8) {
-                                       if (currentDomain == 0 && !isSecure0) continue;
-                                       else if (currentDomain == 1 && !isSecure1) continue;
-                                       else if (currentDomain == 2 && !isSecure2) continue;
-                                       else if (currentDomain == 3 && !isSecure3) continue;
-                                       else if (currentDomain > 3 && (isSecure0 || isSecure1 || isSecure2 || isSecure3)) continue;
-                                } else {
-					assert(false);
-				}
-
-                                // If we've gotten this far, we'll issue. Thus, we're issuing a real request.
-                                numFakeFS--;
-				
-				//if we have room, break up the transaction into the appropriate commands
-				//and add them to the command queue
-				if (commandQueue.hasRoomFor(2, newTransactionRank, newTransactionBank))
-				{
-					if (DEBUG_ADDR_MAP) 
-					{
-						PRINTN("== New Transaction - Mapping Address [0x" << hex << transaction->address << dec << "]");
-						if (transaction->transactionType == DATA_READ) 
-						{
-							PRINT(" (Read)");
-						}
-						else
-						{
-							PRINT(" (Write)");
-						}
-						PRINT("  Protection Domain  : " << currentDomain);
-						PRINT("  Time  : " << currentClockCycle);
-						PRINT("  Rank : " << newTransactionRank);
-						PRINT("  Bank : " << newTransactionBank);
-						PRINT("  Row  : " << newTransactionRow);
-						PRINT("  Col  : " << newTransactionColumn);
-					}
-
-
-					//now that we know there is room in the command queue, we can remove from the transaction queue
-					transactionQueue.erase(transactionQueue.begin()+i);
-
-					//create activate command to the row we just translated
-					BusPacket *ACTcommand = new BusPacket(ACTIVATE, transaction->address,
-							newTransactionColumn, newTransactionRow, newTransactionRank,
-							newTransactionBank, 0, transaction->isFake, transaction->securityDomain, dramsim_log);
-
-					//create read or write command and enqueue it
-					BusPacketType bpType = transaction->getBusPacketType();
-					BusPacket *command = new BusPacket(bpType, transaction->address,
-							newTransactionColumn, newTransactionRow, newTransactionRank,
-							newTransactionBank, transaction->data, transaction->isFake, transaction->securityDomain, dramsim_log);
-
-
-
-					commandQueue.enqueue(ACTcommand);
-					commandQueue.enqueue(command);
-
-					// If we have a read, save the transaction so when the data comes back
-					// in a bus packet, we can staple it back into a transaction and return it
-					if (transaction->transactionType == DATA_READ)
-					{
-						pendingReadTransactions.push_back(transaction);
-					}
-					else
-					{
-						// just delete the transaction now that it's a buspacket
-						delete transaction; 
-					}
-					/* only allow one transaction to be scheduled per cycle -- this should
-					* be a reasonable assumption considering how much logic would be
-					* required to schedule multiple entries per cycle (parallel data
-					* lines, switching logic, decision logic)
-					*/
-					break;
-				}
-				else // no room, do nothing this cycle
-				{
-					PRINT( "== Warning - No room in command queue" << endl );
-				}
-			}
 
-		}
-	}
+	// the transaction scheduler for this protection and page policy was
+	// picked when the controller was built
+	(this->*scheduleFunction)();
 
 
 	//calculate power
 	//  this is done on a per-rank basis, since power characterization is done per device (not per bank)
-	for (size_t i=0;i<NUM_RANKS;i++)
+	for (size_t i=0;i<config.NUM_RANKS;i++)
 	{
-		if (USE_LOW_POWER)
+		if (config.USE_LOW_POWER)
 		{
 			//if there are no commands in the queue and that particular rank is not waiting for a refresh...
 			if (commandQueue.isEmpty(i) && !(*ranks)[i]->refreshWaiting)
 			{
-				//check to make sure all banks are idle
-				bool allIdle = true;
-				for (size_t j=0;j<NUM_BANKS;j++)
-				{
-					if (bankStates[i][j].currentBankState != Idle)
-					{
-						allIdle = false;
-						break;
-					}
-				}
-
-				//if they ARE all idle, put in power down mode and set appropriate fields
-				if (allIdle)
+				//if all the banks are idle, put in power down mode and set appropriate fields
+				if (bankStates[i].all(Idle))
 				{
 					powerDown[i] = true;
 					(*ranks)[i]->powerDown();
-					for (size_t j=0;j<NUM_BANKS;j++)
-					{
-						bankStates[i][j].currentBankState = PowerDown;
-						bankStates[i][j].nextPowerUp = currentClockCycle + tCKE;
-					}
+					bankStates[i].set(PowerDown);
+					fill(bankStates[i].nextPowerUp.begin(), bankStates[i].nextPowerUp.end(), currentClockCycle + config.tCKE);
 				}
 			}
 			//if there IS something in the queue or there IS a refresh waiting (and we can power up), do it
-			else if (currentClockCycle >= bankStates[i][0].nextPowerUp && powerDown[i]) //use 0 since theyre all the same
+			else if (currentClockCycle >= bankStates[i].nextPowerUp[0] && powerDown[i]) //use 0 since theyre all the same
 			{
 				powerDown[i] = false;
 				(*ranks)[i]->powerUp();
-				for (size_t j=0;j<NUM_BANKS;j++)
-				{
-					bankStates[i][j].currentBankState = Idle;
-					bankStates[i][j].nextActivate = currentClockCycle + tXP;
-				}
-			}
-		}
-
-		//check for open bank
-		bool bankOpen = false;
-		for (size_t j=0;j<NUM_BANKS;j++)
-		{
-			if (bankStates[i][j].currentBankState == Refreshing ||
-			        bankStates[i][j].currentBankState == RowActive)
-			{
-				bankOpen = true;
-				break;
+				bankStates[i].set(Idle);
+				fill(bankStates[i].nextActivate.begin(), bankStates[i].nextActivate.end(), currentClockCycle + config.tXP);
 			}
 		}
 
-		//background power is dependent on whether or not a bank is open or not
-		if (bankOpen)
-		{
-			if (DEBUG_POWER)
-			{
-				PRINT(" ++ Adding IDD3N to total energy [from rank "<< i <<"]");
-			}
-			backgroundEnergy[i] += IDD3N * NUM_DEVICES;
-		}
-		else
+		//background energy only changes rate when the rank does
+		if (bankStates[i].stateChanges != seenBackgroundChanges[i])
 		{
-			//if we're in power-down mode, use the correct current
-			if (powerDown[i])
-			{
-				if (DEBUG_POWER)
-				{
-					PRINT(" ++ Adding IDD2P to total energy [from rank " << i << "]");
-				}
-				backgroundEnergy[i] += IDD2P * NUM_DEVICES;
-			}
-			else
-			{
-				if (DEBUG_POWER)
-				{
-					PRINT(" ++ Adding IDD2N to total energy [from rank " << i << "]");
-				}
-				backgroundEnergy[i] += IDD2N * NUM_DEVICES;
-			}
+			seenBackgroundChanges[i] = bankStates[i].stateChanges;
+			updateBackgroundState(i);
 		}
 	}
 
 	//check for outstanding data to return to the CPU
 	if (returnTransaction.size()>0)
 	{
-		if (DEBUG_BUS)
+		if (config.DEBUG_BUS)
 		{
 			PRINTN(" -- MC Issuing to CPU bus : " << *returnTransaction[0]);
 		}
@@ -1105,83 +643,86 @@ void MemoryController::update()
 				//		pendingReadTransactions[i]->print();
 				//		exit(0);
 				//	}
-				unsigned chan,rank,bank,row,col;
-				addressMapping(returnTransaction[0]->address,chan,rank,bank,row,col);
 				if(!pendingReadTransactions[i]->isFake) {
+					unsigned chan,rank,bank,row,col;
+					addressMapping(config, returnTransaction[0]->address,chan,rank,bank,row,col);
 					insertHistogram(currentClockCycle-pendingReadTransactions[i]->timeAdded,rank,bank);
 					//return latency
 					returnReadData(pendingReadTransactions[i]);
 				}
 
-				int currDomain = -1;
-
-				if (revData.count(pendingReadTransactions[i]->securityDomain)) currDomain = revData[pendingReadTransactions[i]->securityDomain];
-				else if (revInst.count(pendingReadTransactions[i]->securityDomain)) currDomain = revInst[pendingReadTransactions[i]->securityDomain];
-				else if (revOldData.count(pendingReadTransactions[i]->securityDomain)) currDomain = revOldData[pendingReadTransactions[i]->securityDomain];
-				else if (revOldInst.count(pendingReadTransactions[i]->securityDomain)) currDomain = revOldInst[pendingReadTransactions[i]->securityDomain];
+				int currDomain = domainGroup(pendingReadTransactions[i]->securityDomain).group;
 
-				if (protection == DAG && currDomain != -1) {
-					if (DEBUG_DEFENCE) PRINT("Finished Transaction " << hex << pendingReadTransactions[i]->address << "(node " << pendingReadTransactions[i]->nodeID << " at time " << dec << currentClockCycle << " in domain " << currDomain);
+				if (config.protection == DAG && currDomain != -1) {
+					if (config.DEBUG_DEFENCE) PRINT("Finished Transaction " << hex << pendingReadTransactions[i]->address << "(node " << pendingReadTransactions[i]->nodeID << " at time " << dec << currentClockCycle << " in domain " << currDomain);
 
 					// Update phase information
 					int loopID = currentLoop[currDomain];
-					finishTimes[currDomain][loopID][pendingReadTransactions[i]->nodeID] = currentClockCycle;
+					DefenceLoop &loop = defenceLoops[currDomain][loopID];
+					int nodeID = pendingReadTransactions[i]->nodeID;
+					int numNodes = loop.dag->bankID.size();
 
 					totalNodes[currDomain]++;
-					if (pendingReadTransactions[i]->nodeID == this->dag[currDomain][to_string(loopID)]["node"].size() - 1) {
+					// requests of an old domain that went through the normal queue have no node
+					if (nodeID >= 0 && nodeID < numNodes) {
+					loop.finishTimes[nodeID] = currentClockCycle;
+
+					if (nodeID == numNodes - 1) {
 						// We've reached the end of the loop! 
 						// Check if we're repeating the section, or starting a new one.
-						if (currentLoopIteration[currDomain]+1 == this->dag[currDomain][to_string(loopID)]["loop"]) {
+						if (currentLoopIteration[currDomain]+1 == loop.dag->iterations) {
 							// We're done here, move to next block
-							if (DEBUG_DEFENCE) PRINT("Finished loop body, moving to loop " << (currentLoop[currDomain] + 1) % this->dag[currDomain].size());
-							currentLoop[currDomain] = (currentLoop[currDomain] + 1) % this->dag[currDomain].size();
+							if (config.DEBUG_DEFENCE) PRINT("Finished loop body, moving to loop " << (currentLoop[currDomain] + 1) % numLoops[currDomain]);
+							currentLoop[currDomain] = (currentLoop[currDomain] + 1) % numLoops[currDomain];
 							currentLoopIteration[currDomain] = 0;
 						} else {
 							// We're looping!
-							if (DEBUG_DEFENCE) PRINT("Looping!");
+							if (config.DEBUG_DEFENCE) PRINT("Looping!");
 							currentLoopIteration[currDomain]++;
 							// If we haven't looped before, we'll have to set our target.
-							if (childrenList[currDomain][loopID][pendingReadTransactions[i]->nodeID].size() == 0) {
-								childrenList[currDomain][loopID][pendingReadTransactions[i]->nodeID].push_back(0);
+							if (loop.dag->children[nodeID].size() == 0) {
+								loop.loopsBack = true;
 							}
 
 						}
 
-						for (auto& node : this->dag[currDomain][to_string(loopID)]["node"].items()) {
-							finishTimes[currDomain][loopID][node.value()["nodeID"]] = std::numeric_limits<uint64_t>::max();
-						}
+						fill(loop.finishTimes.begin(), loop.finishTimes.end(), std::numeric_limits<uint64_t>::max());
 
 					} 
 					// Check all children
-					for (auto& child : childrenList[currDomain][loopID][pendingReadTransactions[i]->nodeID]) {
+					const vector<int> &children = loop.dag->children[nodeID];
+					bool toFirst = loop.loopsBack && nodeID == numNodes - 1 && children.empty();
+					for (size_t c = 0; c < children.size() + toFirst; c++) {
+						int child = toFirst ? 0 : children[c];
 						// If all parents of the child are complete, we can issue it!
 						bool ready = true;
-						for (auto& parent : parentList[currDomain][loopID][child]) {
-							if (DEBUG_DEFENCE) PRINT("Parent: " << parent << " Child: " << child);
+						for (auto& parent : loop.dag->parents[child]) {
+							if (config.DEBUG_DEFENCE) PRINT("Parent: " << parent << " Child: " << child);
 
-							if (finishTimes[currDomain][loopID][parent] > currentClockCycle) {
-								if (DEBUG_DEFENCE) PRINT("NOT READY!");
+							if (loop.finishTimes[parent] > currentClockCycle) {
+								if (config.DEBUG_DEFENCE) PRINT("NOT READY!");
 								ready = false;
 								break;
 							}							
 						}
 
 						if (ready) {
-							int edgeWeight = weightList[currDomain][loopID][pendingReadTransactions[i]->nodeID][child]/DEF_CLK_DIV;
+							int edgeWeight = toFirst ? 0 : loop.dag->childLatency[nodeID][c]/config.DEF_CLK_DIV;
 							int scheduledTime = edgeWeight + currentClockCycle;
 
                             if (scheduledTime == currentClockCycle) scheduledTime++;
 							while (scheduleNode.count(scheduledTime) > 0) scheduledTime++;
 							scheduleNode[scheduledTime] = child;
 							scheduleDomain[scheduledTime] = currDomain;
-							if (DEBUG_DEFENCE) PRINT("Issuing new node " << child << " at time" << scheduledTime);
+							if (config.DEBUG_DEFENCE) PRINT("Issuing new node " << child << " at time" << scheduledTime);
 
 						}
 					}
+					}
 
 				}
 
-				delete pendingReadTransactions[i];
+				releaseTransaction(pendingReadTransactions[i]);
 				pendingReadTransactions.erase(pendingReadTransactions.begin()+i);
 				foundMatch=true; 
 
@@ -1194,12 +735,12 @@ void MemoryController::update()
 			ERROR("Can't find a matching transaction for 0x"<<hex<<returnTransaction[0]->address<<dec);
 			abort(); 
 		}
-		delete returnTransaction[0];
+		recycleTransaction(returnTransaction[0]);
 		returnTransaction.erase(returnTransaction.begin());
 	}
 
 	//decrement refresh counters
-	for (size_t i=0;i<NUM_RANKS;i++)
+	for (size_t i=0;i<config.NUM_RANKS;i++)
 	{
 		refreshCountdown[i]--;
 	}
@@ -1207,7 +748,7 @@ void MemoryController::update()
 	//
 	//print debug
 	//
-	if (DEBUG_TRANS_Q)
+	if (config.DEBUG_TRANS_Q)
 	{
 		PRINT("== Printing transaction queue");
 		for (size_t i=0;i<transactionQueue.size();i++)
@@ -1216,31 +757,31 @@ void MemoryController::update()
 		}
 	}
 
-	if (DEBUG_BANKSTATE)
+	if (config.DEBUG_BANKSTATE)
 	{
 		//TODO: move this to BankState.cpp
 		PRINT("== Printing bank states (According to MC)");
-		for (size_t i=0;i<NUM_RANKS;i++)
+		for (size_t i=0;i<config.NUM_RANKS;i++)
 		{
-			for (size_t j=0;j<NUM_BANKS;j++)
+			for (size_t j=0;j<config.NUM_BANKS;j++)
 			{
-				if (bankStates[i][j].currentBankState == RowActive)
+				if (bankStates[i].currentBankState[j] == RowActive)
 				{
-					PRINTN("[" << bankStates[i][j].openRowAddress << "] ");
+					PRINTN("[" << bankStates[i].openRowAddress[j] << "] ");
 				}
-				else if (bankStates[i][j].currentBankState == Idle)
+				else if (bankStates[i].currentBankState[j] == Idle)
 				{
 					PRINTN("[idle] ");
 				}
-				else if (bankStates[i][j].currentBankState == Precharging)
+				else if (bankStates[i].currentBankState[j] == Precharging)
 				{
 					PRINTN("[pre] ");
 				}
-				else if (bankStates[i][j].currentBankState == Refreshing)
+				else if (bankStates[i].currentBankState[j] == Refreshing)
 				{
 					PRINTN("[ref] ");
 				}
-				else if (bankStates[i][j].currentBankState == PowerDown)
+				else if (bankStates[i].currentBankState[j] == PowerDown)
 				{
 					PRINTN("[lowp] ");
 				}
@@ -1249,7 +790,7 @@ void MemoryController::update()
 		}
 	}
 
-	if (DEBUG_CMD_Q)
+	if (config.DEBUG_CMD_Q)
 	{
 		commandQueue.print();
 	}
@@ -1258,24 +799,450 @@ void MemoryController::update()
 
 }
 
-bool MemoryController::WillAcceptTransaction()
+// the FS modes that hand out issue slots by cycle; FixedService_Channel and
+// FixedRate go through the same scheduler as Regular
+static inline bool isFixedService(Protection protection)
 {
-	return transactionQueue.size() < TRANS_QUEUE_DEPTH;
+	return protection == FixedService_Rank || protection == FixedService_Bank || protection == FixedService_BTA;
 }
 
-bool MemoryController::WillAcceptDefenceTransaction()
+/**
+ * Moves the transaction at transactionQueue[index] into the command queue as
+ * an ACT and a column command, if the command queue has room for both.
+ */
+template <Protection P, RowBufferPolicy R>
+bool MemoryController::issueTransaction(size_t index, unsigned rank, unsigned bank, unsigned row, unsigned column)
 {
-	return defenceQueue.size() < DEFENCE_QUEUE_DEPTH;
-}
-
-//allows outside source to make request of memory system
+	if (!commandQueue.hasRoomFor(2, rank, bank))
+	{
+		return false;
+	}
+
+	Transaction *transaction = transactionQueue[index];
+	if (config.DEBUG_ADDR_MAP) 
+	{
+		PRINTN("== New Transaction - Mapping Address [0x" << hex << transaction->address << dec << "]");
+		if (transaction->transactionType == DATA_READ) 
+		{
+			PRINT(" (Read)");
+		}
+		else
+		{
+			PRINT(" (Write)");
+		}
+		if (isFixedService(P))
+		{
+			PRINT("  Protection Domain  : " << currentDomain);
+			PRINT("  Time  : " << currentClockCycle);
+		}
+		PRINT("  Rank : " << rank);
+		PRINT("  Bank : " << bank);
+		PRINT("  Row  : " << row);
+		PRINT("  Col  : " << column);
+		if (!isFixedService(P))
+		{
+			PRINT("  Domain  : " << transaction->securityDomain);
+			PRINT("  Time  : " << currentClockCycle);
+		}
+		if (P == DAG)
+		{
+			PRINT("  Fake? : " << transaction->isFake);
+		}
+	}
+
+	//now that we know there is room in the command queue, we can remove from the transaction queue
+	transactionQueue.erase(transactionQueue.begin()+index);
+
+	//create activate command to the row we just translated
+	BusPacket *ACTcommand = new BusPacket(ACTIVATE, transaction->address,
+			column, row, rank, bank, 0, transaction->isFake, transaction->securityDomain, dramsim_log);
+
+	//create read or write command and enqueue it
+	BusPacketType bpType = transaction->getBusPacketType(R);
+	BusPacket *command = new BusPacket(bpType, transaction->address,
+			column, row, rank, bank, transaction->data, transaction->isFake, transaction->securityDomain, dramsim_log);
+
+	commandQueue.enqueue(ACTcommand);
+	commandQueue.enqueue(command);
+
+	// If we have a read, save the transaction so when the data comes back
+	// in a bus packet, we can staple it back into a transaction and return it
+	if (transaction->transactionType == DATA_READ)
+	{
+		pendingReadTransactions.push_back(transaction);
+	}
+	else
+	{
+		// just delete the transaction now that it's a buspacket
+		releaseTransaction(transaction);
+	}
+	return true;
+}
+
+// the transactions the controller makes up itself (DAG padding and read
+// data on its way back) are recycled instead of going back to the heap
+Transaction *MemoryController::newTransaction(TransactionType transType, uint64_t addr, void *data, uint64_t securityDomain, int nodeID, bool isFake, int fakeBank)
+{
+	if (spareTransactions.empty())
+	{
+		return new Transaction(transType, addr, data, securityDomain, nodeID, isFake, fakeBank);
+	}
+	Transaction *trans = spareTransactions.back();
+	spareTransactions.pop_back();
+	return new (trans) Transaction(transType, addr, data, securityDomain, nodeID, isFake, fakeBank);
+}
+
+void MemoryController::recycleTransaction(Transaction *trans)
+{
+	spareTransactions.push_back(trans);
+}
+
+// done with a request: made up ones are kept for newTransaction(), the CPU's
+// are deleted as before
+void MemoryController::releaseTransaction(Transaction *trans)
+{
+	if (trans->isFake)
+	{
+		recycleTransaction(trans);
+	}
+	else
+	{
+		delete trans;
+	}
+}
+
+// files a defenceQueue entry under its type and bank as well
+void MemoryController::indexDefenceTransaction(Transaction *trans)
+{
+	unsigned chan, rank, bank = 0, row, col;
+	if (!config.SINGLE_BANK)
+	{
+		addressMapping(config, trans->address, chan, rank, bank, row, col);
+	}
+	defenceByBank[trans->transactionType == DATA_WRITE][bank].push_back(trans);
+}
+
+// removes and returns the oldest defenceQueue entry of the given type for
+// bank that belongs to one of the domains, or NULL if there is none
+Transaction *MemoryController::takeDefenceTransaction(TransactionType type, int bank, int group)
+{
+	if (bank < 0 || bank >= (int)config.NUM_BANKS)
+	{
+		return NULL;
+	}
+	deque<Transaction *> &entries = defenceByBank[type == DATA_WRITE][bank];
+	for (size_t i=0; i<entries.size(); i++)
+	{
+		Transaction *transaction = entries[i];
+		// If this entry doesn't match our security domain requirements, skip it
+		if (!(domainGroup(transaction->securityDomain).slots & (1ULL << group))) continue;
+
+		entries.erase(entries.begin()+i);
+		defenceQueue.erase(find(defenceQueue.begin(), defenceQueue.end(), transaction));
+		return transaction;
+	}
+	return NULL;
+}
+
+// DAGguise: turn the DAG node scheduled for this cycle (if any) into a read
+// and maybe a write, taken from the defence queue or made up
+void MemoryController::enqueueScheduledNode()
+{
+	// First, check if we have anything scheduled
+	int scheduledBank = -1;
+	int scheduledNode, scheduledDomain;
+
+	if (scheduleNode.count(currentClockCycle)) {
+		if (config.DEBUG_DEFENCE) PRINT("Executing scheduled node\n");
+		
+                        // Determine the scheduled defence node's information
+		scheduledNode = scheduleNode[currentClockCycle];
+		scheduledDomain = scheduleDomain[currentClockCycle];
+
+                        // Determine CPU -> Security Domain Mapping (made up requests go out as data)
+		int dataID = dataIDArr[scheduledDomain];
+
+		if (config.DEBUG_DEFENCE) PRINT("currloop" << to_string(currentLoop[scheduledDomain]) << " curcycle " << currentClockCycle << " transqueue " << transactionQueue.size()) ;
+
+                        // Determine the scheduled bank to read from
+		const DefenceLoop &loop = defenceLoops[scheduledDomain][currentLoop[scheduledDomain]];
+		scheduledBank = loop.dag->bankID[scheduledNode];
+
+		Transaction *readTransaction;
+		Transaction *writeTransaction = NULL;
+
+                        // Check if we also need to write 
+		int writeRequested = loop.dag->combinedWB[scheduledNode];
+		int writeBank = loop.dag->combinedWBBankID[scheduledNode];
+		
+		// Search the defence queue for a match...
+		readTransaction = takeDefenceTransaction(DATA_READ, scheduledBank, scheduledDomain);
+		if (readTransaction) readTransaction->nodeID = scheduledNode;
+		if (writeRequested) {
+			writeTransaction = takeDefenceTransaction(DATA_WRITE, writeBank, scheduledDomain);
+			if (writeTransaction) writeTransaction->nodeID = scheduledNode;
+		}
+
+                        // Issue fake read request, if no matching transactions found
+		if (!readTransaction) {
+			if(config.DEBUG_DEFENCE) PRINT("No matching read transaction, enqueuing fake request")
+
+			totalFakeReadRequests[scheduledDomain]++;
+			readTransaction = newTransaction(DATA_READ, 0, nullptr, dataID, scheduledNode, true, scheduledBank);
+			readTransaction->timeAdded = currentClockCycle;
+		} 
+		transactionQueue.push_back(readTransaction);
+  
+                        // If we need to issue a write request, and no matching request was found, issue one of those as well
+		if(writeRequested) {
+			if (!writeTransaction) {
+				if(config.DEBUG_DEFENCE) PRINT("No matching write transaction, enqueuing fake request")
+
+				totalFakeWriteRequests[scheduledDomain]++;                    
+				writeTransaction = newTransaction(DATA_WRITE, 0, nullptr, dataID, scheduledNode, true, writeBank);
+				writeTransaction->timeAdded = currentClockCycle;
+			}
+
+			transactionQueue.push_back(writeTransaction);
+		}
+
+
+	}
+}
+
+/**
+ * Picks at most one transaction to break up into commands this cycle.
+ *
+ * P and R are template parameters so that each protection mode and page
+ * policy gets its own copy of this loop with the mode checks folded away;
+ * selectSchedule() picks the copy for the configuration once, when the
+ * controller is built.
+ */
+template <Protection P, RowBufferPolicy R>
+void MemoryController::scheduleTransactions()
+{
+	if (isFixedService(P))
+	{
+		// Do the FS-BTA cyclewise math (as outlined in their paper)
+		int skip = 1;
+		if (P == FixedService_Rank && currentClockCycle % 7 == 0) {
+			skip = 0;
+		} else if (P == FixedService_Bank && currentClockCycle % 15 == 0) {
+			skip = 0;
+		} else if (P == FixedService_BTA && currentClockCycle % 43 == 0 && config.SINGLE_BANK) {
+			skip = 0;
+		} else if (P == FixedService_BTA && currentClockCycle % 15 == 0 && !config.SINGLE_BANK) {
+			skip = 0;
+		}
+
+		if (skip)
+		{
+			return;
+		}
+
+		// Search for transaction we can issue
+		currentDomain = (currentDomain + 1) % config.NUM_DOMAINS;
+		BTAPhase = (BTAPhase + 1) % 3;
+
+		// Speculatively increment the fake FS counter (decrement it later if we were wrong) 
+		numFakeFS++;
+
+		for (size_t i=0;i<transactionQueue.size();i++)
+		{
+			Transaction *transaction = transactionQueue[i];
+
+			//map address to rank,bank,row,col
+			unsigned newTransactionChan, newTransactionRank, newTransactionBank, newTransactionRow, newTransactionColumn;
+			addressMapping(config, transaction->address, newTransactionChan, newTransactionRank, newTransactionBank, newTransactionRow, newTransactionColumn);
+
+			if (config.SINGLE_BANK) newTransactionBank = 0;
+			//Technically NUM_DOMAINS must be a power, but that's too hard to check.
+			assert(config.NUM_DOMAINS % 2 == 0);
+
+			if (!config.SINGLE_BANK) {
+				if (newTransactionBank % 3 != BTAPhase) {
+					continue;
+				}
+			}
+
+			// Calculate the security domain status of the current transaction
+			uint64_t secure = domainGroup(transaction->securityDomain).secure;
+			bool isSecure0 = secure & 1;
+			bool isSecure1 = secure & 2;
+			bool isSecure2 = secure & 4;
+			bool isSecure3 = secure & 8;
+
+			// Now, check if we can issue it!
+			if (config.NUM_DOMAINS == 2) {
+				if (currentDomain == 0 && !isSecure0) {
+					continue;
+				} else if (currentDomain == 1 && isSecure0) {
+					continue;
+				}
+			} else if (config.NUM_DOMAINS == 4) {
+				if (currentDomain == 0 && !isSecure0) {
+					continue;
+				} else if (currentDomain == 1 && !isSecure1) {
+					continue;
+				} else if (currentDomain > 1 && (isSecure0 || isSecure1)) {
+					continue;
+				}
+			} else if (config.NUM_DOMAINS == 8) {
+				if (currentDomain == 0 && !isSecure0) continue;
+				else if (currentDomain == 1 && !isSecure1) continue;
+				else if (currentDomain == 2 && !isSecure2) continue;
+				else if (currentDomain == 3 && !isSecure3) continue;
+				else if (currentDomain > 3 && (isSecure0 || isSecure1 || isSecure2 || isSecure3)) continue;
+			} else {
+				assert(false);
+			}
+
+			// If we've gotten this far, we'll issue. Thus, we're issuing a real request.
+			numFakeFS--;
+
+			if (issueTransaction<P,R>(i, newTransactionRank, newTransactionBank, newTransactionRow, newTransactionColumn))
+			{
+				break;
+			}
+			PRINT_LIMITED( "== Warning - No room in command queue" );
+		}
+		return;
+	}
+
+	if (P == DAG)
+	{
+		enqueueScheduledNode();
+	}
+	indexTransactions();
+
+	// The oldest transaction whose bank has room in the command queue goes.
+	// All the transactions to one bank wait on the same room, so only the
+	// oldest of each bank has to be looked at, oldest bank first.
+	for (set< pair<uint64_t, unsigned> >::iterator it = bankHeads.begin(); it != bankHeads.end(); ++it)
+	{
+		deque<QueuedTransaction> &transactions = bankTransactions[it->second];
+		QueuedTransaction head = transactions.front();
+		if (!commandQueue.hasRoomFor(2, head.rank, head.bank))
+		{
+			continue;
+		}
+
+		//if we have room, break up the transaction into the appropriate commands
+		//and add them to the command queue
+		/* only allow one transaction to be scheduled per cycle -- this should
+		* be a reasonable assumption considering how much logic would be
+		* required to schedule multiple entries per cycle (parallel data
+		* lines, switching logic, decision logic)
+		*/
+		size_t index = find(transactionQueue.begin(), transactionQueue.end(), head.transaction) - transactionQueue.begin();
+		issueTransaction<P,R>(index, head.rank, head.bank, head.row, head.column);
+
+		indexedTransactions--;
+		transactions.pop_front();
+		unsigned queueIndex = it->second;
+		bankHeads.erase(it);
+		if (!transactions.empty())
+		{
+			bankHeads.insert(make_pair(transactions.front().arrival, queueIndex));
+		}
+		break;
+	}
+}
+
+// maps the transactions added to transactionQueue since the last cycle to
+// their rank, bank, row and column once, and files them under their bank
+void MemoryController::indexTransactions()
+{
+	for (; indexedTransactions < transactionQueue.size(); indexedTransactions++)
+	{
+		Transaction *transaction = transactionQueue[indexedTransactions];
+		QueuedTransaction queued;
+		queued.transaction = transaction;
+		queued.arrival = transactionArrivals++;
+
+		// pass these in as references so they get set by the addressMapping function
+		unsigned chan;
+		addressMapping(config, transaction->address, chan, queued.rank, queued.bank, queued.row, queued.column);
+
+		// Map all single bank tests to bank 0, and send DAG fake requests to
+		// the bank the DAG asked for
+		if (config.SINGLE_BANK) queued.bank = 0;
+		else if (config.protection == DAG && transaction->isFake) queued.bank = transaction->fakeBank;
+
+		unsigned queueIndex = queued.rank * config.NUM_BANKS + queued.bank;
+		if (bankTransactions[queueIndex].empty())
+		{
+			bankHeads.insert(make_pair(queued.arrival, queueIndex));
+		}
+		bankTransactions[queueIndex].push_back(queued);
+	}
+}
+
+// for when transactionQueue is replaced as a whole
+void MemoryController::clearTransactionIndex()
+{
+	for (size_t i=0; i<bankTransactions.size(); i++)
+	{
+		bankTransactions[i].clear();
+	}
+	bankHeads.clear();
+	indexedTransactions = 0;
+}
+
+template <Protection P>
+MemoryController::ScheduleFunction MemoryController::selectSchedule(RowBufferPolicy rowBufferPolicy)
+{
+	if (rowBufferPolicy == OpenPage)
+	{
+		return &MemoryController::scheduleTransactions<P, OpenPage>;
+	}
+	return &MemoryController::scheduleTransactions<P, ClosePage>;
+}
+
+MemoryController::ScheduleFunction MemoryController::selectSchedule(const Config &config)
+{
+	switch (config.protection)
+	{
+	case Regular:
+		return selectSchedule<Regular>(config.rowBufferPolicy);
+	case FixedService_Bank:
+		return selectSchedule<FixedService_Bank>(config.rowBufferPolicy);
+	case FixedService_Rank:
+		return selectSchedule<FixedService_Rank>(config.rowBufferPolicy);
+	case FixedService_Channel:
+		return selectSchedule<FixedService_Channel>(config.rowBufferPolicy);
+	case FixedService_BTA:
+		return selectSchedule<FixedService_BTA>(config.rowBufferPolicy);
+	case FixedRate:
+		return selectSchedule<FixedRate>(config.rowBufferPolicy);
+	case DAG:
+		return selectSchedule<DAG>(config.rowBufferPolicy);
+	}
+	ERROR("== Error - Unknown protection");
+	abort();
+}
+
+
+bool MemoryController::WillAcceptTransaction()
+{
+	return transactionQueue.size() < config.TRANS_QUEUE_DEPTH;
+}
+
+bool MemoryController::WillAcceptDefenceTransaction()
+{
+	return defenceQueue.size() < config.DEFENCE_QUEUE_DEPTH;
+}
+
+//allows outside source to make request of memory system
 bool MemoryController::addTransaction(Transaction *trans)
 {
-	if (DEBUG_DEFENCE) PRINT("NEWTRANS: Addr: " << std::hex << trans->address << " Clk: " << std::dec << currentClockCycle << " Domain: " << trans->securityDomain << " isWrite? " << (trans->transactionType == DATA_WRITE) << " Current Cycle: " << currentClockCycle);
+	if (config.DEBUG_DEFENCE) PRINT("NEWTRANS: Addr: " << std::hex << trans->address << " Clk: " << std::dec << currentClockCycle << " Domain: " << trans->securityDomain << " isWrite? " << (trans->transactionType == DATA_WRITE) << " Current Cycle: " << currentClockCycle);
 
-	if (protection == DAG && (revData.count(trans->securityDomain) || revInst.count(trans->securityDomain))) {
-    	        if (DEBUG_DEFENCE) PRINT("PUSHED!")
+	if (config.protection == DAG && domainGroup(trans->securityDomain).defended) {
+    	        if (config.DEBUG_DEFENCE) PRINT("PUSHED!")
+		trans->timeAdded = currentClockCycle;
 		defenceQueue.push_back(trans);
+		indexDefenceTransaction(trans);
 		return true;
 	}
 
@@ -1291,11 +1258,59 @@ bool MemoryController::addTransaction(Transaction *trans)
 	}
 }
 
+BackgroundState MemoryController::rankBackgroundState(unsigned rank) const
+{
+	if (bankStates[rank].any(Refreshing) || bankStates[rank].any(RowActive))
+	{
+		return ActiveStandby;
+	}
+	return powerDown[rank] ? PrechargePowerDown : PrechargeStandby;
+}
+
+//charges a rank for the cycles it spent in its old background state and
+//starts timing the new one (the current cycle counts towards the new one)
+void MemoryController::updateBackgroundState(unsigned rank)
+{
+	BackgroundState state = rankBackgroundState(rank);
+	if (state == backgroundState[rank])
+	{
+		return;
+	}
+	uint64_t cycles = currentClockCycle - backgroundSince[rank];
+	static const char *currentName[NUM_BACKGROUND_STATES] = {"IDD2N", "IDD2P", "IDD3N"};
+	if (config.DEBUG_POWER)
+	{
+		PRINT(" ++ Adding "<<currentName[backgroundState[rank]]<<" to total energy [from rank "<< rank <<"] for "<<cycles<<" cycles");
+	}
+	accountBackgroundEnergy(rank);
+	backgroundState[rank] = state;
+}
+
+void MemoryController::accountBackgroundEnergy(unsigned rank)
+{
+	uint64_t cycles = currentClockCycle - backgroundSince[rank];
+	unsigned current = backgroundState[rank] == ActiveStandby ? config.IDD3N :
+	                   backgroundState[rank] == PrechargePowerDown ? config.IDD2P : config.IDD2N;
+	backgroundEnergy[rank] += cycles * current * config.NUM_DEVICES;
+	backgroundCycles[rank][backgroundState[rank]] += cycles;
+	backgroundSince[rank] = currentClockCycle;
+}
+
+//brings backgroundEnergy and backgroundCycles up to the current cycle
+void MemoryController::accountBackgroundEnergy()
+{
+	for (size_t i=0; i<config.NUM_RANKS; i++)
+	{
+		accountBackgroundEnergy(i);
+	}
+}
+
 void MemoryController::resetStats()
 {
-	for (size_t i=0; i<NUM_RANKS; i++)
+	accountBackgroundEnergy();
+	for (size_t i=0; i<config.NUM_RANKS; i++)
 	{
-		for (size_t j=0; j<NUM_BANKS; j++)
+		for (size_t j=0; j<config.NUM_BANKS; j++)
 		{
 			//XXX: this means the bank list won't be printed for partial epochs
 			grandTotalBankAccesses[SEQUENTIAL(i,j)] += totalReadsPerBank[SEQUENTIAL(i,j)] + totalWritesPerBank[SEQUENTIAL(i,j)];
@@ -1308,6 +1323,7 @@ void MemoryController::resetStats()
 		actpreEnergy[i] = 0;
 		refreshEnergy[i] = 0;
 		backgroundEnergy[i] = 0;
+		fill(backgroundCycles[i].begin(), backgroundCycles[i].end(), 0);
 		totalReadsPerRank[i] = 0;
 		totalWritesPerRank[i] = 0;
 	}
@@ -1319,29 +1335,29 @@ void MemoryController::printStats(bool finalStats)
 
 	//if we are not at the end of the epoch, make sure to adjust for the actual number of cycles elapsed
 
-	uint64_t cyclesElapsed = (currentClockCycle % EPOCH_LENGTH == 0) ? EPOCH_LENGTH : currentClockCycle % EPOCH_LENGTH;
-	unsigned bytesPerTransaction = (JEDEC_DATA_BUS_BITS*BL)/8;
+	uint64_t cyclesElapsed = (currentClockCycle % config.EPOCH_LENGTH == 0) ? config.EPOCH_LENGTH : currentClockCycle % config.EPOCH_LENGTH;
+	unsigned bytesPerTransaction = (config.JEDEC_DATA_BUS_BITS*config.BL)/8;
 	uint64_t totalBytesTransferred = totalTransactions * bytesPerTransaction;
-	double secondsThisEpoch = (double)cyclesElapsed * tCK * 1E-9;
+	double secondsThisEpoch = (double)cyclesElapsed * config.tCK * 1E-9;
 
 	// only per rank
-	vector<double> backgroundPower = vector<double>(NUM_RANKS,0.0);
-	vector<double> burstPower = vector<double>(NUM_RANKS,0.0);
-	vector<double> refreshPower = vector<double>(NUM_RANKS,0.0);
-	vector<double> actprePower = vector<double>(NUM_RANKS,0.0);
-	vector<double> averagePower = vector<double>(NUM_RANKS,0.0);
+	vector<double> backgroundPower = vector<double>(config.NUM_RANKS,0.0);
+	vector<double> burstPower = vector<double>(config.NUM_RANKS,0.0);
+	vector<double> refreshPower = vector<double>(config.NUM_RANKS,0.0);
+	vector<double> actprePower = vector<double>(config.NUM_RANKS,0.0);
+	vector<double> averagePower = vector<double>(config.NUM_RANKS,0.0);
 
 	// per bank variables
-	vector<double> averageLatency = vector<double>(NUM_RANKS*NUM_BANKS,0.0);
-	vector<double> bandwidth = vector<double>(NUM_RANKS*NUM_BANKS,0.0);
+	vector<double> averageLatency = vector<double>(config.NUM_RANKS*config.NUM_BANKS,0.0);
+	vector<double> bandwidth = vector<double>(config.NUM_RANKS*config.NUM_BANKS,0.0);
 
 	double totalBandwidth=0.0;
-	for (size_t i=0;i<NUM_RANKS;i++)
+	for (size_t i=0;i<config.NUM_RANKS;i++)
 	{
-		for (size_t j=0; j<NUM_BANKS; j++)
+		for (size_t j=0; j<config.NUM_BANKS; j++)
 		{
 			bandwidth[SEQUENTIAL(i,j)] = (((double)(totalReadsPerBank[SEQUENTIAL(i,j)]+totalWritesPerBank[SEQUENTIAL(i,j)]) * (double)bytesPerTransaction)/(1024.0*1024.0*1024.0)) / secondsThisEpoch;
-			averageLatency[SEQUENTIAL(i,j)] = ((float)totalEpochLatency[SEQUENTIAL(i,j)] / (float)(totalReadsPerBank[SEQUENTIAL(i,j)])) * tCK;
+			averageLatency[SEQUENTIAL(i,j)] = ((float)totalEpochLatency[SEQUENTIAL(i,j)] / (float)(totalReadsPerBank[SEQUENTIAL(i,j)])) * config.tCK;
 			totalBandwidth+=bandwidth[SEQUENTIAL(i,j)];
 			totalReadsPerRank[i] += totalReadsPerBank[SEQUENTIAL(i,j)];
 			totalWritesPerRank[i] += totalWritesPerBank[SEQUENTIAL(i,j)];
@@ -1351,8 +1367,13 @@ void MemoryController::printStats(bool finalStats)
 	dramsim_log.precision(3);
 	dramsim_log.setf(ios::fixed,ios::floatfield);
 #else
-	cout.precision(3);
-	cout.setf(ios::fixed,ios::floatfield);
+	// several memory systems may be running on different threads, so leave
+	// cout alone unless we are actually printing to it
+	if (SHOW_SIM_OUTPUT)
+	{
+		cout.precision(3);
+		cout.setf(ios::fixed,ios::floatfield);
+	}
 #endif
 
 	PRINT( " =======================================================" );
@@ -1360,16 +1381,27 @@ void MemoryController::printStats(bool finalStats)
 	PRINTN( "   Total Return Transactions : " << totalTransactions );
 	PRINT( " ("<<totalBytesTransferred <<" bytes) aggregate average bandwidth "<<totalBandwidth<<"GB/s");
 
+	accountBackgroundEnergy();
+	if (config.DEBUG_POWER)
+	{
+		for (size_t i=0;i<config.NUM_RANKS;i++)
+		{
+			PRINT( "   Rank "<<i<<" background cycles : IDD2N "<<backgroundCycles[i][PrechargeStandby]
+			       <<" IDD2P "<<backgroundCycles[i][PrechargePowerDown]<<" IDD3N "<<backgroundCycles[i][ActiveStandby]
+			       <<" (energy "<<backgroundEnergy[i]<<")");
+		}
+	}
+
 	//PRINT(" ========== Defence DAG Statistics ========== ");
 	//PRINT("\nFinal Defence Nodes Executed: " << std::dec << totalNodes << ",\nNumber of Fake Read Requests: " << totalFakeReadRequests << ",\nNumber of Fake Write Requests: " << totalFakeWriteRequests);
 
-	if (finalStats && protection == DAG && VIS_FILE_OUTPUT) {
+	if (finalStats && config.protection == DAG && config.VIS_FILE_OUTPUT) {
                 csvOut.getOutputStream() << "Total Bytes Transferred: " << totalBytesTransferred << "\n";
                 csvOut.getOutputStream() << "Aggregate Average Bandwidth (GB/s): " << totalBandwidth << "\n";
 		for (int i = 0; i < dataIDArr.size(); i++) {
 			csvOut.getOutputStream() << "\nDefence Group: " << i << std::dec << ",\nFinal Defence Nodes Executed: " << totalNodes[i] << ",\nNumber of Fake Read Requests: " << totalFakeReadRequests[i] << ",\nNumber of Fake Write Requests: " << totalFakeWriteRequests[i];
 		}
-	} else if (finalStats && protection == FixedService_BTA && VIS_FILE_OUTPUT) {
+	} else if (finalStats && config.protection == FixedService_BTA && config.VIS_FILE_OUTPUT) {
           csvOut.getOutputStream() << "\n Fake FS requests: " << numFakeFS;
         }
 
@@ -1379,6 +1411,20 @@ void MemoryController::printStats(bool finalStats)
 
 	resetStats();
 }
+MemoryControllerStats MemoryController::getStats() const
+{
+	MemoryControllerStats stats;
+	stats.totalTransactions = totalTransactions;
+	stats.totalReads = totalReads;
+	stats.totalReadLatency = totalReadLatency;
+	stats.totalFakeRequests = numFakeFS;
+	for (size_t i=0; i<totalFakeReadRequests.size(); i++)
+	{
+		stats.totalFakeRequests += totalFakeReadRequests[i] + totalFakeWriteRequests[i];
+	}
+	return stats;
+}
+
 MemoryController::~MemoryController()
 {
 	//ERROR("MEMORY CONTROLLER DESTRUCTOR");
@@ -1391,12 +1437,412 @@ MemoryController::~MemoryController()
 	{
 		delete returnTransaction[i];
 	}
+	for (size_t i=0; i<spareTransactions.size(); i++)
+	{
+		delete spareTransactions[i];
+	}
 
 }
 //inserts a latency into the latency histogram
 void MemoryController::insertHistogram(unsigned latencyValue, unsigned rank, unsigned bank)
 {
 	totalEpochLatency[SEQUENTIAL(rank,bank)] += latencyValue;
+	totalReads++;
+	totalReadLatency += latencyValue;
 	//poor man's way to bin things.
 	latencies[(latencyValue/HISTOGRAM_BIN_SIZE)*HISTOGRAM_BIN_SIZE]++;
 }
+
+void MemoryController::serialize(CheckpointOut &cp) const
+{
+	cp.put(currentClockCycle);
+	cp.put(nextFRClockCycle);
+	for (size_t i=0; i<config.NUM_RANKS; i++)
+	{
+		bankStates[i].serialize(cp);
+	}
+	commandQueue.serialize(cp);
+
+	cp.putTransactions(transactionQueue);
+	cp.putTransactions(defenceQueue);
+	cp.putTransactions(pendingReadTransactions);
+	cp.putTransactions(returnTransaction);
+	cp.putBusPackets(writeDataToSend);
+	cp.put(writeDataCountdown);
+	cp.putBusPacket(outgoingCmdPacket);
+	cp.put(cmdCyclesLeft);
+	cp.putBusPacket(outgoingDataPacket);
+	cp.put(dataCyclesLeft);
+	cp.put(refreshCountdown);
+	cp.put(refreshRank);
+	cp.put(powerDown);
+
+	//stats
+	cp.put(latencies);
+	cp.put(totalTransactions);
+	cp.put(totalReads);
+	cp.put(totalReadLatency);
+	cp.put(grandTotalBankAccesses);
+	cp.put(totalReadsPerBank);
+	cp.put(totalWritesPerBank);
+	cp.put(totalReadsPerRank);
+	cp.put(totalWritesPerRank);
+	cp.put(totalEpochLatency);
+	cp.put(backgroundEnergy);
+	cp.put(burstEnergy);
+	cp.put(actpreEnergy);
+	cp.put(refreshEnergy);
+	cp.put(backgroundSince);
+	cp.put(backgroundCycles);
+
+	// the defence state is kept as one blob so that a restore under a
+	// different protection mode can skip over it
+	ostringstream defenceState;
+	CheckpointOut defenceCp(defenceState);
+	serializeDefence(defenceCp);
+	cp.put(defenceState.str());
+}
+
+void MemoryController::unserialize(CheckpointIn &cp, bool restoreDefence)
+{
+	cp.get(currentClockCycle);
+	cp.get(nextFRClockCycle);
+	for (size_t i=0; i<config.NUM_RANKS; i++)
+	{
+		bankStates[i].unserialize(cp);
+	}
+	commandQueue.unserialize(cp);
+
+	cp.getTransactions(transactionQueue);
+	clearTransactionIndex();
+	cp.getTransactions(defenceQueue);
+	for (size_t i=0; i<defenceByBank.size(); i++)
+	{
+		for (size_t j=0; j<defenceByBank[i].size(); j++)
+		{
+			defenceByBank[i][j].clear();
+		}
+	}
+	for (size_t i=0; i<defenceQueue.size(); i++)
+	{
+		indexDefenceTransaction(defenceQueue[i]);
+	}
+	cp.getTransactions(pendingReadTransactions);
+	cp.getTransactions(returnTransaction);
+	cp.getBusPackets(writeDataToSend, dramsim_log);
+	cp.get(writeDataCountdown);
+	outgoingCmdPacket = cp.getBusPacket(dramsim_log);
+	cp.get(cmdCyclesLeft);
+	outgoingDataPacket = cp.getBusPacket(dramsim_log);
+	cp.get(dataCyclesLeft);
+	cp.get(refreshCountdown);
+	cp.get(refreshRank);
+	cp.get(powerDown);
+	poppedBusPacket = NULL;
+
+	//stats
+	cp.get(latencies);
+	cp.get(totalTransactions);
+	cp.get(totalReads);
+	cp.get(totalReadLatency);
+	cp.get(grandTotalBankAccesses);
+	cp.get(totalReadsPerBank);
+	cp.get(totalWritesPerBank);
+	cp.get(totalReadsPerRank);
+	cp.get(totalWritesPerRank);
+	cp.get(totalEpochLatency);
+	cp.get(backgroundEnergy);
+	cp.get(burstEnergy);
+	cp.get(actpreEnergy);
+	cp.get(refreshEnergy);
+	cp.get(backgroundSince);
+	cp.get(backgroundCycles);
+	//the background state follows from the bank states just restored
+	for (size_t i=0; i<config.NUM_RANKS; i++)
+	{
+		backgroundState[i] = rankBackgroundState(i);
+		seenBackgroundChanges[i] = bankStates[i].stateChanges;
+	}
+
+	string defenceState;
+	cp.get(defenceState);
+	if (restoreDefence)
+	{
+		istringstream defenceIn(defenceState);
+		CheckpointIn defenceCp(defenceIn);
+		unserializeDefence(defenceCp);
+	}
+	else
+	{
+		// nothing will drain the defence queue any more, so those requests
+		// are scheduled like everybody else's
+		transactionQueue.insert(transactionQueue.end(), defenceQueue.begin(), defenceQueue.end());
+		defenceQueue.clear();
+		for (size_t i=0; i<defenceByBank.size(); i++)
+		{
+			for (size_t j=0; j<defenceByBank[i].size(); j++)
+			{
+				defenceByBank[i][j].clear();
+			}
+		}
+	}
+}
+
+void MemoryController::serializeDefence(CheckpointOut &cp) const
+{
+	vector<string> dagImages;
+	for (size_t d=0; d<dags.size(); d++)
+	{
+		dagImages.push_back(dags[d]->image());
+	}
+	cp.put(dagImages);
+	//the rest of defenceLoops is rebuilt from the DAGs
+	vector<vector<vector<uint64_t>>> finishTimes(defenceLoops.size());
+	vector<vector<bool>> loopsBack(defenceLoops.size());
+	for (size_t d=0; d<defenceLoops.size(); d++)
+	{
+		for (size_t l=0; l<defenceLoops[d].size(); l++)
+		{
+			finishTimes[d].push_back(defenceLoops[d][l].finishTimes);
+			loopsBack[d].push_back(defenceLoops[d][l].loopsBack);
+		}
+	}
+	cp.put(finishTimes);
+	cp.put(loopsBack);
+	cp.put(scheduleDomain);
+	cp.put(scheduleNode);
+	cp.put(dataIDArr);
+	cp.put(instIDArr);
+	cp.put(revData);
+	cp.put(revInst);
+	cp.put(oldDataIDArr);
+	cp.put(oldInstIDArr);
+	cp.put(revOldData);
+	cp.put(revOldInst);
+	cp.put(numLoops);
+	cp.put(currentLoop);
+	cp.put(currentLoopIteration);
+	cp.put(totalFakeReadRequests);
+	cp.put(totalFakeWriteRequests);
+	cp.put(totalNodes);
+	cp.put(numFakeFS);
+	cp.put(currentDomain);
+	cp.put(BTAPhase);
+	cp.put(commandQueue.iDefenceDomain);
+	cp.put(commandQueue.dDefenceDomain);
+}
+
+void MemoryController::unserializeDefence(CheckpointIn &cp)
+{
+	vector<string> dagImages;
+	cp.get(dagImages);
+	dags.clear();
+	for (size_t d=0; d<dagImages.size(); d++)
+	{
+		dags.push_back(dagCache->intern(dagImages[d]));
+	}
+	vector<vector<vector<uint64_t>>> finishTimes;
+	vector<vector<bool>> loopsBack;
+	cp.get(finishTimes);
+	cp.get(loopsBack);
+	defenceLoops.clear();
+	for (size_t d=0; d<dags.size() && d<finishTimes.size(); d++)
+	{
+		buildDefenceLoops(d);
+		for (size_t l=0; l<defenceLoops[d].size() && l<finishTimes[d].size(); l++)
+		{
+			defenceLoops[d][l].finishTimes = finishTimes[d][l];
+			defenceLoops[d][l].loopsBack = loopsBack[d][l];
+		}
+	}
+	cp.get(scheduleDomain);
+	cp.get(scheduleNode);
+	cp.get(dataIDArr);
+	cp.get(instIDArr);
+	cp.get(revData);
+	cp.get(revInst);
+	cp.get(oldDataIDArr);
+	cp.get(oldInstIDArr);
+	cp.get(revOldData);
+	cp.get(revOldInst);
+	rebuildDomainGroups();
+	cp.get(numLoops);
+	cp.get(currentLoop);
+	cp.get(currentLoopIteration);
+	cp.get(totalFakeReadRequests);
+	cp.get(totalFakeWriteRequests);
+	cp.get(totalNodes);
+	cp.get(numFakeFS);
+	cp.get(currentDomain);
+	cp.get(BTAPhase);
+	cp.get(commandQueue.iDefenceDomain);
+	cp.get(commandQueue.dDefenceDomain);
+}
+
+// nothing queued or in flight anywhere between here and the ranks, and no
+// bank in the middle of a precharge or refresh
+bool MemoryController::isIdle() const
+{
+	if (!transactionQueue.empty() || !defenceQueue.empty() ||
+			!pendingReadTransactions.empty() || !returnTransaction.empty() ||
+			!writeDataToSend.empty() || outgoingCmdPacket != NULL ||
+			outgoingDataPacket != NULL || !commandQueue.isIdle())
+	{
+		return false;
+	}
+	for (size_t i=0; i<config.NUM_RANKS; i++)
+	{
+		if (!(*ranks)[i]->isIdle())
+		{
+			return false;
+		}
+		if (bankStates[i].isCountingDown())
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// jumps an idle controller (and its ranks) ahead; every timing constraint is
+// an absolute cycle, so anything pending just expires. The refresh
+// countdowns are left to loadFunctionalState()
+void MemoryController::skipCycles(uint64_t cycles)
+{
+	currentClockCycle += cycles;
+	commandQueue.currentClockCycle += cycles;
+	while (nextFRClockCycle < currentClockCycle)
+	{
+		nextFRClockCycle += config.FIXED_SERVICE_RATE;
+		commandQueue.nextFRClockCycle += config.FIXED_SERVICE_RATE;
+	}
+	for (size_t i=0; i<config.NUM_RANKS; i++)
+	{
+		(*ranks)[i]->currentClockCycle += cycles;
+	}
+}
+
+// how many of the coming cycles update() would spend only counting the
+// refresh countdowns down; 0 unless the controller is idle and every rank
+// has settled into its background state. The defences issue requests of
+// their own, so only unprotected controllers ever settle
+uint64_t MemoryController::quiescentCycles() const
+{
+	if (config.protection != Regular || config.DEBUG_TRANS_Q || config.DEBUG_BANKSTATE || config.DEBUG_CMD_Q || !isIdle())
+	{
+		return 0;
+	}
+	for (size_t i=0; i<config.NUM_RANKS; i++)
+	{
+		//the command queue closes an open row nothing is waiting for, and
+		//update() powers a rank with every bank idle down
+		if (bankStates[i].any(RowActive) || (config.USE_LOW_POWER && !powerDown[i] && bankStates[i].all(Idle)))
+		{
+			return 0;
+		}
+	}
+
+	//a powered down rank is woken up tXP ahead of its refresh
+	unsigned refreshAt = powerDown[refreshRank] ? config.tXP : 0;
+	if (refreshCountdown[refreshRank] <= refreshAt)
+	{
+		return 0;
+	}
+	return refreshCountdown[refreshRank] - refreshAt;
+}
+
+// skipCycles() for at most quiescentCycles() cycles, which keeps the refresh
+// countdowns going as well
+void MemoryController::skipQuiescentCycles(uint64_t cycles)
+{
+	skipCycles(cycles);
+	for (size_t i=0; i<config.NUM_RANKS; i++)
+	{
+		refreshCountdown[i] -= cycles;
+	}
+}
+
+void MemoryController::saveFunctionalState(FunctionalState &state) const
+{
+	state.openRows = vector< vector<int> >(config.NUM_RANKS, vector<int>(config.NUM_BANKS, -1));
+	for (size_t i=0; i<config.NUM_RANKS; i++)
+	{
+		for (size_t j=0; j<config.NUM_BANKS; j++)
+		{
+			if (bankStates[i].currentBankState[j] == RowActive)
+			{
+				state.openRows[i][j] = bankStates[i].openRowAddress[j];
+			}
+		}
+	}
+	state.refreshCountdown = refreshCountdown;
+	state.refreshRank = refreshRank;
+}
+
+// hands the open rows found by the functional model to an idle controller;
+// both our bank states and the ranks' have to agree on them
+void MemoryController::loadFunctionalState(const FunctionalState &state)
+{
+	refreshCountdown = state.refreshCountdown;
+	refreshRank = state.refreshRank;
+
+	for (size_t i=0; i<config.NUM_RANKS; i++)
+	{
+		Rank *rank = (*ranks)[i];
+		bool anyOpen = false;
+		for (size_t j=0; j<config.NUM_BANKS; j++)
+		{
+			anyOpen = anyOpen || state.openRows[i][j] != -1;
+		}
+
+		if (powerDown[i])
+		{
+			//a powered down rank can only stay that way with every row closed
+			if (!anyOpen || currentClockCycle < bankStates[i].nextPowerUp[0])
+			{
+				continue;
+			}
+			powerDown[i] = false;
+			rank->powerUp();
+			for (size_t j=0; j<config.NUM_BANKS; j++)
+			{
+				bankStates[i].currentBankState[j] = Idle;
+				bankStates[i].nextActivate[j] = currentClockCycle + config.tXP;
+			}
+		}
+
+		for (size_t j=0; j<config.NUM_BANKS; j++)
+		{
+			BankStates &bankState = bankStates[i];
+			if (state.openRows[i][j] == -1)
+			{
+				if (bankState.currentBankState[j] == RowActive)
+				{
+					bankState.currentBankState[j] = Idle;
+					if (!config.FAST_RANK)
+					{
+						rank->bankStates.currentBankState[j] = Idle;
+					}
+				}
+			}
+			else
+			{
+				bankState.currentBankState[j] = RowActive;
+				bankState.openRowAddress[j] = state.openRows[i][j];
+				bankState.lastCommand[j] = ACTIVATE;
+				if (!config.FAST_RANK)
+				{
+					rank->bankStates.currentBankState[j] = RowActive;
+					rank->bankStates.openRowAddress[j] = state.openRows[i][j];
+				}
+			}
+		}
+	}
+
+	//the command queue has to look at the new bank states again
+	commandQueue.resetReadiness();
+	for (size_t i=0; i<config.NUM_RANKS; i++)
+	{
+		updateBackgroundState(i);
+	}
+}
@@ -45,25 +45,48 @@
 #include "BankState.h"
 #include "Rank.h"
 #include "CSVWriter.h"
+#include "Checkpoint.h"
+#include "FunctionalModel.h"
+#include "DefenceDag.h"
+#include "CommandTrace.h"
 #include <map>
 #include <set>
+#include <deque>
 #include <stdlib.h>
 
-#include "json.hpp"
-
 
 using namespace std;
-using json = nlohmann::json;
 
 namespace DRAMSim
 {
 class MemorySystem;
+
+// running totals since the start of the simulation; unlike the per-epoch
+// counters these are not cleared by printStats()
+struct MemoryControllerStats
+{
+	uint64_t totalTransactions;
+	uint64_t totalReads; //demand reads returned to the CPU
+	uint64_t totalReadLatency; //summed over totalReads, in DRAM cycles
+	uint64_t totalFakeRequests; //DAG and FS-BTA padding
+};
+
+// the background current a rank draws, see the IDD2N/IDD2P/IDD3N entries of
+// the device ini
+enum BackgroundState
+{
+	PrechargeStandby, //IDD2N
+	PrechargePowerDown, //IDD2P
+	ActiveStandby, //IDD3N: a row is open or the rank is refreshing
+	NUM_BACKGROUND_STATES
+};
+
 class MemoryController : public SimulatorObject
 {
 
 public:
 	//functions
-	MemoryController(MemorySystem* ms, CSVWriter &csvOut_, ostream &dramsim_log_);
+	MemoryController(MemorySystem* ms, const Config &config_, CSVWriter &csvOut_, ostream &dramsim_log_);
 	virtual ~MemoryController();
 
 	bool addTransaction(Transaction *trans);
@@ -75,7 +98,20 @@ public:
 	void update();
 	void printStats(bool finalStats = false);
 	void resetStats(); 
+	MemoryControllerStats getStats() const;
+	void serialize(CheckpointOut &cp) const;
+	void unserialize(CheckpointIn &cp, bool restoreDefence);
+	bool isIdle() const;
+	void skipCycles(uint64_t cycles);
+	uint64_t quiescentCycles() const;
+	void skipQuiescentCycles(uint64_t cycles);
+	void saveFunctionalState(FunctionalState &state) const;
+	void loadFunctionalState(const FunctionalState &state);
+	void accountBackgroundEnergy();
+	const vector< vector<uint64_t> > &getBackgroundCycles() const { return backgroundCycles; }
+	const BankStates &getBankStates(unsigned rank) const { return bankStates[rank]; }
 	void initDefence(int domainID);
+	void buildDefenceLoops(int domainID);
 	void stopDefence();
 
 	void initCQDefence(uint64_t iDomain, uint64_t dDomain) {
@@ -83,10 +119,14 @@ public:
 		commandQueue.dDefenceDomain = dDomain;
 	}
 
-	vector<vector<map<int,vector<int>>>> parentList;
-	vector<vector<map<int,vector<int>>>> childrenList;
-	vector<vector<map<int,map<int, int>>>> weightList; //[parent][child]
-	vector<vector<map<int,uint64_t>>> finishTimes;
+	// where a domain is in one loop of its (shared) DAG
+	struct DefenceLoop
+	{
+		const DagLoop *dag;
+		vector<uint64_t> finishTimes; //this iteration, max until the node is done
+		bool loopsBack; //the last node has no children, so node 0 follows it once it repeats
+	};
+	vector<vector<DefenceLoop>> defenceLoops; //[domain][loop]
 
 	map<uint64_t, int> scheduleDomain;
 	map<uint64_t, int> scheduleNode;
@@ -102,6 +142,19 @@ public:
 
 	map<int,int> revOldData;
 	map<int,int> revOldInst;
+
+	// everything the defences need to know about a hardware domain ID,
+	// rebuilt from the arrays and maps above by rebuildDomainGroups()
+	struct DomainGroup
+	{
+		int group; //protection group (revData, revInst, revOldData, revOldInst in that order), -1 if none
+		bool defended; //in revData or revInst: its requests go to the defence queue
+		uint64_t slots; //bit g: one of group g's current or last old IDs (DAG slots)
+		uint64_t secure; //bit g: one of group g's current IDs (FS-BTA)
+	};
+	vector<DomainGroup> domainGroups; //[domain ID]
+	void rebuildDomainGroups();
+	const DomainGroup &domainGroup(uint64_t securityDomain) const;
 	
 	vector<int> numLoops;
 
@@ -119,12 +172,38 @@ public:
 	vector<Transaction *> transactionQueue;
 	vector<Transaction *> defenceQueue;
 
-	vector<json> dag;
+	vector<const DefenceDag *> dags; //[domain], owned by dagCache
+	DefenceDagCache *dagCache;
+	CommandTraceWriter *commandTrace; //NULL unless COMMAND_TRACE is set
 private:
+	const Config &config;
 	ostream &dramsim_log;
-	vector< vector <BankState> > bankStates;
+	vector<BankStates> bankStates;
 	//functions
 	void insertHistogram(unsigned latencyValue, unsigned rank, unsigned bank);
+	void serializeDefence(CheckpointOut &cp) const;
+	void unserializeDefence(CheckpointIn &cp);
+
+	//one specialised scheduler per protection and page policy
+	typedef void (MemoryController::*ScheduleFunction)();
+	static ScheduleFunction selectSchedule(const Config &config);
+	template <Protection P>
+	static ScheduleFunction selectSchedule(RowBufferPolicy rowBufferPolicy);
+	template <Protection P, RowBufferPolicy R>
+	void scheduleTransactions();
+	template <Protection P, RowBufferPolicy R>
+	bool issueTransaction(size_t index, unsigned rank, unsigned bank, unsigned row, unsigned column);
+	void indexTransactions();
+	void clearTransactionIndex();
+	void enqueueScheduledNode();
+	Transaction *newTransaction(TransactionType transType, uint64_t addr, void *data, uint64_t securityDomain, int nodeID, bool isFake, int fakeBank);
+	void recycleTransaction(Transaction *trans);
+	void releaseTransaction(Transaction *trans);
+	void indexDefenceTransaction(Transaction *trans);
+	Transaction *takeDefenceTransaction(TransactionType type, int bank, int group);
+	BackgroundState rankBackgroundState(unsigned rank) const;
+	void updateBackgroundState(unsigned rank);
+	void accountBackgroundEnergy(unsigned rank);
 
 	//fields
 	MemorySystem *parentMemorySystem;
@@ -135,6 +214,8 @@ private:
 	vector<unsigned> writeDataCountdown;
 	vector<Transaction *> returnTransaction;
 	vector<Transaction *> pendingReadTransactions;
+	vector<Transaction *> spareTransactions; //see newTransaction()
+	vector< vector< deque<Transaction *> > > defenceByBank; //defenceQueue again, [write?][bank] in arrival order
 	map<unsigned,unsigned> latencies; // latencyValue -> latencyCount
 	vector<bool> powerDown;
 
@@ -153,6 +234,8 @@ private:
 	unsigned dataCyclesLeft;
 
 	uint64_t totalTransactions;
+	uint64_t totalReads;
+	uint64_t totalReadLatency;
 	uint64_t currentDomain;
 	uint64_t BTAPhase;
 
@@ -175,9 +258,32 @@ private:
 
 
 	unsigned refreshRank;
+	ScheduleFunction scheduleFunction;
+
+	//the transactionQueue entries again, split by the bank they go to (in
+	//arrival order) for the schedulers that take the oldest transaction
+	//whose bank has room in the command queue
+	struct QueuedTransaction
+	{
+		Transaction *transaction;
+		uint64_t arrival;
+		unsigned rank, bank, row, column;
+	};
+	vector< deque<QueuedTransaction> > bankTransactions; //rank*NUM_BANKS+bank
+	set< pair<uint64_t, unsigned> > bankHeads; //arrival of the oldest transaction of each bank that has one
+	size_t indexedTransactions; //the first indexedTransactions entries of transactionQueue are in bankTransactions
+	uint64_t transactionArrivals;
+
+	//background energy is only added up when a rank changes state; until
+	//then backgroundEnergy lags behind by the cycles since backgroundSince
+	vector<BackgroundState> backgroundState;
+	vector<uint64_t> backgroundSince;
+	vector<unsigned> seenBackgroundChanges; //bankStates[rank].stateChanges when last looked at
+	vector< vector<uint64_t> > backgroundCycles; //[rank][BackgroundState], this epoch
 	
 public:
 	// energy values are per rank -- SST uses these directly, so make these public 
+	// (call accountBackgroundEnergy() before reading backgroundEnergy)
 	vector< uint64_t > backgroundEnergy;
 	vector< uint64_t > burstEnergy;
 	vector< uint64_t > actpreEnergy;
@@ -43,101 +43,36 @@
 using namespace std;
 
 
-ofstream cmd_verify_out; //used in Rank.cpp and MemoryController.cpp if VERIFICATION_OUTPUT is set
-
-unsigned NUM_DEVICES;
-unsigned NUM_RANKS;
-unsigned NUM_RANKS_LOG;
-
 namespace DRAMSim {
 
 powerCallBack_t MemorySystem::ReportPower = NULL;
 
-MemorySystem::MemorySystem(unsigned id, unsigned int megsOfMemory, CSVWriter &csvOut_, ostream &dramsim_log_) :
+MemorySystem::MemorySystem(unsigned id, const Config &config_, CSVWriter &csvOut_, ostream &dramsim_log_, ostream &cmd_verify_out_) :
 		dramsim_log(dramsim_log_),
+		config(config_),
 		ReturnReadData(NULL),
 		WriteDataDone(NULL),
 		systemID(id),
+		fastTiming(false),
+		fastTimingModel(config_),
+		fastTimingStart(0),
 		csvOut(csvOut_)
 {
 	currentClockCycle = 0;
 
 	DEBUG("===== MemorySystem "<<systemID<<" =====");
 
+	DEBUG("CH. " <<systemID<<" TOTAL_STORAGE : "<< config.TOTAL_STORAGE << "MB | "<<config.NUM_RANKS<<" Ranks | "<< config.NUM_DEVICES <<" Devices per rank");
 
-	//calculate the total storage based on the devices the user selected and the number of
-
-	//calculate number of devices
-	/************************
-	  This code has always been problematic even though it's pretty simple. I'll try to explain it 
-	  for my own sanity. 
-
-	  There are two main variables here that we could let the user choose:
-	  NUM_RANKS or TOTAL_STORAGE.  Since the density and width of the part is
-	  fixed by the device ini file, the only variable that is really
-	  controllable is the number of ranks. Users care more about choosing the
-	  total amount of storage, but with a fixed device they might choose a total
-	  storage that isn't possible. In that sense it's not as good to allow them
-	  to choose TOTAL_STORAGE (because any NUM_RANKS value >1 will be valid).
-
-	  However, users don't care (or know) about ranks, they care about total
-	  storage, so maybe it's better to let them choose and just throw an error
-	  if they choose something invalid. 
-
-	  A bit of background: 
 
-	  Each column contains DEVICE_WIDTH bits. A row contains NUM_COLS columns.
-	  Each bank contains NUM_ROWS rows. Therefore, the total storage per DRAM device is: 
-	  		PER_DEVICE_STORAGE = NUM_ROWS*NUM_COLS*DEVICE_WIDTH*NUM_BANKS (in bits)
-
-	 A rank *must* have a 64 bit output bus (JEDEC standard), so each rank must have:
-	  		NUM_DEVICES_PER_RANK = 64/DEVICE_WIDTH  
-			(note: if you have multiple channels ganged together, the bus width is 
-			effectively NUM_CHANS * 64/DEVICE_WIDTH)
-	 
-	If we multiply these two numbers to get the storage per rank (in bits), we get:
-			PER_RANK_STORAGE = PER_DEVICE_STORAGE*NUM_DEVICES_PER_RANK = NUM_ROWS*NUM_COLS*NUM_BANKS*64 
-
-	Finally, to get TOTAL_STORAGE, we need to multiply by NUM_RANKS
-			TOTAL_STORAGE = PER_RANK_STORAGE*NUM_RANKS (total storage in bits)
-
-	So one could compute this in reverse -- compute NUM_DEVICES,
-	PER_DEVICE_STORAGE, and PER_RANK_STORAGE first since all these parameters
-	are set by the device ini. Then, TOTAL_STORAGE/PER_RANK_STORAGE = NUM_RANKS 
-
-	The only way this could run into problems is if TOTAL_STORAGE < PER_RANK_STORAGE,
-	which could happen for very dense parts.
-	*********************/
-
-	// number of bytes per rank
-	unsigned long megsOfStoragePerRank = ((((long long)NUM_ROWS * (NUM_COLS * DEVICE_WIDTH) * NUM_BANKS) * ((long long)JEDEC_DATA_BUS_BITS / DEVICE_WIDTH)) / 8) >> 20;
-
-	// If this is set, effectively override the number of ranks
-	if (megsOfMemory != 0)
-	{
-		NUM_RANKS = megsOfMemory / megsOfStoragePerRank;
-		NUM_RANKS_LOG = dramsim_log2(NUM_RANKS);
-		if (NUM_RANKS == 0)
-		{
-			PRINT("WARNING: Cannot create memory system with "<<megsOfMemory<<"MB, defaulting to minimum size of "<<megsOfStoragePerRank<<"MB");
-			NUM_RANKS=1;
-		}
-	}
-
-	NUM_DEVICES = JEDEC_DATA_BUS_BITS/DEVICE_WIDTH;
-	TOTAL_STORAGE = (NUM_RANKS * megsOfStoragePerRank); 
-
-	DEBUG("CH. " <<systemID<<" TOTAL_STORAGE : "<< TOTAL_STORAGE << "MB | "<<NUM_RANKS<<" Ranks | "<< NUM_DEVICES <<" Devices per rank");
-
-
-	memoryController = new MemoryController(this, csvOut, dramsim_log);
+	memoryController = new MemoryController(this, config, csvOut, dramsim_log);
 
 	// TODO: change to other vector constructor?
 	ranks = new vector<Rank *>();
 
-	for (size_t i=0; i<NUM_RANKS; i++)
+	for (size_t i=0; i<config.NUM_RANKS; i++)
 	{
-		Rank *r = new Rank(dramsim_log);
+		Rank *r = new Rank(config, dramsim_log, cmd_verify_out_);
 		r->setId(i);
 		r->attachMemoryController(memoryController);
 		ranks->push_back(r);
@@ -157,22 +92,20 @@ MemorySystem::~MemorySystem()
 
 	delete(memoryController);
 
-	for (size_t i=0; i<NUM_RANKS; i++)
+	for (size_t i=0; i<config.NUM_RANKS; i++)
 	{
 		delete (*ranks)[i];
 	}
 	ranks->clear();
 	delete(ranks);
-
-	if (VERIFICATION_OUTPUT)
-	{
-		cmd_verify_out.flush();
-		cmd_verify_out.close();
-	}
 }
 
 bool MemorySystem::WillAcceptTransaction()
 {
+	if (fastTiming)
+	{
+		return fastCompletions.size() < config.TRANS_QUEUE_DEPTH;
+	}
 	return memoryController->WillAcceptTransaction();
 }
 
@@ -183,9 +116,9 @@ bool MemorySystem::addTransaction(bool isWrite, uint64_t addr, uint64_t security
 	// push_back in memoryController will make a copy of this during
 	// addTransaction so it's kosher for the reference to be local 
 
-	if (memoryController->WillAcceptTransaction()) 
+	if (WillAcceptTransaction()) 
 	{
-		return memoryController->addTransaction(trans);
+		return addTransaction(trans);
 	}
 	else
 	{
@@ -196,6 +129,17 @@ bool MemorySystem::addTransaction(bool isWrite, uint64_t addr, uint64_t security
 
 bool MemorySystem::addTransaction(Transaction *trans)
 {
+	if (fastTiming)
+	{
+		if (!WillAcceptTransaction())
+		{
+			return false;
+		}
+		bool isWrite = trans->transactionType == DATA_WRITE;
+		uint64_t done = fastTimingModel.access(isWrite, trans->address, currentClockCycle);
+		fastCompletions.push(FastCompletion(done, trans));
+		return true;
+	}
 	return memoryController->addTransaction(trans);
 }
 
@@ -203,6 +147,73 @@ bool MemorySystem::addTransaction(Transaction *trans)
 void MemorySystem::printStats(bool finalStats)
 {
 	memoryController->printStats(finalStats);
+	if (finalStats && fastTimingModel.totalReads + fastTimingModel.totalWrites > 0)
+	{
+		double averageLatency = 0.0;
+		if (fastTimingModel.totalReads > 0)
+		{
+			averageLatency = (double)fastTimingModel.totalReadLatency / fastTimingModel.totalReads * config.tCK;
+		}
+		PRINT("   Fast timing : "<<fastTimingModel.totalReads<<" reads ("<<averageLatency<<" ns average latency), "
+		      <<fastTimingModel.totalWrites<<" writes, "<<fastTimingModel.rowHits<<" row hits");
+	}
+}
+
+//hands back the requests the fastTimingModel has finished by now
+void MemorySystem::returnFastTiming()
+{
+	while (!fastCompletions.empty() && fastCompletions.top().first <= currentClockCycle)
+	{
+		Transaction *trans = fastCompletions.top().second;
+		fastCompletions.pop();
+		if (trans->transactionType == DATA_WRITE)
+		{
+			if (WriteDataDone != NULL)
+			{
+				(*WriteDataDone)(systemID, trans->address, currentClockCycle);
+			}
+		}
+		else if (ReturnReadData != NULL)
+		{
+			(*ReturnReadData)(systemID, trans->address, currentClockCycle);
+		}
+		delete trans;
+	}
+}
+
+/**
+ * Switches this channel between the detailed MemoryController and the
+ * FastTimingModel. The open rows and refresh positions go with the switch.
+ * Switching to fast timing needs the controller to be drained; requests the
+ * fast model still has in flight when switching back are returned at the
+ * cycle it gave them.
+ */
+bool MemorySystem::setFastTiming(bool enable)
+{
+	if (enable == fastTiming)
+	{
+		return true;
+	}
+	FunctionalState state;
+	if (enable)
+	{
+		if (!pendingTransactions.empty() || !memoryController->isIdle())
+		{
+			return false;
+		}
+		memoryController->saveFunctionalState(state);
+		fastTimingModel.load(state, currentClockCycle);
+		fastTimingStart = currentClockCycle;
+	}
+	else
+	{
+		// the controller and ranks haven't been ticked since the switch
+		memoryController->skipCycles(currentClockCycle - fastTimingStart);
+		fastTimingModel.save(state, currentClockCycle);
+		memoryController->loadFunctionalState(state);
+	}
+	fastTiming = enable;
+	return true;
 }
 
 
@@ -212,9 +223,24 @@ void MemorySystem::update()
 
 	//PRINT(" ----------------- Memory System Update ------------------");
 
+	if (!fastCompletions.empty())
+	{
+		returnFastTiming();
+	}
+	if (fastTiming)
+	{
+		if (pendingTransactions.size() > 0 && WillAcceptTransaction())
+		{
+			addTransaction(pendingTransactions.front());
+			pendingTransactions.pop_front();
+		}
+		this->step();
+		return;
+	}
+
 	//updates the state of each of the objects
 	// NOTE - do not change order
-	for (size_t i=0;i<NUM_RANKS;i++)
+	for (size_t i=0;i<config.NUM_RANKS;i++)
 	{
 		(*ranks)[i]->update();
 	}
@@ -228,7 +254,7 @@ void MemorySystem::update()
 	memoryController->update();
 
 	//simply increments the currentClockCycle field for each object
-	for (size_t i=0;i<NUM_RANKS;i++)
+	for (size_t i=0;i<config.NUM_RANKS;i++)
 	{
 		(*ranks)[i]->step();
 	}
@@ -238,6 +264,62 @@ void MemorySystem::update()
 	//PRINT("\n"); // two new lines
 }
 
+void MemorySystem::serialize(CheckpointOut &cp) const
+{
+	cp.put(currentClockCycle);
+	cp.putTransactions(pendingTransactions);
+	memoryController->serialize(cp);
+	for (size_t i=0; i<config.NUM_RANKS; i++)
+	{
+		(*ranks)[i]->serialize(cp);
+	}
+}
+
+void MemorySystem::unserialize(CheckpointIn &cp, bool restoreDefence)
+{
+	cp.get(currentClockCycle);
+	cp.getTransactions(pendingTransactions);
+	memoryController->unserialize(cp, restoreDefence);
+	for (size_t i=0; i<config.NUM_RANKS; i++)
+	{
+		(*ranks)[i]->unserialize(cp);
+	}
+}
+
+bool MemorySystem::isIdle() const
+{
+	return pendingTransactions.empty() && fastCompletions.empty() && memoryController->isIdle();
+}
+
+void MemorySystem::skipCycles(uint64_t cycles)
+{
+	currentClockCycle += cycles;
+	if (!fastTiming)
+	{
+		memoryController->skipCycles(cycles);
+	}
+}
+
+uint64_t MemorySystem::quiescentCycles() const
+{
+	if (fastTiming || !pendingTransactions.empty() || !fastCompletions.empty())
+	{
+		return 0;
+	}
+	return memoryController->quiescentCycles();
+}
+
+// brings a channel that has not been updated since it went quiescent up to
+// cycle; a channel that is up to date is left alone
+void MemorySystem::catchUp(uint64_t cycle)
+{
+	if (cycle > currentClockCycle)
+	{
+		memoryController->skipQuiescentCycles(cycle - currentClockCycle);
+		currentClockCycle = cycle;
+	}
+}
+
 void MemorySystem::RegisterCallbacks( Callback_t* readCB, Callback_t* writeCB,
                                       void (*reportPower)(double bgpower, double burstpower,
                                                           double refreshpower, double actprepower))
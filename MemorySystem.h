@@ -45,7 +45,9 @@
 #include "Transaction.h"
 #include "Callback.h"
 #include "CSVWriter.h"
+#include "FastTimingModel.h"
 #include <deque>
+#include <queue>
 
 namespace DRAMSim
 {
@@ -53,14 +55,22 @@ typedef CallbackBase<void,unsigned,uint64_t,uint64_t> Callback_t;
 class MemorySystem : public SimulatorObject
 {
 	ostream &dramsim_log;
+	const Config &config;
 public:
 	//functions
-	MemorySystem(unsigned id, unsigned megsOfMemory, CSVWriter &csvOut_, ostream &dramsim_log_);
+	MemorySystem(unsigned id, const Config &config_, CSVWriter &csvOut_, ostream &dramsim_log_, ostream &cmd_verify_out_);
 	virtual ~MemorySystem();
 	void update();
 	bool addTransaction(Transaction *trans);
 	bool addTransaction(bool isWrite, uint64_t addr, uint64_t securityDomain);
 	void printStats(bool finalStats);
+	void serialize(CheckpointOut &cp) const;
+	void unserialize(CheckpointIn &cp, bool restoreDefence);
+	bool isIdle() const;
+	void skipCycles(uint64_t cycles);
+	uint64_t quiescentCycles() const;
+	void catchUp(uint64_t cycle);
+	bool setFastTiming(bool enable);
 	bool WillAcceptTransaction();
 	void RegisterCallbacks(
 	    Callback_t *readDone,
@@ -79,8 +89,15 @@ public:
 	//TODO: make this a functor as well?
 	static powerCallBack_t ReportPower;
 	unsigned systemID;
+	bool fastTiming;
+	FastTimingModel fastTimingModel;
 
 private:
+	void returnFastTiming();
+	typedef pair<uint64_t, Transaction *> FastCompletion;
+	//requests handled by the fastTimingModel, soonest completion first
+	priority_queue<FastCompletion, vector<FastCompletion>, greater<FastCompletion> > fastCompletions;
+	uint64_t fastTimingStart;
 	CSVWriter &csvOut;
 };
 }
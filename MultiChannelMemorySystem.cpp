@@ -46,6 +46,7 @@ MultiChannelMemorySystem::MultiChannelMemorySystem(const string &deviceIniFilena
 	:megsOfMemory(megsOfMemory_), deviceIniFilename(deviceIniFilename_),
 	systemIniFilename(systemIniFilename_), traceFilename(traceFilename_), defenceFilename(defenceFilename_), defenceFilename2(defenceFilename2_),
 	pwd(pwd_), visFilename(visFilename_), 
+	config(), iniReader(config),
 	clockDomainCrosser(new ClockDomain::Callback<MultiChannelMemorySystem, void>(this, &MultiChannelMemorySystem::actual_update)),
 	csvOut(new CSVWriter(visDataOut))
 {
@@ -73,35 +74,121 @@ MultiChannelMemorySystem::MultiChannelMemorySystem(const string &deviceIniFilena
 	}
 
 	DEBUG("== Loading device model file '"<<deviceIniFilename<<"' == ");
-	IniReader::ReadIniFile(deviceIniFilename, false);
+	iniReader.ReadIniFile(deviceIniFilename, false);
 	DEBUG("== Loading system model file '"<<systemIniFilename<<"' == ");
-	IniReader::ReadIniFile(systemIniFilename, true);
+	iniReader.ReadIniFile(systemIniFilename, true);
 
 	// If we have any overrides, set them now before creating all of the memory objects
 	if (paramOverrides)
-		IniReader::OverrideKeys(paramOverrides);
+		iniReader.OverrideKeys(paramOverrides);
 
-	IniReader::InitEnumsFromStrings();
-	if (!IniReader::CheckIfAllSet())
+	iniReader.InitEnumsFromStrings();
+	if (!iniReader.CheckIfAllSet())
 	{
 		exit(-1);
 	}
+	config.deriveTiming();
 
-	if (NUM_CHANS == 0) 
+	if (config.NUM_CHANS == 0) 
 	{
 		ERROR("Zero channels"); 
 		abort(); 
 	}
-	for (size_t i=0; i<NUM_CHANS; i++)
+
+	//calculate the total storage based on the devices the user selected and the number of
+
+	//calculate number of devices
+	/************************
+	  This code has always been problematic even though it's pretty simple. I'll try to explain it 
+	  for my own sanity. 
+
+	  There are two main variables here that we could let the user choose:
+	  NUM_RANKS or TOTAL_STORAGE.  Since the density and width of the part is
+	  fixed by the device ini file, the only variable that is really
+	  controllable is the number of ranks. Users care more about choosing the
+	  total amount of storage, but with a fixed device they might choose a total
+	  storage that isn't possible. In that sense it's not as good to allow them
+	  to choose TOTAL_STORAGE (because any NUM_RANKS value >1 will be valid).
+
+	  However, users don't care (or know) about ranks, they care about total
+	  storage, so maybe it's better to let them choose and just throw an error
+	  if they choose something invalid. 
+
+	  A bit of background: 
+
+	  Each column contains DEVICE_WIDTH bits. A row contains NUM_COLS columns.
+	  Each bank contains NUM_ROWS rows. Therefore, the total storage per DRAM device is: 
+	  		PER_DEVICE_STORAGE = NUM_ROWS*NUM_COLS*DEVICE_WIDTH*NUM_BANKS (in bits)
+
+	 A rank *must* have a 64 bit output bus (JEDEC standard), so each rank must have:
+	  		NUM_DEVICES_PER_RANK = 64/DEVICE_WIDTH  
+			(note: if you have multiple channels ganged together, the bus width is 
+			effectively NUM_CHANS * 64/DEVICE_WIDTH)
+	 
+	If we multiply these two numbers to get the storage per rank (in bits), we get:
+			PER_RANK_STORAGE = PER_DEVICE_STORAGE*NUM_DEVICES_PER_RANK = NUM_ROWS*NUM_COLS*NUM_BANKS*64 
+
+	Finally, to get TOTAL_STORAGE, we need to multiply by NUM_RANKS
+			TOTAL_STORAGE = PER_RANK_STORAGE*NUM_RANKS (total storage in bits)
+
+	So one could compute this in reverse -- compute NUM_DEVICES,
+	PER_DEVICE_STORAGE, and PER_RANK_STORAGE first since all these parameters
+	are set by the device ini. Then, TOTAL_STORAGE/PER_RANK_STORAGE = NUM_RANKS 
+
+	The only way this could run into problems is if TOTAL_STORAGE < PER_RANK_STORAGE,
+	which could happen for very dense parts.
+	*********************/
+
+	unsigned megsOfMemoryPerChannel = megsOfMemory / config.NUM_CHANS;
+
+	// number of bytes per rank
+	unsigned long megsOfStoragePerRank = ((((long long)config.NUM_ROWS * (config.NUM_COLS * config.DEVICE_WIDTH) * config.NUM_BANKS) * ((long long)config.JEDEC_DATA_BUS_BITS / config.DEVICE_WIDTH)) / 8) >> 20;
+
+	// If this is set, effectively override the number of ranks
+	if (megsOfMemoryPerChannel != 0)
+	{
+		config.NUM_RANKS = megsOfMemoryPerChannel / megsOfStoragePerRank;
+		config.NUM_RANKS_LOG = dramsim_log2(config.NUM_RANKS);
+		if (config.NUM_RANKS == 0)
+		{
+			PRINT("WARNING: Cannot create memory system with "<<megsOfMemoryPerChannel<<"MB, defaulting to minimum size of "<<megsOfStoragePerRank<<"MB");
+			config.NUM_RANKS=1;
+		}
+	}
+
+	config.NUM_DEVICES = config.JEDEC_DATA_BUS_BITS/config.DEVICE_WIDTH;
+	config.TOTAL_STORAGE = (config.NUM_RANKS * megsOfStoragePerRank); 
+
+
+	// from here on the configuration is read-only; every channel shares it
+	for (size_t i=0; i<config.NUM_CHANS; i++)
 	{
-		MemorySystem *channel = new MemorySystem(i, megsOfMemory/NUM_CHANS, (*csvOut), dramsim_log);
+		MemorySystem *channel = new MemorySystem(i, config, (*csvOut), dramsim_log, cmd_verify_out);
 		channels.push_back(channel);
+		activeChannels.push_back(i);
 	}
+	channelAsleep = vector<bool>(config.NUM_CHANS, false);
+	channelWakeCycle = vector<uint64_t>(config.NUM_CHANS, 0);
+	channelSelect = DRAMSim::channelSelect(config);
 
         for (int i = 0; i < 4; i++) {
             channels[0]->memoryController->oldDataIDArr.push_back(-1);
             channels[0]->memoryController->oldInstIDArr.push_back(-1);
         }
+
+	// Read in the defence DAGs up front, one per cpuid; a file named twice
+	// is only loaded once
+	channels[0]->memoryController->dagCache = &dagCache;
+	if (config.protection == DAG)
+	{
+		std::istringstream ss(defenceFilename);
+		std::string token;
+		while (std::getline(ss, token, ';'))
+		{
+			defenceDagFiles.push_back(token);
+			defenceDags.push_back(dagCache.load(token));
+		}
+	}
 }
 /* Initialize the ClockDomainCrosser to use the CPU speed 
 	If cpuClkFreqHz == 0, then assume a 1:1 ratio (like for TraceBasedSim)
@@ -109,7 +196,7 @@ MultiChannelMemorySystem::MultiChannelMemorySystem(const string &deviceIniFilena
 void MultiChannelMemorySystem::setCPUClockSpeed(uint64_t cpuClkFreqHz)
 {
 
-	uint64_t dramsimClkFreqHz = (uint64_t)(1.0/(tCK*1e-9));
+	uint64_t dramsimClkFreqHz = (uint64_t)(1.0/(config.tCK*1e-9));
 	clockDomainCrosser.clock1 = dramsimClkFreqHz; 
 	clockDomainCrosser.clock2 = (cpuClkFreqHz == 0) ? dramsimClkFreqHz : cpuClkFreqHz; 
 }
@@ -184,7 +271,7 @@ void MultiChannelMemorySystem::InitOutputFiles(string traceFilename)
 
 	// create a properly named verification output file if need be and open it
 	// as the stream 'cmd_verify_out'
-	if (VERIFICATION_OUTPUT)
+	if (config.VERIFICATION_OUTPUT)
 	{
 		string basefilename = deviceIniFilename.substr(deviceIniFilename.find_last_of("/")+1);
 		string verify_filename =  "sim_out_"+basefilename;
@@ -199,10 +286,25 @@ void MultiChannelMemorySystem::InitOutputFiles(string traceFilename)
 			ERROR("Cannot open "<< verify_filename);
 			abort(); 
 		}
+		verifyBuffer.attach(cmd_verify_out);
+	}
+	if (config.COMMAND_TRACE)
+	{
+		string basefilename = deviceIniFilename.substr(deviceIniFilename.find_last_of("/")+1);
+		string trace_filename = "sim_out_"+basefilename;
+		if (sim_description != NULL)
+		{
+			trace_filename += "."+sim_description_str;
+		}
+		commandTrace.open(trace_filename + ".ctrace");
+		for (size_t i=0; i<config.NUM_CHANS; i++)
+		{
+			channels[i]->memoryController->commandTrace = &commandTrace;
+		}
 	}
 	// This sets up the vis file output along with the creating the result
 	// directory structure if it doesn't exist
-	if (VIS_FILE_OUTPUT)
+	if (config.VIS_FILE_OUTPUT)
 	{
 		stringstream out,tmpNum;
 		string path;
@@ -250,17 +352,17 @@ void MultiChannelMemorySystem::InitOutputFiles(string traceFilename)
 			// finally, figure out the filename
 			string sched = "BtR";
 			string queue = "pRank";
-			if (schedulingPolicy == RankThenBankRoundRobin)
+			if (config.schedulingPolicy == RankThenBankRoundRobin)
 			{
 				sched = "RtB";
 			}
-			if (queuingStructure == PerRankPerBank)
+			if (config.queuingStructure == PerRankPerBank)
 			{
 				queue = "pRankpBank";
 			}
 
 			/* I really don't see how "the C++ way" is better than snprintf()  */
-			out << (TOTAL_STORAGE>>10) << "GB." << NUM_CHANS << "Ch." << NUM_RANKS <<"R." <<ADDRESS_MAPPING_SCHEME<<"."<<ROW_BUFFER_POLICY<<"."<< TRANS_QUEUE_DEPTH<<"TQ."<<CMD_QUEUE_DEPTH<<"CQ."<<sched<<"."<<queue;
+			out << (config.TOTAL_STORAGE>>10) << "GB." << config.NUM_CHANS << "Ch." << config.NUM_RANKS <<"R." <<config.ADDRESS_MAPPING_SCHEME<<"."<<config.ROW_BUFFER_POLICY<<"."<< config.TRANS_QUEUE_DEPTH<<"TQ."<<config.CMD_QUEUE_DEPTH<<"CQ."<<sched<<"."<<queue;
 		}
 		else //visFilename given
 		{
@@ -287,7 +389,7 @@ void MultiChannelMemorySystem::InitOutputFiles(string traceFilename)
 			exit(-1);
 		}
 		//write out the ini config values for the visualizer tool
-		IniReader::WriteValuesOut(visDataOut);
+		iniReader.WriteValuesOut(visDataOut);
 
 	}
 	else
@@ -310,6 +412,10 @@ void MultiChannelMemorySystem::InitOutputFiles(string traceFilename)
 	ERROR("Cannot open "<< dramsimLogFilename);
 	//	exit(-1); 
 	}
+	else
+	{
+		logBuffer.attach(dramsim_log);
+	}
 #endif
 
 }
@@ -353,7 +459,7 @@ void MultiChannelMemorySystem::mkdirIfNotExist(string path)
 
 MultiChannelMemorySystem::~MultiChannelMemorySystem()
 {
-	for (size_t i=0; i<NUM_CHANS; i++)
+	for (size_t i=0; i<config.NUM_CHANS; i++)
 	{
 		delete channels[i];
 	}
@@ -361,14 +467,22 @@ MultiChannelMemorySystem::~MultiChannelMemorySystem()
 
 // flush our streams and close them up
 #ifdef LOG_OUTPUT
+	logBuffer.detach();
 	dramsim_log.flush();
 	dramsim_log.close();
 #endif
-	if (VIS_FILE_OUTPUT) 
+	if (config.VIS_FILE_OUTPUT) 
 	{	
 		visDataOut.flush();
 		visDataOut.close();
 	}
+	if (config.VERIFICATION_OUTPUT)
+	{
+		verifyBuffer.detach();
+		cmd_verify_out.flush();
+		cmd_verify_out.close();
+	}
+	commandTrace.close();
 }
 void MultiChannelMemorySystem::update()
 {
@@ -382,20 +496,46 @@ void MultiChannelMemorySystem::actual_update()
 		DEBUG("DRAMSim2 Clock Frequency ="<<clockDomainCrosser.clock1<<"Hz, CPU Clock Frequency="<<clockDomainCrosser.clock2<<"Hz"); 
 	}
 
-	if (currentClockCycle % EPOCH_LENGTH == 0)
+	while (!channelWakeups.empty() && channelWakeups.top().first <= currentClockCycle)
+	{
+		unsigned chan = channelWakeups.top().second;
+		if (channelAsleep[chan] && channelWakeCycle[chan] == channelWakeups.top().first)
+		{
+			wakeChannel(chan);
+		}
+		channelWakeups.pop();
+	}
+
+	if (currentClockCycle % config.EPOCH_LENGTH == 0)
 	{
-		(*csvOut) << "ms" <<currentClockCycle * tCK * 1E-6; 
-		for (size_t i=0; i<NUM_CHANS; i++)
+		catchUpChannels();
+		(*csvOut) << "ms" <<currentClockCycle * config.tCK * 1E-6; 
+		for (size_t i=0; i<config.NUM_CHANS; i++)
 		{
 			channels[i]->printStats(false); 
 		}
 		csvOut->finalize();
 	}
 	
-	for (size_t i=0; i<NUM_CHANS; i++)
+	size_t stillActive = 0;
+	for (size_t i=0; i<activeChannels.size(); i++)
 	{
-		channels[i]->update(); 
+		unsigned chan = activeChannels[i];
+		channels[chan]->update(); 
+
+		uint64_t quiescent = channels[chan]->quiescentCycles();
+		if (quiescent > 0)
+		{
+			channelAsleep[chan] = true;
+			channelWakeCycle[chan] = currentClockCycle + 1 + quiescent;
+			channelWakeups.push(ChannelWakeup(channelWakeCycle[chan], chan));
+		}
+		else
+		{
+			activeChannels[stillActive++] = chan;
+		}
 	}
+	activeChannels.resize(stillActive);
 
 
 	currentClockCycle++; 
@@ -403,24 +543,22 @@ void MultiChannelMemorySystem::actual_update()
 unsigned MultiChannelMemorySystem::findChannelNumber(uint64_t addr)
 {
 	// Single channel case is a trivial shortcut case 
-	if (NUM_CHANS == 1)
+	if (config.NUM_CHANS == 1)
 	{
 		return 0; 
 	}
 
-	if (!isPowerOfTwo(NUM_CHANS))
+	if (!isPowerOfTwo(config.NUM_CHANS))
 	{
 		ERROR("We can only support power of two # of channels.\n" <<
 				"I don't know what Intel was thinking, but trying to address map half a bit is a neat trick that we're not sure how to do"); 
 		abort(); 
 	}
 
-	// only chan is used from this set 
-	unsigned channelNumber,rank,bank,row,col;
-	addressMapping(addr, channelNumber, rank, bank, row, col); 
-	if (channelNumber >= NUM_CHANS)
+	unsigned channelNumber = channelSelect.channel(addr);
+	if (channelNumber >= config.NUM_CHANS)
 	{
-		ERROR("Got channel index "<<channelNumber<<" but only "<<NUM_CHANS<<" exist"); 
+		ERROR("Got channel index "<<channelNumber<<" but only "<<config.NUM_CHANS<<" exist"); 
 		abort();
 	}
 	//DEBUG("Channel idx = "<<channelNumber<<" totalbits="<<totalBits<<" channelbits="<<channelBits); 
@@ -428,6 +566,35 @@ unsigned MultiChannelMemorySystem::findChannelNumber(uint64_t addr)
 	return channelNumber;
 
 }
+// catches a sleeping channel up and has it updated every cycle again
+void MultiChannelMemorySystem::wakeChannel(unsigned chan)
+{
+	channels[chan]->catchUp(currentClockCycle);
+	if (channelAsleep[chan])
+	{
+		channelAsleep[chan] = false;
+		activeChannels.insert(lower_bound(activeChannels.begin(), activeChannels.end(), chan), chan);
+	}
+}
+
+void MultiChannelMemorySystem::wakeChannels()
+{
+	for (size_t i=0; i<config.NUM_CHANS; i++)
+	{
+		wakeChannel(i);
+	}
+}
+
+// brings every channel up to date without waking it, for looking at (or
+// saving) the whole memory system
+void MultiChannelMemorySystem::catchUpChannels() const
+{
+	for (size_t i=0; i<config.NUM_CHANS; i++)
+	{
+		channels[i]->catchUp(currentClockCycle);
+	}
+}
+
 ostream &MultiChannelMemorySystem::getLogFile()
 {
 	return dramsim_log; 
@@ -441,39 +608,37 @@ bool MultiChannelMemorySystem::addTransaction(const Transaction &trans)
 bool MultiChannelMemorySystem::addTransaction(Transaction *trans)
 {
 	unsigned channelNumber = findChannelNumber(trans->address); 
+	wakeChannel(channelNumber);
 	return channels[channelNumber]->addTransaction(trans); 
 }
 
 bool MultiChannelMemorySystem::addTransaction(bool isWrite, uint64_t addr, uint64_t securityDomain)
 {
 	unsigned channelNumber = findChannelNumber(addr); 
+	wakeChannel(channelNumber);
 	return channels[channelNumber]->addTransaction(isWrite, addr, securityDomain); 
 }
 
 // Triggered by defence magic instruction in victim program
 void MultiChannelMemorySystem::startDefence(uint64_t cpuid, uint64_t iDefenceDomain, uint64_t dDefenceDomain) 
 {
-	if (DEBUG_DEFENCE) PRINT("Starting Defence");
-	if (protection == DAG) {
-		if (DEBUG_DEFENCE) PRINT("DAG Protection Enabled!");
+	if (config.DEBUG_DEFENCE) PRINT("Starting Defence");
+	if (config.protection == DAG) {
+		if (config.DEBUG_DEFENCE) PRINT("DAG Protection Enabled!");
 
                 // Determine the protection domain mapping
-		int domainNum = channels[0]->memoryController->dag.size();
-
-                // Read in defense DAG json file
-                std::istringstream ss(defenceFilename);
-                std::string token;
-                
-                for(int i = 0; i <= cpuid; i++) {
-                  std::getline(ss, token, ';');
-                }
+		int domainNum = channels[0]->memoryController->dags.size();
 
-		std::ifstream i(token);
-
-                json j;
-                i >> j;
+                // cpuids past the last DAG file use the last one
+		if (defenceDags.empty())
+		{
+			ERROR("== Error - No DAG file was given for cpuid "<<cpuid);
+			exit(-1);
+		}
+		size_t file = min<uint64_t>(cpuid, defenceDags.size() - 1);
+		string token = defenceDagFiles[file];
 
-                channels[0]->memoryController->dag.push_back(j); 
+                channels[0]->memoryController->dags.push_back(defenceDags[file]);
 
                 // Record protection domain <-> CPU mapping
 		channels[0]->memoryController->instIDArr.push_back(iDefenceDomain);
@@ -482,12 +647,14 @@ void MultiChannelMemorySystem::startDefence(uint64_t cpuid, uint64_t iDefenceDom
 		channels[0]->memoryController->revInst[iDefenceDomain] = domainNum;
 		channels[0]->memoryController->revData[dDefenceDomain] = domainNum;
 
+		channels[0]->memoryController->rebuildDomainGroups();
+
 		PRINT("CPUID: " << cpuid << "DefenceFile: " << token << "IDefenceDomain: " << iDefenceDomain << " DDefenceDomain: " << dDefenceDomain);
 
 		channels[0]->memoryController->initDefence(domainNum);
 	} 
-	else if (protection == FixedService_BTA) {
-		if (DEBUG_DEFENCE) PRINT("BTA Protection Enabled!");
+	else if (config.protection == FixedService_BTA) {
+		if (config.DEBUG_DEFENCE) PRINT("BTA Protection Enabled!");
 
 		int domainNum = channels[0]->memoryController->dataIDArr.size();
 
@@ -497,8 +664,9 @@ void MultiChannelMemorySystem::startDefence(uint64_t cpuid, uint64_t iDefenceDom
 
 		channels[0]->memoryController->revInst[iDefenceDomain] = domainNum;
 		channels[0]->memoryController->revData[dDefenceDomain] = domainNum;
+		channels[0]->memoryController->rebuildDomainGroups();
 	}
-	else if (protection == FixedRate) {
+	else if (config.protection == FixedRate) {
                 // DEPRECATED
 		channels[0]->memoryController->initCQDefence(iDefenceDomain, dDefenceDomain);
 	}
@@ -511,8 +679,8 @@ void MultiChannelMemorySystem::startDefence(uint64_t cpuid, uint64_t iDefenceDom
 void MultiChannelMemorySystem::updateDefence(uint64_t oldDefence, uint64_t newDefence, bool isdata) 
 {
 	int domain;
-	if (DEBUG_DEFENCE) PRINT("Updating Defence Old: " << oldDefence << " New: " << newDefence);
-	if (protection == DAG || protection == FixedService_BTA) {
+	if (config.DEBUG_DEFENCE) PRINT("Updating Defence Old: " << oldDefence << " New: " << newDefence);
+	if (config.protection == DAG || config.protection == FixedService_BTA) {
 
 		if (isdata && channels[0]->memoryController->revData.count(oldDefence)) {
 			domain = channels[0]->memoryController->revData[oldDefence];
@@ -541,6 +709,7 @@ void MultiChannelMemorySystem::updateDefence(uint64_t oldDefence, uint64_t newDe
 			channels[0]->memoryController->revInst[newDefence] = domain;
 			channels[0]->memoryController->instIDArr[domain] = newDefence;
 		}
+		channels[0]->memoryController->rebuildDomainGroups();
 	} /*
 	else if (protection == FixedService_BTA) {
 		if (channels[0]->memoryController->iDefenceDomain == oldDefence) {
@@ -549,7 +718,7 @@ void MultiChannelMemorySystem::updateDefence(uint64_t oldDefence, uint64_t newDe
 			channels[0]->memoryController->dDefenceDomain = newDefence;
 		}
 	} */
-	else if (protection == FixedRate) {
+	else if (config.protection == FixedRate) {
 		assert(false);
 	}
 	 
@@ -558,7 +727,7 @@ void MultiChannelMemorySystem::updateDefence(uint64_t oldDefence, uint64_t newDe
 
 void MultiChannelMemorySystem::endDefence()
 {
-	if (DEBUG_DEFENCE) PRINT("Stopping Defence");
+	if (config.DEBUG_DEFENCE) PRINT("Stopping Defence");
 	channels[0]->memoryController->stopDefence();
 }
 
@@ -573,15 +742,14 @@ void MultiChannelMemorySystem::endDefence()
 
 bool MultiChannelMemorySystem::willAcceptTransaction(uint64_t addr)
 {
-	unsigned chan, rank,bank,row,col; 
-	addressMapping(addr, chan, rank, bank, row, col); 
-	return channels[chan]->WillAcceptTransaction(); 
+	return channels[findChannelNumber(addr)]->WillAcceptTransaction(); 
 }
 
+// a sleeping channel has an empty transaction queue
 bool MultiChannelMemorySystem::willAcceptTransaction()
 {
-	for (size_t c=0; c<NUM_CHANS; c++) {
-		if (!channels[c]->WillAcceptTransaction())
+	for (size_t i=0; i<activeChannels.size(); i++) {
+		if (!channels[activeChannels[i]]->WillAcceptTransaction())
 		{
 			return false; 
 		}
@@ -593,21 +761,25 @@ bool MultiChannelMemorySystem::willAcceptTransaction()
 
 void MultiChannelMemorySystem::printStats(bool finalStats) {
 
-	(*csvOut) << "ms" <<currentClockCycle * tCK * 1E-6; 
-	for (size_t i=0; i<NUM_CHANS; i++)
+	catchUpChannels();
+	(*csvOut) << "ms" <<currentClockCycle * config.tCK * 1E-6; 
+	for (size_t i=0; i<config.NUM_CHANS; i++)
 	{
 		PRINT("==== Channel ["<<i<<"] ====");
 		channels[i]->printStats(finalStats); 
 		PRINT("//// Channel ["<<i<<"] ////");
 	}
 	csvOut->finalize();
+	logBuffer.flush();
+	verifyBuffer.flush();
+	commandTrace.flush();
 }
 void MultiChannelMemorySystem::RegisterCallbacks( 
 		TransactionCompleteCB *readDone,
 		TransactionCompleteCB *writeDone,
 		void (*reportPower)(double bgpower, double burstpower, double refreshpower, double actprepower))
 {
-	for (size_t i=0; i<NUM_CHANS; i++)
+	for (size_t i=0; i<config.NUM_CHANS; i++)
 	{
 		channels[i]->RegisterCallbacks(readDone, writeDone, reportPower); 
 	}
@@ -620,30 +792,260 @@ void MultiChannelMemorySystem::RegisterCallbacks(
  */
 int MultiChannelMemorySystem::getIniBool(const std::string& field, bool *val)
 {
-	if (!IniReader::CheckIfAllSet())
+	if (!iniReader.CheckIfAllSet())
 		exit(-1);
-	return IniReader::getBool(field, val);
+	return iniReader.getBool(field, val);
 }
 
 int MultiChannelMemorySystem::getIniUint(const std::string& field, unsigned int *val)
 {
-	if (!IniReader::CheckIfAllSet())
+	if (!iniReader.CheckIfAllSet())
 		exit(-1);
-	return IniReader::getUint(field, val);
+	return iniReader.getUint(field, val);
 }
 
 int MultiChannelMemorySystem::getIniUint64(const std::string& field, uint64_t *val)
 {
-	if (!IniReader::CheckIfAllSet())
+	if (!iniReader.CheckIfAllSet())
 		exit(-1);
-	return IniReader::getUint64(field, val);
+	return iniReader.getUint64(field, val);
 }
 
 int MultiChannelMemorySystem::getIniFloat(const std::string& field, float *val)
 {
-	if (!IniReader::CheckIfAllSet())
+	if (!iniReader.CheckIfAllSet())
 		exit(-1);
-	return IniReader::getFloat(field, val);
+	return iniReader.getFloat(field, val);
+}
+
+const Config &MultiChannelMemorySystem::getConfig() const
+{
+	return config;
+}
+
+// totals over all channels
+MemoryControllerStats MultiChannelMemorySystem::getStats() const
+{
+	MemoryControllerStats stats = MemoryControllerStats();
+	for (size_t i=0; i<config.NUM_CHANS; i++)
+	{
+		MemoryControllerStats channelStats = channels[i]->memoryController->getStats();
+		stats.totalTransactions += channelStats.totalTransactions;
+		stats.totalReads += channelStats.totalReads;
+		stats.totalReadLatency += channelStats.totalReadLatency;
+		stats.totalFakeRequests += channelStats.totalFakeRequests;
+	}
+	return stats;
+}
+
+/**
+ * A checkpoint holds the timing state of every channel: bank states, command
+ * and transaction queues, in-flight packets, refresh countdowns, the defence
+ * (DAG/FS-BTA) bookkeeping and the epoch stats. Data payloads are not saved.
+ *
+ * It can only be restored into a freshly constructed memory system with the
+ * same geometry. The defence state is only restored if PROTECTION matches the
+ * checkpoint, so one warmed up checkpoint can be run under several modes.
+ */
+static const char CHECKPOINT_MAGIC[] = "DRAMSim2 checkpoint";
+static const uint32_t CHECKPOINT_VERSION = 4;
+
+void MultiChannelMemorySystem::serialize(CheckpointOut &cp) const
+{
+	cp.put(string(CHECKPOINT_MAGIC));
+	cp.put(CHECKPOINT_VERSION);
+	cp.put(config.NUM_CHANS);
+	cp.put(config.NUM_RANKS);
+	cp.put(config.NUM_BANKS);
+	cp.put(config.NUM_ROWS);
+	cp.put(config.NUM_COLS);
+	cp.put(config.queuingStructure);
+	cp.put(config.protection);
+
+	catchUpChannels();
+	cp.put(currentClockCycle);
+	cp.put(clockDomainCrosser.counter1);
+	cp.put(clockDomainCrosser.counter2);
+	for (size_t i=0; i<config.NUM_CHANS; i++)
+	{
+		channels[i]->serialize(cp);
+	}
+}
+
+bool MultiChannelMemorySystem::unserialize(CheckpointIn &cp)
+{
+	if (currentClockCycle != 0)
+	{
+		ERROR("A checkpoint can only be restored before the first update()");
+		return false;
+	}
+
+	string magic;
+	uint32_t version = 0;
+	cp.get(magic);
+	cp.get(version);
+	if (!cp.good() || magic != CHECKPOINT_MAGIC || version != CHECKPOINT_VERSION)
+	{
+		ERROR("Not a version "<<CHECKPOINT_VERSION<<" checkpoint");
+		return false;
+	}
+
+	unsigned numChans, numRanks, numBanks, numRows, numCols;
+	QueuingStructure queuingStructure;
+	Protection protection;
+	cp.get(numChans);
+	cp.get(numRanks);
+	cp.get(numBanks);
+	cp.get(numRows);
+	cp.get(numCols);
+	cp.get(queuingStructure);
+	cp.get(protection);
+	if (numChans != config.NUM_CHANS || numRanks != config.NUM_RANKS ||
+			numBanks != config.NUM_BANKS || numRows != config.NUM_ROWS ||
+			numCols != config.NUM_COLS || queuingStructure != config.queuingStructure)
+	{
+		ERROR("Checkpoint was taken with a different memory geometry ("<<numChans<<" channels, "<<numRanks<<" ranks, "<<numBanks<<" banks, "<<numRows<<" rows, "<<numCols<<" columns)");
+		return false;
+	}
+
+	bool restoreDefence = (protection == config.protection);
+	if (!restoreDefence)
+	{
+		DEBUG("== Checkpoint used a different PROTECTION, starting without its defence state == ");
+	}
+
+	cp.get(currentClockCycle);
+	cp.get(clockDomainCrosser.counter1);
+	cp.get(clockDomainCrosser.counter2);
+	for (size_t i=0; i<config.NUM_CHANS; i++)
+	{
+		channels[i]->unserialize(cp, restoreDefence);
+	}
+	if (!cp.good())
+	{
+		ERROR("Checkpoint is truncated");
+		return false;
+	}
+
+	// actual_update() only sets up the output files on cycle 0
+	if (currentClockCycle != 0)
+	{
+		InitOutputFiles(traceFilename);
+	}
+	return true;
+}
+
+bool MultiChannelMemorySystem::saveCheckpoint(const string &filename)
+{
+	if (channels[0]->fastTiming)
+	{
+		ERROR("== Error - Can't checkpoint while fast timing is on");
+		return false;
+	}
+	ofstream checkpointFile(filename.c_str(), ios::binary);
+	if (!checkpointFile.is_open())
+	{
+		ERROR("== Error - Could not open checkpoint file "<<filename<<" for writing");
+		return false;
+	}
+	CheckpointOut cp(checkpointFile);
+	serialize(cp);
+	return cp.good();
+}
+
+bool MultiChannelMemorySystem::restoreCheckpoint(const string &filename)
+{
+	ifstream checkpointFile(filename.c_str(), ios::binary);
+	if (!checkpointFile.is_open())
+	{
+		ERROR("== Error - Could not open checkpoint file "<<filename);
+		return false;
+	}
+	CheckpointIn cp(checkpointFile);
+	return unserialize(cp);
+}
+
+/**
+ * Sampled simulation support: once every channel isIdle(), the detailed
+ * model can be switched off with saveFunctionalState(), moved forward with
+ * skipCycles() while a FunctionalModel handles the requests, and switched
+ * back on with loadFunctionalState(). DAG schedules are keyed by cycle, so
+ * skipping cycles under DAG protection would lose scheduled nodes.
+ */
+bool MultiChannelMemorySystem::isIdle() const
+{
+	for (size_t i=0; i<config.NUM_CHANS; i++)
+	{
+		if (!channels[i]->isIdle())
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void MultiChannelMemorySystem::skipCycles(uint64_t cycles)
+{
+	if (!isIdle())
+	{
+		ERROR("Can't skip cycles with requests in flight");
+		abort();
+	}
+	wakeChannels();
+	currentClockCycle += cycles;
+	for (size_t i=0; i<config.NUM_CHANS; i++)
+	{
+		channels[i]->skipCycles(cycles);
+	}
+}
+
+void MultiChannelMemorySystem::saveFunctionalState(vector<FunctionalState> &states) const
+{
+	catchUpChannels();
+	states.resize(config.NUM_CHANS);
+	for (size_t i=0; i<config.NUM_CHANS; i++)
+	{
+		channels[i]->memoryController->saveFunctionalState(states[i]);
+	}
+}
+
+void MultiChannelMemorySystem::loadFunctionalState(const vector<FunctionalState> &states)
+{
+	wakeChannels();
+	for (size_t i=0; i<config.NUM_CHANS; i++)
+	{
+		channels[i]->memoryController->loadFunctionalState(states[i]);
+	}
+}
+
+/**
+ * Fast timing replaces the memory controllers with an analytical model
+ * (see FastTimingModel) for fast-forwarding. Requests still complete
+ * through the callbacks and the queue depth still applies, so the caller
+ * sees plausible latencies and backpressure. Returns false if it can't be
+ * switched on yet because requests are still in the detailed model; DAG
+ * protection can't be run without the detailed controller at all.
+ */
+bool MultiChannelMemorySystem::setFastTiming(bool enable)
+{
+	if (enable)
+	{
+		if (config.protection == DAG)
+		{
+			ERROR("Fast timing can't be used with DAG protection");
+			return false;
+		}
+		if (!isIdle())
+		{
+			return false;
+		}
+	}
+	wakeChannels();
+	for (size_t i=0; i<config.NUM_CHANS; i++)
+	{
+		channels[i]->setFastTiming(enable);
+	}
+	return true;
 }
 
 namespace DRAMSim {
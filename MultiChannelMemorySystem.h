@@ -31,11 +31,13 @@
 #include "Transaction.h"
 #include "SystemConfiguration.h"
 #include "MemorySystem.h"
+#include "AddressMapping.h"
 #include "IniReader.h"
 #include "ClockDomain.h"
 #include "CSVWriter.h"
-
-#include "json.hpp"
+#include "DefenceDag.h"
+#include "AsyncLogBuffer.h"
+#include "CommandTrace.h"
 
 
 namespace DRAMSim {
@@ -45,7 +47,7 @@ class MultiChannelMemorySystem : public SimulatorObject
 {
 	public: 
 
-	MultiChannelMemorySystem(const string &dev, const string &sys, const string &pwd, const string &trc, const string &def, const string &def2, unsigned megsOfMemory, const string &visFilename=NULL, const IniReader::OverrideMap *paramOverrides=NULL);
+	MultiChannelMemorySystem(const string &dev, const string &sys, const string &pwd, const string &trc, const string &def, const string &def2, unsigned megsOfMemory, const string &visFilename="", const IniReader::OverrideMap *paramOverrides=NULL);
 		virtual ~MultiChannelMemorySystem();
 			bool addTransaction(Transaction *trans);
 			bool addTransaction(const Transaction &trans);
@@ -66,6 +68,17 @@ class MultiChannelMemorySystem : public SimulatorObject
 			int getIniUint(const std::string &field, unsigned int *val);
 			int getIniUint64(const std::string &field, uint64_t *val);
 			int getIniFloat(const std::string &field, float *val);
+			const Config &getConfig() const;
+			MemoryControllerStats getStats() const;
+			bool saveCheckpoint(const std::string &filename);
+			bool restoreCheckpoint(const std::string &filename);
+			void serialize(CheckpointOut &cp) const;
+			bool unserialize(CheckpointIn &cp);
+			bool isIdle() const;
+			void skipCycles(uint64_t cycles);
+			void saveFunctionalState(vector<FunctionalState> &states) const;
+			void loadFunctionalState(const vector<FunctionalState> &states);
+			bool setFastTiming(bool enable);
 
 	void InitOutputFiles(string tracefilename);
 	void setCPUClockSpeed(uint64_t cpuClkFreqHz);
@@ -73,19 +86,40 @@ class MultiChannelMemorySystem : public SimulatorObject
 	//output file
 	std::ofstream visDataOut;
 	ofstream dramsim_log; 
+	ofstream cmd_verify_out; //modelsim command trace if VERIFICATION_OUTPUT is set
+	//both are written a line at a time, so they go out in blocks from another thread
+	AsyncLogBuffer logBuffer;
+	AsyncLogBuffer verifyBuffer;
+	CommandTraceWriter commandTrace; //if COMMAND_TRACE is set
 
 	private:
 		unsigned findChannelNumber(uint64_t addr);
 		void actual_update(); 
+		void wakeChannel(unsigned chan);
+		void wakeChannels();
+		void catchUpChannels() const;
 		vector<MemorySystem*> channels; 
+		//a quiescent channel is put to sleep instead of being updated every
+		//cycle, and catches up when it is next touched or its refresh is due
+		vector<unsigned> activeChannels; //in channel order
+		vector<bool> channelAsleep;
+		vector<uint64_t> channelWakeCycle;
+		typedef pair<uint64_t, unsigned> ChannelWakeup;
+		priority_queue<ChannelWakeup, vector<ChannelWakeup>, greater<ChannelWakeup> > channelWakeups; //may hold stale entries
+		ChannelSelect channelSelect;
 		unsigned megsOfMemory; 
 		string deviceIniFilename;
 		string systemIniFilename;
 		string traceFilename;
 		string defenceFilename;
 		string defenceFilename2;
+		DefenceDagCache dagCache;
+		vector<string> defenceDagFiles; //[cpuid]
+		vector<const DefenceDag *> defenceDags; //[cpuid]
 		string pwd;
 		string visFilename;
+		Config config;
+		IniReader iniReader;
 		ClockDomain::ClockDomainCrosser clockDomainCrosser; 
 		static void mkdirIfNotExist(string path);
 		static bool fileExists(string path); 
@@ -36,6 +36,7 @@
 #define PRINT_MACROS_H
 
 #include <iostream>
+#include <atomic>
 
 extern int SHOW_SIM_OUTPUT;
 
@@ -51,6 +52,19 @@ using std::ostream;
 	#define DEBUGN(str) ;
 #endif
 
+// Warnings that can fire every cycle print the first WARN_LIMIT times they
+// are reached and after that only every power of two times, with a count
+#define WARN_LIMIT 10
+#define LIMITED(print, str) { \
+	static std::atomic<unsigned long long> warnCount(0); \
+	unsigned long long count = ++warnCount; \
+	if (count <= WARN_LIMIT || (count & (count-1)) == 0) { \
+		print(str << (count < WARN_LIMIT ? std::string() : count == WARN_LIMIT ? std::string(" (rate limited from now on)") : " (seen " + std::to_string(count) + " times)")) \
+	} \
+}
+#define DEBUG_LIMITED(str) LIMITED(DEBUG, str)
+#define PRINT_LIMITED(str) LIMITED(PRINT, str)
+
 #ifdef NO_OUTPUT
 	#undef DEBUG
 	#undef DEBUGN
@@ -37,14 +37,21 @@
 using namespace std;
 using namespace DRAMSim;
 
-Rank::Rank(ostream &dramsim_log_) :
+Rank::Rank(const Config &config_, ostream &dramsim_log_, ostream &cmd_verify_out_) :
 	id(-1),
+	config(config_),
 	dramsim_log(dramsim_log_),
+	cmd_verify_out(cmd_verify_out_),
+	incomingWriteBank(0),
+	incomingWriteRow(0),
+	incomingWriteColumn(0),
 	isPowerDown(false),
 	refreshWaiting(false),
 	readReturnCountdown(0),
-	banks(NUM_BANKS, Bank(dramsim_log_)),
-	bankStates(NUM_BANKS, BankState(dramsim_log_))
+#ifndef NO_STORAGE
+	banks(config.NUM_BANKS, Bank(config, dramsim_log_)),
+#endif
+	bankStates(config.FAST_RANK ? 0 : config.NUM_BANKS, dramsim_log_)
 
 {
 
@@ -81,23 +88,28 @@ Rank::~Rank()
 }
 void Rank::receiveFromBus(BusPacket *packet)
 {
-	if (DEBUG_BUS)
+	if (config.DEBUG_BUS)
 	{
 		PRINTN(" -- R" << this->id << " Receiving On Bus    : ");
 		packet->print();
 	}
-	if (VERIFICATION_OUTPUT)
+	if (config.VERIFICATION_OUTPUT)
 	{
-		packet->print(currentClockCycle,false);
+		packet->print(cmd_verify_out, currentClockCycle,false);
+	}
+	if (config.FAST_RANK)
+	{
+		receiveTrusted(packet);
+		return;
 	}
 
 	switch (packet->busPacketType)
 	{
 	case READ:
 		//make sure a read is allowed
-		if (bankStates[packet->bank].currentBankState != RowActive ||
-		        currentClockCycle < bankStates[packet->bank].nextRead ||
-		        packet->row != bankStates[packet->bank].openRowAddress)
+		if (bankStates.currentBankState[packet->bank] != RowActive ||
+		        currentClockCycle < bankStates.nextRead[packet->bank] ||
+		        packet->row != bankStates.openRowAddress[packet->bank])
 		{
 			packet->print();
 			ERROR("== Error - Rank " << id << " received a READ when not allowed");
@@ -105,12 +117,9 @@ void Rank::receiveFromBus(BusPacket *packet)
 		}
 
 		//update state table
-		bankStates[packet->bank].nextPrecharge = max(bankStates[packet->bank].nextPrecharge, currentClockCycle + READ_TO_PRE_DELAY);
-		for (size_t i=0;i<NUM_BANKS;i++)
-		{
-			bankStates[i].nextRead = max(bankStates[i].nextRead, currentClockCycle + max(tCCD, BL/2));
-			bankStates[i].nextWrite = max(bankStates[i].nextWrite, currentClockCycle + READ_TO_WRITE_DELAY);
-		}
+		bankStates.nextPrecharge[packet->bank] = max(bankStates.nextPrecharge[packet->bank], currentClockCycle + config.timing.READ_TO_PRE_DELAY);
+		BankStates::delay(bankStates.nextRead, currentClockCycle + config.timing.CCD_DELAY);
+		BankStates::delay(bankStates.nextWrite, currentClockCycle + config.timing.READ_TO_WRITE_DELAY);
 
 		//get the read data and put it in the storage which delays until the appropriate time (RL)
 #ifndef NO_STORAGE
@@ -119,27 +128,24 @@ void Rank::receiveFromBus(BusPacket *packet)
 		packet->busPacketType = DATA;
 #endif
 		readReturnPacket.push_back(packet);
-		readReturnCountdown.push_back(RL);
+		readReturnCountdown.push_back(config.timing.RL);
 		break;
 	case READ_P:
 		//make sure a read is allowed
-		if (bankStates[packet->bank].currentBankState != RowActive ||
-		        currentClockCycle < bankStates[packet->bank].nextRead ||
-		        packet->row != bankStates[packet->bank].openRowAddress)
+		if (bankStates.currentBankState[packet->bank] != RowActive ||
+		        currentClockCycle < bankStates.nextRead[packet->bank] ||
+		        packet->row != bankStates.openRowAddress[packet->bank])
 		{
 			ERROR("== Error - Rank " << id << " received a READ_P when not allowed");
 			exit(-1);
 		}
 
 		//update state table
-		bankStates[packet->bank].currentBankState = Idle;
-		bankStates[packet->bank].nextActivate = max(bankStates[packet->bank].nextActivate, currentClockCycle + READ_AUTOPRE_DELAY);
-		for (size_t i=0;i<NUM_BANKS;i++)
-		{
-			//will set next read/write for all banks - including current (which shouldnt matter since its now idle)
-			bankStates[i].nextRead = max(bankStates[i].nextRead, currentClockCycle + max(BL/2, tCCD));
-			bankStates[i].nextWrite = max(bankStates[i].nextWrite, currentClockCycle + READ_TO_WRITE_DELAY);
-		}
+		bankStates.currentBankState[packet->bank] = Idle;
+		bankStates.nextActivate[packet->bank] = max(bankStates.nextActivate[packet->bank], currentClockCycle + config.timing.READ_AUTOPRE_DELAY);
+		//will set next read/write for all banks - including current (which shouldnt matter since its now idle)
+		BankStates::delay(bankStates.nextRead, currentClockCycle + config.timing.CCD_DELAY);
+		BankStates::delay(bankStates.nextWrite, currentClockCycle + config.timing.READ_TO_WRITE_DELAY);
 
 		//get the read data and put it in the storage which delays until the appropriate time (RL)
 #ifndef NO_STORAGE
@@ -149,26 +155,23 @@ void Rank::receiveFromBus(BusPacket *packet)
 #endif
 
 		readReturnPacket.push_back(packet);
-		readReturnCountdown.push_back(RL);
+		readReturnCountdown.push_back(config.timing.RL);
 		break;
 	case WRITE:
 		//make sure a write is allowed
-		if (bankStates[packet->bank].currentBankState != RowActive ||
-		        currentClockCycle < bankStates[packet->bank].nextWrite ||
-		        packet->row != bankStates[packet->bank].openRowAddress)
+		if (bankStates.currentBankState[packet->bank] != RowActive ||
+		        currentClockCycle < bankStates.nextWrite[packet->bank] ||
+		        packet->row != bankStates.openRowAddress[packet->bank])
 		{
 			ERROR("== Error - Rank " << id << " received a WRITE when not allowed");
-			bankStates[packet->bank].print();
+			bankStates.print(packet->bank);
 			exit(0);
 		}
 
 		//update state table
-		bankStates[packet->bank].nextPrecharge = max(bankStates[packet->bank].nextPrecharge, currentClockCycle + WRITE_TO_PRE_DELAY);
-		for (size_t i=0;i<NUM_BANKS;i++)
-		{
-			bankStates[i].nextRead = max(bankStates[i].nextRead, currentClockCycle + WRITE_TO_READ_DELAY_B);
-			bankStates[i].nextWrite = max(bankStates[i].nextWrite, currentClockCycle + max(BL/2, tCCD));
-		}
+		bankStates.nextPrecharge[packet->bank] = max(bankStates.nextPrecharge[packet->bank], currentClockCycle + config.timing.WRITE_TO_PRE_DELAY);
+		BankStates::delay(bankStates.nextRead, currentClockCycle + config.timing.WRITE_TO_READ_DELAY_B);
+		BankStates::delay(bankStates.nextWrite, currentClockCycle + config.timing.CCD_DELAY);
 
 		//take note of where data is going when it arrives
 		incomingWriteBank = packet->bank;
@@ -178,22 +181,19 @@ void Rank::receiveFromBus(BusPacket *packet)
 		break;
 	case WRITE_P:
 		//make sure a write is allowed
-		if (bankStates[packet->bank].currentBankState != RowActive ||
-		        currentClockCycle < bankStates[packet->bank].nextWrite ||
-		        packet->row != bankStates[packet->bank].openRowAddress)
+		if (bankStates.currentBankState[packet->bank] != RowActive ||
+		        currentClockCycle < bankStates.nextWrite[packet->bank] ||
+		        packet->row != bankStates.openRowAddress[packet->bank])
 		{
 			ERROR("== Error - Rank " << id << " received a WRITE_P when not allowed");
 			exit(0);
 		}
 
 		//update state table
-		bankStates[packet->bank].currentBankState = Idle;
-		bankStates[packet->bank].nextActivate = max(bankStates[packet->bank].nextActivate, currentClockCycle + WRITE_AUTOPRE_DELAY);
-		for (size_t i=0;i<NUM_BANKS;i++)
-		{
-			bankStates[i].nextWrite = max(bankStates[i].nextWrite, currentClockCycle + max(tCCD, BL/2));
-			bankStates[i].nextRead = max(bankStates[i].nextRead, currentClockCycle + WRITE_TO_READ_DELAY_B);
-		}
+		bankStates.currentBankState[packet->bank] = Idle;
+		bankStates.nextActivate[packet->bank] = max(bankStates.nextActivate[packet->bank], currentClockCycle + config.timing.WRITE_AUTOPRE_DELAY);
+		BankStates::delay(bankStates.nextWrite, currentClockCycle + config.timing.CCD_DELAY);
+		BankStates::delay(bankStates.nextRead, currentClockCycle + config.timing.WRITE_TO_READ_DELAY_B);
 
 		//take note of where data is going when it arrives
 		incomingWriteBank = packet->bank;
@@ -203,64 +203,63 @@ void Rank::receiveFromBus(BusPacket *packet)
 		break;
 	case ACTIVATE:
 		//make sure activate is allowed
-		if (bankStates[packet->bank].currentBankState != Idle ||
-		        currentClockCycle < bankStates[packet->bank].nextActivate)
+		if (bankStates.currentBankState[packet->bank] != Idle ||
+		        currentClockCycle < bankStates.nextActivate[packet->bank])
 		{
 			ERROR("== Error - Rank " << id << " received an ACT when not allowed");
 			packet->print();
-			bankStates[packet->bank].print();
+			bankStates.print(packet->bank);
 			exit(0);
 		}
 
-		bankStates[packet->bank].currentBankState = RowActive;
-		bankStates[packet->bank].nextActivate = currentClockCycle + tRC;
-		bankStates[packet->bank].openRowAddress = packet->row;
+		bankStates.currentBankState[packet->bank] = RowActive;
+		bankStates.nextActivate[packet->bank] = currentClockCycle + config.tRC;
+		bankStates.openRowAddress[packet->bank] = packet->row;
 
 		//if AL is greater than one, then posted-cas is enabled - handle accordingly
-		if (AL>0)
+		if (config.AL>0)
 		{
-			bankStates[packet->bank].nextWrite = currentClockCycle + (tRCD-AL);
-			bankStates[packet->bank].nextRead = currentClockCycle + (tRCD-AL);
+			bankStates.nextWrite[packet->bank] = currentClockCycle + (config.tRCD-config.AL);
+			bankStates.nextRead[packet->bank] = currentClockCycle + (config.tRCD-config.AL);
 		}
 		else
 		{
-			bankStates[packet->bank].nextWrite = currentClockCycle + (tRCD-AL);
-			bankStates[packet->bank].nextRead = currentClockCycle + (tRCD-AL);
+			bankStates.nextWrite[packet->bank] = currentClockCycle + (config.tRCD-config.AL);
+			bankStates.nextRead[packet->bank] = currentClockCycle + (config.tRCD-config.AL);
 		}
 
-		bankStates[packet->bank].nextPrecharge = currentClockCycle + tRAS;
-		for (size_t i=0;i<NUM_BANKS;i++)
+		bankStates.nextPrecharge[packet->bank] = currentClockCycle + config.tRAS;
 		{
-			if (i != packet->bank)
-			{
-				bankStates[i].nextActivate = max(bankStates[i].nextActivate, currentClockCycle + tRRD);
-			}
+			//tRRD holds for every other bank
+			uint64_t nextActivate = bankStates.nextActivate[packet->bank];
+			BankStates::delay(bankStates.nextActivate, currentClockCycle + config.tRRD);
+			bankStates.nextActivate[packet->bank] = nextActivate;
 		}
 		delete(packet); 
 		break;
 	case PRECHARGE:
 		//make sure precharge is allowed
-		if (bankStates[packet->bank].currentBankState != RowActive ||
-		        currentClockCycle < bankStates[packet->bank].nextPrecharge)
+		if (bankStates.currentBankState[packet->bank] != RowActive ||
+		        currentClockCycle < bankStates.nextPrecharge[packet->bank])
 		{
 			ERROR("== Error - Rank " << id << " received a PRE when not allowed");
 			exit(0);
 		}
 
-		bankStates[packet->bank].currentBankState = Idle;
-		bankStates[packet->bank].nextActivate = max(bankStates[packet->bank].nextActivate, currentClockCycle + tRP);
+		bankStates.currentBankState[packet->bank] = Idle;
+		bankStates.nextActivate[packet->bank] = max(bankStates.nextActivate[packet->bank], currentClockCycle + config.tRP);
 		delete(packet); 
 		break;
 	case REFRESH:
 		refreshWaiting = false;
-		for (size_t i=0;i<NUM_BANKS;i++)
+		for (size_t i=0;i<config.NUM_BANKS;i++)
 		{
-			if (bankStates[i].currentBankState != Idle)
+			if (bankStates.currentBankState[i] != Idle)
 			{
 				ERROR("== Error - Rank " << id << " received a REF when not allowed");
 				exit(0);
 			}
-			bankStates[i].nextActivate = currentClockCycle + tRFC;
+			bankStates.nextActivate[i] = currentClockCycle + config.tRFC;
 		}
 		delete(packet); 
 		break;
@@ -273,7 +272,7 @@ void Rank::receiveFromBus(BusPacket *packet)
 			{
 				cout << "== Error - Rank " << id << " received a DATA packet to the wrong place" << endl;
 				packet->print();
-				bankStates[packet->bank].print();
+				bankStates.print(packet->bank);
 				exit(0);
 			}
 		*/
@@ -291,6 +290,51 @@ void Rank::receiveFromBus(BusPacket *packet)
 	}
 }
 
+// FAST_RANK: the controller has already checked the command against its own
+// bank states, so all that is left to do is to send back the read data and
+// take note of where the write data goes
+void Rank::receiveTrusted(BusPacket *packet)
+{
+	switch (packet->busPacketType)
+	{
+	case READ:
+	case READ_P:
+#ifndef NO_STORAGE
+		banks[packet->bank].read(packet);
+#else
+		packet->busPacketType = DATA;
+#endif
+		readReturnPacket.push_back(packet);
+		readReturnCountdown.push_back(config.timing.RL);
+		break;
+	case WRITE:
+	case WRITE_P:
+		incomingWriteBank = packet->bank;
+		incomingWriteRow = packet->row;
+		incomingWriteColumn = packet->column;
+		delete(packet);
+		break;
+	case ACTIVATE:
+	case PRECHARGE:
+		delete(packet);
+		break;
+	case REFRESH:
+		refreshWaiting = false;
+		delete(packet);
+		break;
+	case DATA:
+#ifndef NO_STORAGE
+		banks[packet->bank].write(packet);
+#endif
+		delete(packet);
+		break;
+	default:
+		ERROR("== Error - Unknown BusPacketType trying to be sent to Bank");
+		exit(0);
+		break;
+	}
+}
+
 int Rank::getId() const
 {
 	return this->id;
@@ -325,13 +369,13 @@ void Rank::update()
 		// ready to go out on the bus
 
 		outgoingDataPacket = readReturnPacket[0];
-		dataCyclesLeft = BL/2;
+		dataCyclesLeft = config.timing.BURST_CYCLES;
 
 		// remove the packet from the ranks
 		readReturnPacket.erase(readReturnPacket.begin());
 		readReturnCountdown.erase(readReturnCountdown.begin());
 
-		if (DEBUG_BUS)
+		if (config.DEBUG_BUS)
 		{
 			PRINTN(" -- R" << this->id << " Issuing On Data Bus : ");
 			outgoingDataPacket->print();
@@ -341,20 +385,26 @@ void Rank::update()
 	}
 }
 
+//true if no read data is waiting to go back to the controller
+bool Rank::isIdle() const
+{
+	return outgoingDataPacket == NULL && readReturnPacket.empty() && !refreshWaiting;
+}
+
 //power down the rank
 void Rank::powerDown()
 {
 	//perform checks
-	for (size_t i=0;i<NUM_BANKS;i++)
+	for (size_t i=0;i<bankStates.size();i++)
 	{
-		if (bankStates[i].currentBankState != Idle)
+		if (bankStates.currentBankState[i] != Idle)
 		{
 			ERROR("== Error - Trying to power down rank " << id << " while not all banks are idle");
 			exit(0);
 		}
 
-		bankStates[i].nextPowerUp = currentClockCycle + tCKE;
-		bankStates[i].currentBankState = PowerDown;
+		bankStates.nextPowerUp[i] = currentClockCycle + config.tCKE;
+		bankStates.currentBankState[i] = PowerDown;
 	}
 
 	isPowerDown = true;
@@ -371,15 +421,78 @@ void Rank::powerUp()
 
 	isPowerDown = false;
 
-	for (size_t i=0;i<NUM_BANKS;i++)
+	for (size_t i=0;i<bankStates.size();i++)
 	{
-		if (bankStates[i].nextPowerUp > currentClockCycle)
+		if (bankStates.nextPowerUp[i] > currentClockCycle)
 		{
 			ERROR("== Error - Trying to power up rank " << id << " before we're allowed to");
-			ERROR(bankStates[i].nextPowerUp << "    " << currentClockCycle);
+			ERROR(bankStates.nextPowerUp[i] << "    " << currentClockCycle);
 			exit(0);
 		}
-		bankStates[i].nextActivate = currentClockCycle + tXP;
-		bankStates[i].currentBankState = Idle;
+		bankStates.nextActivate[i] = currentClockCycle + config.tXP;
+		bankStates.currentBankState[i] = Idle;
+	}
+}
+
+// the contents of the banks (if NO_STORAGE is off) are not part of a
+// checkpoint, only the timing state is
+void Rank::serialize(CheckpointOut &cp) const
+{
+	cp.put(currentClockCycle);
+	cp.put(incomingWriteBank);
+	cp.put(incomingWriteRow);
+	cp.put(incomingWriteColumn);
+	cp.put(isPowerDown);
+	cp.putBusPacket(outgoingDataPacket);
+	cp.put(dataCyclesLeft);
+	cp.put(refreshWaiting);
+	cp.putBusPackets(readReturnPacket);
+	cp.put(readReturnCountdown);
+	if (config.FAST_RANK)
+	{
+		//without bank states of our own, save the controller's, so the
+		//checkpoint can be restored without FAST_RANK too; a rank sees the
+		//banks the controller has precharging or refreshing as idle already
+		BankStates controllerStates = memoryController->getBankStates(id);
+		for (size_t i=0;i<controllerStates.size();i++)
+		{
+			if (controllerStates.currentBankState[i] == Precharging ||
+			        controllerStates.currentBankState[i] == Refreshing)
+			{
+				controllerStates.currentBankState[i] = Idle;
+			}
+		}
+		controllerStates.serialize(cp);
+	}
+	else
+	{
+		bankStates.serialize(cp);
+	}
+}
+
+void Rank::unserialize(CheckpointIn &cp)
+{
+	cp.get(currentClockCycle);
+	cp.get(incomingWriteBank);
+	cp.get(incomingWriteRow);
+	cp.get(incomingWriteColumn);
+	cp.get(isPowerDown);
+	delete outgoingDataPacket;
+	outgoingDataPacket = cp.getBusPacket(dramsim_log);
+	cp.get(dataCyclesLeft);
+	cp.get(refreshWaiting);
+	for (size_t i=0; i<readReturnPacket.size(); i++)
+	{
+		delete readReturnPacket[i];
+	}
+	cp.getBusPackets(readReturnPacket, dramsim_log);
+	cp.get(readReturnCountdown);
+	if (config.FAST_RANK)
+	{
+		BankStates(config.NUM_BANKS, dramsim_log).unserialize(cp);
+	}
+	else
+	{
+		bankStates.unserialize(cp);
 	}
 }
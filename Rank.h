@@ -39,6 +39,7 @@
 #include "SystemConfiguration.h"
 #include "Bank.h"
 #include "BankState.h"
+#include "Checkpoint.h"
 
 using namespace std;
 using namespace DRAMSim;
@@ -50,15 +51,19 @@ class Rank : public SimulatorObject
 {
 private:
 	int id;
+	const Config &config;
 	ostream &dramsim_log; 
+	ostream &cmd_verify_out; //modelsim command trace if VERIFICATION_OUTPUT is set
 	unsigned incomingWriteBank;
 	unsigned incomingWriteRow;
 	unsigned incomingWriteColumn;
 	bool isPowerDown;
 
+	void receiveTrusted(BusPacket *packet);
+
 public:
 	//functions
-	Rank(ostream &dramsim_log_);
+	Rank(const Config &config_, ostream &dramsim_log_, ostream &cmd_verify_out_);
 	virtual ~Rank(); 
 	void receiveFromBus(BusPacket *packet);
 	void attachMemoryController(MemoryController *mc);
@@ -67,6 +72,9 @@ public:
 	void update();
 	void powerUp();
 	void powerDown();
+	bool isIdle() const;
+	void serialize(CheckpointOut &cp) const;
+	void unserialize(CheckpointIn &cp);
 
 	//fields
 	MemoryController *memoryController;
@@ -77,8 +85,10 @@ public:
 	//these are vectors so that each element is per-bank
 	vector<BusPacket *> readReturnPacket;
 	vector<unsigned> readReturnCountdown;
+#ifndef NO_STORAGE
 	vector<Bank> banks;
-	vector<BankState> bankStates;
+#endif
+	BankStates bankStates; //empty with FAST_RANK
 
 };
 }
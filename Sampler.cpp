@@ -0,0 +1,194 @@
+/*********************************************************************************
+*  Copyright (c) 2010-2011, Elliott Cooper-Balis
+*                             Paul Rosenfeld
+*                             Bruce Jacob
+*                             University of Maryland 
+*                             dramninjas [at] gmail [dot] com
+*  All rights reserved.
+*  
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*  
+*     * Redistributions of source code must retain the above copyright notice,
+*        this list of conditions and the following disclaimer.
+*  
+*     * Redistributions in binary form must reproduce the above copyright notice,
+*        this list of conditions and the following disclaimer in the documentation
+*        and/or other materials provided with the distribution.
+*  
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+*  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+*  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+*  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************************/
+
+
+
+//Sampler.cpp
+//
+//SMARTS style sampled trace replay
+//
+
+#include <cmath>
+
+#include "Sampler.h"
+#include "MultiChannelMemorySystem.h"
+#include "Trace.h"
+
+using namespace std;
+
+namespace DRAMSim
+{
+Sampler::Sampler(MultiChannelMemorySystem *memorySystem_, TracePlayer &tracePlayer_, uint64_t period_, uint64_t warmup_, uint64_t window_) :
+	memorySystem(memorySystem_),
+	tracePlayer(tracePlayer_),
+	functionalModel(memorySystem_->getConfig()),
+	period(period_),
+	warmup(warmup_),
+	window(window_),
+	startClockCycle(0),
+	currentClockCycle(0),
+	endClockCycle(0),
+	detailedCycles(0)
+{
+	if (memorySystem->getConfig().protection == DAG)
+	{
+		ERROR("Sampling can't skip cycles under DAG protection, its schedule is kept by cycle");
+		exit(-1);
+	}
+	if (period < warmup + window)
+	{
+		ERROR("The sample period ("<<period<<") has to cover the warmup ("<<warmup<<") and the window ("<<window<<")");
+		exit(-1);
+	}
+}
+
+// playTrace is false while draining so the controller can empty out
+void Sampler::runDetailed(uint64_t cycles, bool playTrace)
+{
+	for (uint64_t i=0; i<cycles && currentClockCycle<endClockCycle; i++)
+	{
+		if (playTrace)
+		{
+			tracePlayer.update(currentClockCycle);
+		}
+		memorySystem->update();
+		currentClockCycle++;
+		detailedCycles++;
+	}
+}
+
+void Sampler::run(uint64_t startCycle, uint64_t numCycles)
+{
+	startClockCycle = startCycle;
+	currentClockCycle = startCycle;
+	endClockCycle = startCycle + numCycles;
+
+	while (currentClockCycle < endClockCycle)
+	{
+		uint64_t nextPeriod = min(currentClockCycle + period, endClockCycle);
+
+		runDetailed(warmup, true);
+
+		SampleWindow sample;
+		MemoryControllerStats before = memorySystem->getStats();
+		sample.startCycle = currentClockCycle;
+		runDetailed(window, true);
+		sample.cycles = currentClockCycle - sample.startCycle;
+		sample.stats = memorySystem->getStats();
+		sample.stats.totalTransactions -= before.totalTransactions;
+		sample.stats.totalReads -= before.totalReads;
+		sample.stats.totalReadLatency -= before.totalReadLatency;
+		sample.stats.totalFakeRequests -= before.totalFakeRequests;
+		if (sample.cycles > 0)
+		{
+			windows.push_back(sample);
+		}
+
+		while (!memorySystem->isIdle() && currentClockCycle < endClockCycle)
+		{
+			runDetailed(1, false);
+		}
+
+		// drained past the start of the next period, so it starts right away
+		if (currentClockCycle >= nextPeriod)
+		{
+			continue;
+		}
+
+		memorySystem->saveFunctionalState(functionalModel.channels);
+		functionalModel.currentClockCycle = currentClockCycle;
+		tracePlayer.skipTo(nextPeriod, functionalModel);
+		functionalModel.advanceTo(nextPeriod);
+		memorySystem->skipCycles(nextPeriod - currentClockCycle);
+		memorySystem->loadFunctionalState(functionalModel.channels);
+		currentClockCycle = nextPeriod;
+	}
+}
+
+// sample mean and the half width of its 95% confidence interval
+static void meanAndInterval(const vector<double> &values, double &mean, double &interval)
+{
+	mean = 0.0;
+	interval = 0.0;
+	if (values.size() == 0)
+	{
+		return;
+	}
+	for (size_t i=0; i<values.size(); i++)
+	{
+		mean += values[i];
+	}
+	mean /= values.size();
+	if (values.size() < 2)
+	{
+		return;
+	}
+	double variance = 0.0;
+	for (size_t i=0; i<values.size(); i++)
+	{
+		variance += (values[i] - mean) * (values[i] - mean);
+	}
+	variance /= values.size() - 1;
+	interval = 1.96 * sqrt(variance / values.size());
+}
+
+void Sampler::printStats() const
+{
+	const Config &config = memorySystem->getConfig();
+#ifdef LOG_OUTPUT
+	ostream &dramsim_log = memorySystem->getLogFile();
+#endif
+	unsigned bytesPerTransaction = (config.JEDEC_DATA_BUS_BITS*config.BL)/8;
+
+	vector<double> bandwidth;
+	vector<double> latency;
+	for (size_t i=0; i<windows.size(); i++)
+	{
+		const SampleWindow &sample = windows[i];
+		double seconds = (double)sample.cycles * config.tCK * 1E-9;
+		bandwidth.push_back(((double)sample.stats.totalTransactions * bytesPerTransaction / (1024.0*1024.0*1024.0)) / seconds);
+		if (sample.stats.totalReads > 0)
+		{
+			latency.push_back((double)sample.stats.totalReadLatency / sample.stats.totalReads * config.tCK);
+		}
+	}
+
+	double bandwidthMean, bandwidthInterval, latencyMean, latencyInterval;
+	meanAndInterval(bandwidth, bandwidthMean, bandwidthInterval);
+	meanAndInterval(latency, latencyMean, latencyInterval);
+
+	PRINT(" ============== Sampled Simulation ==============");
+	PRINT("   Windows measured : " << windows.size() << " of " << window << " cycles every " << period << " cycles");
+	PRINT("   Detailed cycles  : " << detailedCycles << " of " << endClockCycle - startClockCycle);
+	PRINT("   Functional accesses : " << functionalModel.totalAccesses << " (" << functionalModel.rowHits << " row hits)");
+	PRINT("   Bandwidth : " << bandwidthMean << " +/- " << bandwidthInterval << " GB/s (95% CI)");
+	PRINT("   Average read latency : " << latencyMean << " +/- " << latencyInterval << " ns (95% CI, " << latency.size() << " windows with reads)");
+}
+}
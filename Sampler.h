@@ -0,0 +1,91 @@
+/*********************************************************************************
+*  Copyright (c) 2010-2011, Elliott Cooper-Balis
+*                             Paul Rosenfeld
+*                             Bruce Jacob
+*                             University of Maryland 
+*                             dramninjas [at] gmail [dot] com
+*  All rights reserved.
+*  
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*  
+*     * Redistributions of source code must retain the above copyright notice,
+*        this list of conditions and the following disclaimer.
+*  
+*     * Redistributions in binary form must reproduce the above copyright notice,
+*        this list of conditions and the following disclaimer in the documentation
+*        and/or other materials provided with the distribution.
+*  
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+*  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+*  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+*  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************************/
+
+
+
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+//Sampler.h
+//
+//SMARTS style sampled trace replay
+//
+
+#include <vector>
+
+#include "FunctionalModel.h"
+#include "MemoryController.h"
+
+namespace DRAMSim
+{
+class MultiChannelMemorySystem;
+class TracePlayer;
+
+// what the detailed model measured in one window
+struct SampleWindow
+{
+	uint64_t startCycle;
+	uint64_t cycles;
+	MemoryControllerStats stats;
+};
+
+/**
+ * Every period cycles the detailed model is run for warmup cycles, then
+ * measured for window cycles, then left to drain. Until the next period
+ * starts the trace only goes through a FunctionalModel, which keeps the
+ * open rows and refresh phase warm for the next window.
+ */
+class Sampler
+{
+public:
+	Sampler(MultiChannelMemorySystem *memorySystem, TracePlayer &tracePlayer, uint64_t period, uint64_t warmup, uint64_t window);
+	void run(uint64_t startCycle, uint64_t numCycles);
+	void printStats() const;
+
+	std::vector<SampleWindow> windows;
+
+private:
+	void runDetailed(uint64_t cycles, bool playTrace);
+
+	MultiChannelMemorySystem *memorySystem;
+	TracePlayer &tracePlayer;
+	FunctionalModel functionalModel;
+	uint64_t period;
+	uint64_t warmup;
+	uint64_t window;
+
+	uint64_t startClockCycle;
+	uint64_t currentClockCycle;
+	uint64_t endClockCycle;
+	uint64_t detailedCycles;
+};
+}
+
+#endif
@@ -0,0 +1,662 @@
+/*********************************************************************************
+*  Copyright (c) 2010-2011, Elliott Cooper-Balis
+*                             Paul Rosenfeld
+*                             Bruce Jacob
+*                             University of Maryland 
+*                             dramninjas [at] gmail [dot] com
+*  All rights reserved.
+*  
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*  
+*     * Redistributions of source code must retain the above copyright notice,
+*        this list of conditions and the following disclaimer.
+*  
+*     * Redistributions in binary form must reproduce the above copyright notice,
+*        this list of conditions and the following disclaimer in the documentation
+*        and/or other materials provided with the distribution.
+*  
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+*  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+*  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+*  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************************/
+
+
+
+//SweepRunner.cpp
+//
+//Runs a parameter sweep over several trace-based simulations in one process
+//
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <getopt.h>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <iomanip>
+#include <cmath>
+
+#include "SystemConfiguration.h"
+#include "MultiChannelMemorySystem.h"
+#include "IniReader.h"
+#include "Trace.h"
+
+
+using namespace DRAMSim;
+using namespace std;
+
+int SHOW_SIM_OUTPUT = 0;
+
+// a trace and the DAG files its START records refer to
+struct SweepTrace
+{
+	string filename;
+	string defenceFilenames;
+	TraceType type;
+	vector<TraceRecord> records;
+};
+
+struct SweepSpec
+{
+	vector<SweepTrace> traces;
+	vector<string> devices;
+	vector<string> protections;
+	vector<string> options;
+	string systemIniFilename;
+	uint64_t numCycles;
+	unsigned megsOfMemory;
+	bool useClockCycle;
+	unsigned numThreads;
+	unsigned numSegments;
+	uint64_t segmentWarmup;
+	uint64_t epochLength;
+};
+
+struct SweepRun
+{
+	size_t trace;
+	size_t device;
+	size_t protection;
+	size_t option;
+
+	uint64_t cycles;
+	MemoryControllerStats stats;
+	double wallSeconds;
+
+	//stitched from the measured part of every segment
+	vector<MemoryControllerStats> epochs;
+	vector<size_t> epochSegments;
+	//relative error of the last warmup epoch of each segment against the
+	//segment before it, which simulated that epoch warm; -1 if there was
+	//no full warmup epoch to compare
+	vector<double> boundaryBandwidthError;
+	vector<double> boundaryLatencyError;
+};
+
+/**
+ * One time slice of a run. It is simulated on its own memory system from
+ * warmupCycle, which is up to segmentWarmup cycles before startCycle, but
+ * only the epochs from startCycle on are counted for the run; the warmup
+ * epochs are kept to check the result at the boundary. All the cycles are
+ * multiples of the epoch length, except that the last segment ends at the
+ * end of the run.
+ */
+struct SweepSegment
+{
+	size_t run;
+	size_t index;
+	uint64_t warmupCycle;
+	uint64_t startCycle;
+	uint64_t endCycle;
+
+	vector<MemoryControllerStats> epochs; //from warmupCycle on
+	double wallSeconds;
+};
+
+void usage()
+{
+	cout << "DRAMSimSweep Usage: " << endl;
+	cout << "DRAMSimSweep -f sweep.spec [-j #] [-p pwd] [-r results.tsv] [-e epochs.tsv]" <<endl;
+	cout << "\t-f, --spec=FILENAME \t\tspecify the sweep to run"<<endl;
+	cout << "\t-j, --threads=# \t\tnumber of simulations to run at once [default=number of cores]"<<endl;
+	cout << "\t-p, --pwd=DIRECTORY\t\tSet the working directory (i.e. usually DRAMSim directory where ini/ and results/ are)"<<endl;
+	cout << "\t-r, --results=FILENAME \t\twrite the results table here instead of stdout"<<endl;
+	cout << "\t-e, --epochs=FILENAME \t\talso write the stats of every epoch of every run here"<<endl;
+	cout << endl;
+	cout << "Each line of the spec file is a keyword followed by its values; every"<<endl;
+	cout << "combination of trace, device, protection and option is simulated:"<<endl;
+	cout << "\ttrace FILE [DAG;DAG]\t\ta trace file (repeatable) and the DAG files for its START records"<<endl;
+	cout << "\tdevice FILENAME\t\t\ta device ini file (repeatable)"<<endl;
+	cout << "\tsystem FILENAME\t\t\tthe system ini file [default=system.ini]"<<endl;
+	cout << "\tprotection MODE [MODE ...]\tvalues for PROTECTION [default=as in the system ini]"<<endl;
+	cout << "\toption KEY=VALUE[,KEY=VALUE]\ta set of ini overrides (repeatable)"<<endl;
+	cout << "\tcycles #\t\t\tnumber of cycles to run each simulation for [default=30]"<<endl;
+	cout << "\tsize #\t\t\t\tsize of the memory system in megabytes [default=2048]"<<endl;
+	cout << "\tnotiming\t\t\tdo not use the clock cycle information in the trace files"<<endl;
+	cout << "\tthreads #\t\t\tsame as -j"<<endl;
+	cout << "\tsegments # [WARMUP]\t\tsplit each simulation into # time segments run in parallel, each"<<endl;
+	cout << "\t\t\t\t\twarmed up on the WARMUP cycles before it [default=1 0]"<<endl;
+	cout << "\tepoch #\t\t\t\tcycles per row of the epoch table [default=100000]"<<endl;
+}
+
+bool parseSweepSpec(const string &filename, SweepSpec &spec)
+{
+	ifstream specFile(filename.c_str());
+	if (!specFile.is_open())
+	{
+		ERROR("== Error - Could not open sweep spec: "<<filename);
+		return false;
+	}
+
+	string line;
+	size_t lineNumber = 0;
+	while (getline(specFile, line))
+	{
+		lineNumber++;
+		size_t comment = line.find('#');
+		if (comment != string::npos)
+		{
+			line.erase(comment);
+		}
+
+		istringstream iss(line);
+		string keyword;
+		if (!(iss >> keyword))
+		{
+			continue;
+		}
+
+		if (keyword == "trace")
+		{
+			SweepTrace trace;
+			if (!(iss >> trace.filename))
+			{
+				ERROR("line "<<lineNumber<<": trace needs a filename");
+				return false;
+			}
+			iss >> trace.defenceFilenames;
+			spec.traces.push_back(trace);
+		}
+		else if (keyword == "device")
+		{
+			string device;
+			if (!(iss >> device))
+			{
+				ERROR("line "<<lineNumber<<": device needs a filename");
+				return false;
+			}
+			spec.devices.push_back(device);
+		}
+		else if (keyword == "system")
+		{
+			iss >> spec.systemIniFilename;
+		}
+		else if (keyword == "protection")
+		{
+			string protection;
+			while (iss >> protection)
+			{
+				spec.protections.push_back(protection);
+			}
+		}
+		else if (keyword == "option")
+		{
+			string option;
+			iss >> option;
+			spec.options.push_back(option);
+		}
+		else if (keyword == "cycles")
+		{
+			iss >> spec.numCycles;
+		}
+		else if (keyword == "size")
+		{
+			iss >> spec.megsOfMemory;
+		}
+		else if (keyword == "notiming")
+		{
+			spec.useClockCycle = false;
+		}
+		else if (keyword == "threads")
+		{
+			iss >> spec.numThreads;
+		}
+		else if (keyword == "segments")
+		{
+			iss >> spec.numSegments;
+			iss >> spec.segmentWarmup;
+		}
+		else if (keyword == "epoch")
+		{
+			iss >> spec.epochLength;
+		}
+		else
+		{
+			ERROR("line "<<lineNumber<<": unknown keyword '"<<keyword<<"'");
+			return false;
+		}
+	}
+
+	if (spec.traces.size() == 0 || spec.devices.size() == 0)
+	{
+		ERROR("The sweep spec needs at least one trace and one device");
+		return false;
+	}
+	if (spec.numSegments == 0 || spec.epochLength == 0)
+	{
+		ERROR("segments and epoch have to be at least 1");
+		return false;
+	}
+	// segments are cut by trace cycle
+	if (spec.numSegments > 1 && !spec.useClockCycle)
+	{
+		ERROR("segments can't be used with notiming");
+		return false;
+	}
+
+	// an empty entry just leaves the ini files alone
+	if (spec.protections.size() == 0)
+	{
+		spec.protections.push_back("");
+	}
+	if (spec.options.size() == 0)
+	{
+		spec.options.push_back("");
+	}
+	return true;
+}
+
+void subtractStats(MemoryControllerStats &a, const MemoryControllerStats &b)
+{
+	a.totalTransactions -= b.totalTransactions;
+	a.totalReads -= b.totalReads;
+	a.totalReadLatency -= b.totalReadLatency;
+	a.totalFakeRequests -= b.totalFakeRequests;
+}
+
+void addStats(MemoryControllerStats &a, const MemoryControllerStats &b)
+{
+	a.totalTransactions += b.totalTransactions;
+	a.totalReads += b.totalReads;
+	a.totalReadLatency += b.totalReadLatency;
+	a.totalFakeRequests += b.totalFakeRequests;
+}
+
+double averageReadLatency(const MemoryControllerStats &stats)
+{
+	return stats.totalReads ? (double)stats.totalReadLatency / stats.totalReads : 0.0;
+}
+
+void runSegment(const SweepSpec &spec, const string &pwd, const SweepRun &run, SweepSegment &segment)
+{
+	const SweepTrace &trace = spec.traces[run.trace];
+
+	IniReader::OverrideMap paramOverrides;
+	IniReader::ParseOverrides(spec.options[run.option], paramOverrides);
+	if (spec.protections[run.protection].length() > 0)
+	{
+		paramOverrides["PROTECTION"] = spec.protections[run.protection];
+	}
+	// every run would write to the same vis and verification files
+	paramOverrides["VIS_FILE_OUTPUT"] = "false";
+	paramOverrides["VERIFICATION_OUTPUT"] = "false";
+
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+	MultiChannelMemorySystem *memorySystem = new MultiChannelMemorySystem(spec.devices[run.device], spec.systemIniFilename, pwd, trace.filename, trace.defenceFilenames, "", spec.megsOfMemory, "", &paramOverrides);
+	memorySystem->setCPUClockSpeed(0);
+
+	// start the clocks at the segment so the trace cycles line up
+	memorySystem->skipCycles(segment.warmupCycle);
+	TraceVectorSource traceSource(trace.records, segment.warmupCycle);
+	TracePlayer tracePlayer(memorySystem, traceSource);
+
+	MemoryControllerStats lastStats = MemoryControllerStats();
+	for (uint64_t i=segment.warmupCycle; i<segment.endCycle; i++)
+	{
+		tracePlayer.update(i);
+		memorySystem->update();
+
+		if ((i+1) % spec.epochLength == 0 || i+1 == segment.endCycle)
+		{
+			MemoryControllerStats stats = memorySystem->getStats();
+			MemoryControllerStats epoch = stats;
+			subtractStats(epoch, lastStats);
+			segment.epochs.push_back(epoch);
+			lastStats = stats;
+		}
+	}
+	delete memorySystem;
+
+	segment.wallSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+double relativeError(double value, double reference)
+{
+	if (reference == 0.0)
+	{
+		return value == 0.0 ? 0.0 : 1.0;
+	}
+	return fabs(value - reference) / reference;
+}
+
+// puts the measured epochs of each run's segments back together in order
+void stitchSegments(const SweepSpec &spec, vector<SweepRun> &runs, const vector<SweepSegment> &segments)
+{
+	for (size_t s=0; s<segments.size(); s++)
+	{
+		const SweepSegment &segment = segments[s];
+		SweepRun &run = runs[segment.run];
+		size_t firstMeasured = (segment.startCycle - segment.warmupCycle) / spec.epochLength;
+
+		for (size_t e=firstMeasured; e<segment.epochs.size(); e++)
+		{
+			run.epochs.push_back(segment.epochs[e]);
+			run.epochSegments.push_back(segment.index);
+			addStats(run.stats, segment.epochs[e]);
+		}
+		run.cycles += segment.endCycle - segment.startCycle;
+		run.wallSeconds = max(run.wallSeconds, segment.wallSeconds);
+
+		if (segment.index == 0)
+		{
+			continue;
+		}
+		if (firstMeasured == 0)
+		{
+			run.boundaryBandwidthError.push_back(-1.0);
+			run.boundaryLatencyError.push_back(-1.0);
+			continue;
+		}
+		// the segment before this one in the same run is the previous entry
+		// and its last epoch is the one just before startCycle
+		const MemoryControllerStats &cold = segment.epochs[firstMeasured-1];
+		const MemoryControllerStats &warm = segments[s-1].epochs.back();
+		run.boundaryBandwidthError.push_back(relativeError(cold.totalTransactions, warm.totalTransactions));
+		run.boundaryLatencyError.push_back(relativeError(averageReadLatency(cold), averageReadLatency(warm)));
+	}
+}
+
+void writeResults(ostream &out, const SweepSpec &spec, const vector<SweepRun> &runs)
+{
+	out << "run\ttrace\tdevice\tprotection\toptions\tcycles\ttransactions\treads\tavg_read_latency\tfake_requests\twall_seconds\tcycles_per_sec\tsegments\tmax_boundary_error" << endl;
+	for (size_t i=0; i<runs.size(); i++)
+	{
+		const SweepRun &run = runs[i];
+		double averageLatency = averageReadLatency(run.stats);
+		double maxBoundaryError = -1.0;
+		for (size_t b=0; b<run.boundaryBandwidthError.size(); b++)
+		{
+			maxBoundaryError = max(maxBoundaryError, max(run.boundaryBandwidthError[b], run.boundaryLatencyError[b]));
+		}
+		double cyclesPerSecond = run.wallSeconds > 0 ? run.cycles / run.wallSeconds : 0.0;
+		const string &protection = spec.protections[run.protection];
+		const string &options = spec.options[run.option];
+
+		out << i << "\t"
+			<< spec.traces[run.trace].filename << "\t"
+			<< spec.devices[run.device] << "\t"
+			<< (protection.length() ? protection : "-") << "\t"
+			<< (options.length() ? options : "-") << "\t"
+			<< run.cycles << "\t"
+			<< run.stats.totalTransactions << "\t"
+			<< run.stats.totalReads << "\t"
+			<< fixed << setprecision(3) << averageLatency << "\t"
+			<< run.stats.totalFakeRequests << "\t"
+			<< run.wallSeconds << "\t"
+			<< setprecision(0) << cyclesPerSecond << "\t"
+			<< run.boundaryBandwidthError.size() + 1 << "\t";
+		if (maxBoundaryError >= 0.0)
+		{
+			out << setprecision(4) << maxBoundaryError << endl;
+		}
+		else
+		{
+			out << "-" << endl;
+		}
+	}
+}
+
+// the boundary errors are given on the first epoch of each segment but the first
+void writeEpochs(ostream &out, const SweepSpec &spec, const vector<SweepRun> &runs)
+{
+	out << "run\tepoch\tstart_cycle\tsegment\ttransactions\treads\tavg_read_latency\tfake_requests\tboundary_bandwidth_error\tboundary_latency_error" << endl;
+	for (size_t i=0; i<runs.size(); i++)
+	{
+		const SweepRun &run = runs[i];
+		for (size_t e=0; e<run.epochs.size(); e++)
+		{
+			const MemoryControllerStats &epoch = run.epochs[e];
+			size_t segment = run.epochSegments[e];
+			out << i << "\t"
+				<< e << "\t"
+				<< e * spec.epochLength << "\t"
+				<< segment << "\t"
+				<< epoch.totalTransactions << "\t"
+				<< epoch.totalReads << "\t"
+				<< fixed << setprecision(3) << averageReadLatency(epoch) << "\t"
+				<< epoch.totalFakeRequests << "\t";
+			if (segment > 0 && (e == 0 || run.epochSegments[e-1] != segment) &&
+			    run.boundaryBandwidthError[segment-1] >= 0.0)
+			{
+				out << setprecision(4) << run.boundaryBandwidthError[segment-1] << "\t"
+					<< run.boundaryLatencyError[segment-1] << endl;
+			}
+			else
+			{
+				out << "-\t-" << endl;
+			}
+		}
+	}
+}
+
+int main(int argc, char **argv)
+{
+	int c;
+	string specFilename;
+	string resultsFilename;
+	string epochsFilename;
+	string pwdString;
+	unsigned numThreads = 0;
+
+	while (1)
+	{
+		static struct option long_options[] =
+		{
+			{"spec", required_argument, 0, 'f'},
+			{"threads", required_argument, 0, 'j'},
+			{"pwd", required_argument, 0, 'p'},
+			{"results", required_argument, 0, 'r'},
+			{"epochs", required_argument, 0, 'e'},
+			{"help", no_argument, 0, 'h'},
+			{0, 0, 0, 0}
+		};
+		int option_index=0; //for getopt
+		c = getopt_long (argc, argv, "f:j:p:r:e:h", long_options, &option_index);
+		if (c == -1)
+		{
+			break;
+		}
+		switch (c)
+		{
+		case 'h':
+			usage();
+			exit(0);
+			break;
+		case 'f':
+			specFilename = string(optarg);
+			break;
+		case 'j':
+			numThreads = atoi(optarg);
+			break;
+		case 'p':
+			pwdString = string(optarg);
+			break;
+		case 'r':
+			resultsFilename = string(optarg);
+			break;
+		case 'e':
+			epochsFilename = string(optarg);
+			break;
+		case '?':
+			usage();
+			exit(-1);
+			break;
+		}
+	}
+
+	if (specFilename.length() == 0)
+	{
+		ERROR("Please provide a sweep spec");
+		usage();
+		exit(-1);
+	}
+
+	SweepSpec spec;
+	spec.systemIniFilename = "system.ini";
+	spec.numCycles = 30;
+	spec.megsOfMemory = 2048;
+	spec.useClockCycle = true;
+	spec.numThreads = 0;
+	spec.numSegments = 1;
+	spec.segmentWarmup = 0;
+	spec.epochLength = 100000;
+	if (!parseSweepSpec(specFilename, spec))
+	{
+		exit(-1);
+	}
+
+	// -j wins over the spec file
+	if (numThreads == 0)
+	{
+		numThreads = spec.numThreads ? spec.numThreads : thread::hardware_concurrency();
+	}
+	if (numThreads == 0)
+	{
+		numThreads = 1;
+	}
+
+	// every run of a trace replays the same records, so each one is parsed once
+	for (size_t i=0; i<spec.traces.size(); i++)
+	{
+		SweepTrace &trace = spec.traces[i];
+		if (!traceTypeFromFilename(trace.filename, trace.type))
+		{
+			ERROR("== Unknown Tracefile Type : "<<trace.filename);
+			exit(-1);
+		}
+
+		//ignore the pwd argument if the argument is an absolute path
+		string traceFilename = trace.filename;
+		if (pwdString.length() > 0 && traceFilename[0] != '/')
+		{
+			traceFilename = pwdString + "/" + traceFilename;
+		}
+
+		DEBUG("== Loading trace file '"<<traceFilename<<"' == ");
+		loadTrace(traceFilename, trace.type, spec.useClockCycle, trace.records);
+	}
+
+	vector<SweepRun> runs;
+	for (size_t t=0; t<spec.traces.size(); t++)
+	{
+		for (size_t d=0; d<spec.devices.size(); d++)
+		{
+			for (size_t p=0; p<spec.protections.size(); p++)
+			{
+				for (size_t o=0; o<spec.options.size(); o++)
+				{
+					SweepRun run = SweepRun();
+					run.trace = t;
+					run.device = d;
+					run.protection = p;
+					run.option = o;
+					runs.push_back(run);
+				}
+			}
+		}
+	}
+
+	// segments are whole epochs so that their stats can be stitched together
+	uint64_t segmentLength = (spec.numCycles + spec.numSegments - 1) / spec.numSegments;
+	segmentLength = (segmentLength + spec.epochLength - 1) / spec.epochLength * spec.epochLength;
+	uint64_t warmupLength = spec.segmentWarmup / spec.epochLength * spec.epochLength;
+
+	vector<SweepSegment> segments;
+	for (size_t r=0; r<runs.size(); r++)
+	{
+		for (uint64_t start=0; start<spec.numCycles || start==0; start+=segmentLength)
+		{
+			SweepSegment segment = SweepSegment();
+			segment.run = r;
+			segment.index = start / segmentLength;
+			segment.startCycle = start;
+			segment.warmupCycle = start > warmupLength ? start - warmupLength : 0;
+			segment.endCycle = min(start + segmentLength, spec.numCycles);
+			segments.push_back(segment);
+		}
+	}
+
+	if (numThreads > segments.size())
+	{
+		numThreads = segments.size();
+	}
+	DEBUG("== Running "<<runs.size()<<" simulations in "<<segments.size()<<" segments on "<<numThreads<<" threads == ");
+
+	// each worker takes the next segment that nobody has started yet
+	atomic<size_t> nextSegment(0);
+	vector<thread> workers;
+	for (unsigned i=0; i<numThreads; i++)
+	{
+		workers.push_back(thread([&]()
+		{
+			size_t s;
+			while ((s = nextSegment++) < segments.size())
+			{
+				runSegment(spec, pwdString, runs[segments[s].run], segments[s]);
+			}
+		}));
+	}
+	for (size_t i=0; i<workers.size(); i++)
+	{
+		workers[i].join();
+	}
+	stitchSegments(spec, runs, segments);
+
+	if (epochsFilename.length() > 0)
+	{
+		ofstream epochsOut(epochsFilename.c_str());
+		if (!epochsOut.is_open())
+		{
+			ERROR("== Error - Could not open epochs file: "<<epochsFilename);
+			exit(-1);
+		}
+		writeEpochs(epochsOut, spec, runs);
+	}
+
+	if (resultsFilename.length() > 0)
+	{
+		ofstream resultsOut(resultsFilename.c_str());
+		if (!resultsOut.is_open())
+		{
+			ERROR("== Error - Could not open results file: "<<resultsFilename);
+			exit(-1);
+		}
+		writeResults(resultsOut, spec, runs);
+	}
+	else
+	{
+		writeResults(cout, spec, runs);
+	}
+	return 0;
+}
@@ -39,7 +39,11 @@
 #include <string>
 #include <cstdlib>
 #include <stdint.h>
+#include <algorithm>
 #include "PrintMacros.h"
+#ifdef DRAMSIM_DEVICE
+#include "DevicePresets.h"
+#endif
 
 #ifdef __APPLE__
 #include <sys/types.h>
@@ -55,108 +59,12 @@
 //TODO: move to system ini file
 #define HISTOGRAM_BIN_SIZE 10
 
-extern std::ofstream cmd_verify_out; //used by BusPacket.cpp if VERIFICATION_OUTPUT is enabled
-//extern std::ofstream visDataOut;
-
-//TODO: namespace these to DRAMSim:: 
-extern bool VERIFICATION_OUTPUT; // output suitable to feed to modelsim
-
-extern bool DEBUG_TRANS_Q;
-extern bool DEBUG_CMD_Q;
-extern bool DEBUG_ADDR_MAP;
-extern bool DEBUG_BANKSTATE;
-extern bool DEBUG_BUS;
-extern bool DEBUG_BANKS;
-extern bool DEBUG_POWER;
-extern bool DEBUG_DEFENCE;
-extern bool USE_LOW_POWER;
-extern bool VIS_FILE_OUTPUT;
-
-extern uint64_t TOTAL_STORAGE;
-extern unsigned NUM_BANKS;
-extern unsigned NUM_BANKS_LOG;
-extern unsigned NUM_RANKS;
-extern unsigned NUM_RANKS_LOG;
-extern unsigned NUM_CHANS;
-extern unsigned NUM_CHANS_LOG;
-extern unsigned NUM_DOMAINS;
-extern unsigned NUM_ROWS;
-extern unsigned NUM_ROWS_LOG;
-extern unsigned NUM_COLS;
-extern unsigned NUM_COLS_LOG;
-extern unsigned DEVICE_WIDTH;
-extern unsigned BYTE_OFFSET_WIDTH;
-extern unsigned TRANSACTION_SIZE;
-extern unsigned THROW_AWAY_BITS;
-extern unsigned COL_LOW_BIT_WIDTH;
-
-//in nanoseconds
-extern unsigned REFRESH_PERIOD;
-extern float tCK;
-
-extern unsigned CL;
-extern unsigned AL;
-#define RL (CL+AL)
-#define WL (RL-1)
-extern unsigned BL;
-extern unsigned tRAS;
-extern unsigned tRCD;
-extern unsigned tRRD;
-extern unsigned tRC;
-extern unsigned tRP;
-extern unsigned tCCD;
-extern unsigned tRTP;
-extern unsigned tWTR;
-extern unsigned tWR;
-extern unsigned tRTRS;
-extern unsigned tRFC;
-extern unsigned tFAW;
-extern unsigned tCKE;
-extern unsigned tXP;
-
-extern unsigned tCMD;
-
-/* For power parameters (current and voltage), see externs in MemoryController.cpp */ 
-
-extern unsigned NUM_DEVICES;
-
-//same bank
-#define READ_TO_PRE_DELAY (AL+BL/2+ max(tRTP,tCCD)-tCCD)
-#define WRITE_TO_PRE_DELAY (WL+BL/2+tWR)
-#define READ_TO_WRITE_DELAY (RL+BL/2+tRTRS-WL)
-#define READ_AUTOPRE_DELAY (AL+tRTP+tRP)
-#define WRITE_AUTOPRE_DELAY (WL+BL/2+tWR+tRP)
-#define WRITE_TO_READ_DELAY_B (WL+BL/2+tWTR) //interbank
-#define WRITE_TO_READ_DELAY_R (WL+BL/2+tRTRS-RL) //interrank
-
-extern unsigned JEDEC_DATA_BUS_BITS;
-
-//Memory Controller related parameters
-extern unsigned TRANS_QUEUE_DEPTH;
-extern unsigned DEFENCE_QUEUE_DEPTH;
-extern unsigned CMD_QUEUE_DEPTH;
-extern unsigned BANK_PARTITION_CYCLES;
-extern unsigned FIXED_SERVICE_RATE;
-
-extern unsigned EPOCH_LENGTH;
-extern unsigned SINGLE_BANK;
-extern unsigned DEF_CLK_DIV;
-extern float SLACK;
-
-extern unsigned TOTAL_ROW_ACCESSES;
-
-extern std::string ROW_BUFFER_POLICY;
-extern std::string SCHEDULING_POLICY;
-extern std::string ADDRESS_MAPPING_SCHEME;
-extern std::string QUEUING_STRUCTURE;
-extern std::string PROTECTION;
-
-
 enum TraceType
 {
 	k6,
 	mase,
-	misc
+	misc,
+	dom
 };
 
 enum AddressMappingScheme
@@ -202,19 +110,204 @@ enum Protection
 };
 
 
-// set by IniReader.cpp
-
-
 namespace DRAMSim
 {
 typedef void (*returnCallBack_t)(unsigned id, uint64_t addr, uint64_t clockcycle);
 typedef void (*powerCallBack_t)(double bgpower, double burstpower, double refreshpower, double actprepower);
 
-extern RowBufferPolicy rowBufferPolicy;
-extern SchedulingPolicy schedulingPolicy;
-extern AddressMappingScheme addressMappingScheme;
-extern QueuingStructure queuingStructure;
-extern Protection protection;
+// The timing constraints the controller and the ranks apply on every
+// command, worked out once from the device parameters instead of on each use
+struct DerivedTiming
+{
+	unsigned RL;
+	unsigned WL;
+	unsigned BURST_CYCLES; //BL/2
+	unsigned CCD_DELAY; //max(tCCD, BL/2), column to column in a rank
+	unsigned RANK_SWITCH_DELAY; //BL/2+tRTRS, same command to another rank
+
+	//same bank
+	unsigned READ_TO_PRE_DELAY;
+	unsigned WRITE_TO_PRE_DELAY;
+	unsigned READ_TO_WRITE_DELAY;
+	unsigned READ_AUTOPRE_DELAY;
+	unsigned WRITE_AUTOPRE_DELAY;
+	unsigned WRITE_TO_READ_DELAY_B; //interbank
+	unsigned WRITE_TO_READ_DELAY_R; //interrank
+
+	static constexpr DerivedTiming derive(unsigned CL, unsigned AL, unsigned BL, unsigned tRP, unsigned tCCD,
+	                                      unsigned tRTP, unsigned tWTR, unsigned tWR, unsigned tRTRS)
+	{
+		return DerivedTiming {
+			CL+AL,
+			CL+AL-1,
+			BL/2,
+			std::max(tCCD, BL/2),
+			BL/2+tRTRS,
+			AL+BL/2+std::max(tRTP,tCCD)-tCCD,
+			(CL+AL-1)+BL/2+tWR,
+			(CL+AL)+BL/2+tRTRS-(CL+AL-1),
+			AL+tRTP+tRP,
+			(CL+AL-1)+BL/2+tWR+tRP,
+			(CL+AL-1)+BL/2+tWTR,
+			(CL+AL-1)+BL/2+tRTRS-(CL+AL)
+		};
+	}
+};
+
+// Every parameter of one memory system. The values are filled in by an
+// IniReader (plus the rank/storage values MultiChannelMemorySystem derives
+// from them) and then handed to each object as a const reference, so two
+// memory systems in one process can be configured independently.
+//
+// Create it value-initialised (Config config = Config()) so anything the ini
+// files do not set starts out as zero.
+class Config
+{
+public:
+	bool VERIFICATION_OUTPUT; // output suitable to feed to modelsim
+	bool COMMAND_TRACE; // the same commands, in binary (see CommandTrace.h)
+	bool FAST_RANK; // ranks trust the controller's timing and keep no bank states
+
+#ifdef DRAMSIM_NO_DEBUG_FLAGS
+	// make NO_DEBUG_FLAGS=1 compiles every check of these away; the ini
+	// values are still read, into requestedDebug, so they can be warned about
+	static constexpr bool DEBUG_TRANS_Q = false;
+	static constexpr bool DEBUG_CMD_Q = false;
+	static constexpr bool DEBUG_ADDR_MAP = false;
+	static constexpr bool DEBUG_BANKSTATE = false;
+	static constexpr bool DEBUG_BUS = false;
+	static constexpr bool DEBUG_BANKS = false;
+	static constexpr bool DEBUG_POWER = false;
+	static constexpr bool DEBUG_DEFENCE = false;
+	struct
+	{
+		bool DEBUG_TRANS_Q;
+		bool DEBUG_CMD_Q;
+		bool DEBUG_ADDR_MAP;
+		bool DEBUG_BANKSTATE;
+		bool DEBUG_BUS;
+		bool DEBUG_BANKS;
+		bool DEBUG_POWER;
+		bool DEBUG_DEFENCE;
+	} requestedDebug;
+#else
+	bool DEBUG_TRANS_Q;
+	bool DEBUG_CMD_Q;
+	bool DEBUG_ADDR_MAP;
+	bool DEBUG_BANKSTATE;
+	bool DEBUG_BUS;
+	bool DEBUG_BANKS;
+	bool DEBUG_POWER;
+	bool DEBUG_DEFENCE;
+#endif
+	bool USE_LOW_POWER;
+	bool VIS_FILE_OUTPUT;
+
+	uint64_t TOTAL_STORAGE;
+	unsigned NUM_BANKS;
+	unsigned NUM_BANKS_LOG;
+	unsigned NUM_RANKS;
+	unsigned NUM_RANKS_LOG;
+	unsigned NUM_CHANS;
+	unsigned NUM_CHANS_LOG;
+	unsigned NUM_DOMAINS;
+	unsigned NUM_ROWS;
+	unsigned NUM_ROWS_LOG;
+	unsigned NUM_COLS;
+	unsigned NUM_COLS_LOG;
+	unsigned DEVICE_WIDTH;
+	unsigned BYTE_OFFSET_WIDTH;
+	unsigned TRANSACTION_SIZE;
+	unsigned THROW_AWAY_BITS;
+	unsigned COL_LOW_BIT_WIDTH;
+
+	//in nanoseconds
+	unsigned REFRESH_PERIOD;
+	float tCK;
+
+	unsigned CL;
+	unsigned AL;
+	unsigned BL;
+	unsigned tRAS;
+	unsigned tRCD;
+	unsigned tRRD;
+	unsigned tRC;
+	unsigned tRP;
+	unsigned tCCD;
+	unsigned tRTP;
+	unsigned tWTR;
+	unsigned tWR;
+	unsigned tRTRS;
+	unsigned tRFC;
+	unsigned tFAW;
+	unsigned tCKE;
+	unsigned tXP;
+
+	unsigned tCMD;
+
+	//power parameters (current and voltage), only used in MemoryController.cpp
+	unsigned IDD0;
+	unsigned IDD1;
+	unsigned IDD2P;
+	unsigned IDD2Q;
+	unsigned IDD2N;
+	unsigned IDD3Pf;
+	unsigned IDD3Ps;
+	unsigned IDD3N;
+	unsigned IDD4W;
+	unsigned IDD4R;
+	unsigned IDD5;
+	unsigned IDD6;
+	unsigned IDD6L;
+	unsigned IDD7;
+	float Vdd;
+
+	unsigned NUM_DEVICES;
+
+	unsigned JEDEC_DATA_BUS_BITS;
+
+	//Memory Controller related parameters
+	unsigned TRANS_QUEUE_DEPTH;
+	unsigned DEFENCE_QUEUE_DEPTH;
+	unsigned CMD_QUEUE_DEPTH;
+	unsigned BANK_PARTITION_CYCLES;
+	unsigned FIXED_SERVICE_RATE;
+
+	//cycles within an epoch
+	unsigned EPOCH_LENGTH;
+	unsigned SINGLE_BANK;
+	unsigned DEF_CLK_DIV;
+	float SLACK;
+
+	//row accesses allowed before closing (open page)
+	unsigned TOTAL_ROW_ACCESSES;
+
+	// strings and their associated enums
+	std::string ROW_BUFFER_POLICY;
+	std::string SCHEDULING_POLICY;
+	std::string ADDRESS_MAPPING_SCHEME;
+	std::string QUEUING_STRUCTURE;
+	std::string PROTECTION;
+
+	RowBufferPolicy rowBufferPolicy;
+	SchedulingPolicy schedulingPolicy;
+	AddressMappingScheme addressMappingScheme;
+	QueuingStructure queuingStructure;
+	Protection protection;
+
+#ifdef DRAMSIM_DEVICE
+	// built for one device: the derived timing is a compile time constant
+	// and deriveTiming() only checks that the ini file matches it
+	typedef DevicePreset::DRAMSIM_DEVICE Device;
+	static constexpr DerivedTiming timing = DerivedTiming::derive(Device::CL, Device::AL, Device::BL, Device::tRP,
+			Device::tCCD, Device::tRTP, Device::tWTR, Device::tWR, Device::tRTRS);
+#else
+	DerivedTiming timing;
+#endif
+
+	// call once all the device parameters are set
+	void deriveTiming();
+};
 
 //
 //FUNCTIONS
@@ -0,0 +1,139 @@
+/*********************************************************************************
+*  Copyright (c) 2010-2011, Elliott Cooper-Balis
+*                             Paul Rosenfeld
+*                             Bruce Jacob
+*                             University of Maryland 
+*                             dramninjas [at] gmail [dot] com
+*  All rights reserved.
+*  
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*  
+*     * Redistributions of source code must retain the above copyright notice,
+*        this list of conditions and the following disclaimer.
+*  
+*     * Redistributions in binary form must reproduce the above copyright notice,
+*        this list of conditions and the following disclaimer in the documentation
+*        and/or other materials provided with the distribution.
+*  
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+*  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+*  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+*  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************************/
+
+//TimingCheck.cpp
+//
+//Checks a binary command trace (COMMAND_TRACE) against the timing of the
+//device it was recorded on
+//
+
+#include <iostream>
+#include <getopt.h>
+
+#include "SystemConfiguration.h"
+#include "IniReader.h"
+#include "CommandTrace.h"
+#include "TimingChecker.h"
+
+
+using namespace DRAMSim;
+using namespace std;
+
+int SHOW_SIM_OUTPUT = 1;
+
+void usage()
+{
+	cout << "DRAMSimTimingCheck Usage: " << endl;
+	cout << "DRAMSimTimingCheck -d ini/dev.ini -s system.ini [-o key1=val1,key2=val2] [-n 20] trace.ctrace" <<endl;
+	cout << "\t-d, --deviceini=FILENAME \tdevice ini file the trace was recorded with"<<endl;
+	cout << "\t-s, --systemini=FILENAME \tsystem ini file the trace was recorded with"<<endl;
+	cout << "\t-o, --option=OPTION_A=234,tFAW=14\tthe overrides the trace was recorded with"<<endl;
+	cout << "\t-n, --reports=NUM \t\tprint the first NUM violations in full (default 20)"<<endl;
+	cout << "Exits with 1 if the trace breaks any of tRCD/tRAS/tRP/tRC/tRRD/tFAW/tCCD/tWTR/tRTW/tRTP/tWR/tRFC/tREFI"<<endl;
+}
+
+int main(int argc, char **argv)
+{
+	int c;
+	string deviceIniFilename;
+	string systemIniFilename;
+	IniReader::OverrideMap paramOverrides;
+	uint64_t maxReports = 20;
+
+	while (1)
+	{
+		static struct option long_options[] =
+		{
+			{"deviceini", required_argument, 0, 'd'},
+			{"systemini", required_argument, 0, 's'},
+			{"option", required_argument, 0, 'o'},
+			{"reports", required_argument, 0, 'n'},
+			{"help", no_argument, 0, 'h'},
+			{0, 0, 0, 0}
+		};
+		int option_index=0; //for getopt
+		c = getopt_long (argc, argv, "d:s:o:n:h", long_options, &option_index);
+		if (c == -1)
+		{
+			break;
+		}
+		switch (c)
+		{
+		case 'h':
+			usage();
+			exit(0);
+			break;
+		case 'd':
+			deviceIniFilename = string(optarg);
+			break;
+		case 's':
+			systemIniFilename = string(optarg);
+			break;
+		case 'o':
+			IniReader::ParseOverrides(string(optarg), paramOverrides);
+			break;
+		case 'n':
+			maxReports = strtoull(optarg, NULL, 10);
+			break;
+		case '?':
+			usage();
+			exit(-1);
+			break;
+		}
+	}
+
+	if (optind != argc - 1 || deviceIniFilename.length() == 0 || systemIniFilename.length() == 0)
+	{
+		usage();
+		exit(-1);
+	}
+
+	Config config = Config();
+	IniReader iniReader(config);
+	iniReader.ReadIniFile(deviceIniFilename, false);
+	iniReader.ReadIniFile(systemIniFilename, true);
+	iniReader.OverrideKeys(&paramOverrides);
+	iniReader.InitEnumsFromStrings();
+	if (!iniReader.CheckIfAllSet())
+	{
+		exit(-1);
+	}
+	config.deriveTiming();
+
+	CommandTraceReader reader(argv[optind]);
+	TimingChecker checker(config, cout, maxReports);
+	CommandTraceEntry entry;
+	while (reader.next(entry))
+	{
+		checker.check(entry);
+	}
+	checker.finish();
+	return checker.numViolations() > 0 ? 1 : 0;
+}
@@ -0,0 +1,312 @@
+/*********************************************************************************
+*  Copyright (c) 2010-2011, Elliott Cooper-Balis
+*                             Paul Rosenfeld
+*                             Bruce Jacob
+*                             University of Maryland 
+*                             dramninjas [at] gmail [dot] com
+*  All rights reserved.
+*  
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*  
+*     * Redistributions of source code must retain the above copyright notice,
+*        this list of conditions and the following disclaimer.
+*  
+*     * Redistributions in binary form must reproduce the above copyright notice,
+*        this list of conditions and the following disclaimer in the documentation
+*        and/or other materials provided with the distribution.
+*  
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+*  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+*  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+*  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************************/
+
+//TimingChecker.cpp
+//
+//The rules are the ones Rank::receiveFromBus enforces, with tFAW and the
+//refresh interval on top, which only the controller looks after
+//
+
+#include "TimingChecker.h"
+#include "PrintMacros.h"
+
+using namespace DRAMSim;
+using namespace std;
+
+// JEDEC lets a controller put off up to 8 refreshes
+#define MAX_POSTPONED_REFRESHES 8
+
+TimingChecker::TimingChecker(const Config &config_, ostream &out_, uint64_t maxReports_) :
+	numCommands(0),
+	config(config_),
+	out(out_),
+	maxReports(maxReports_),
+	refreshInterval(config_.REFRESH_PERIOD/config_.tCK),
+	lastCycle(0),
+	totalViolations(0)
+{
+	for (size_t i=0;i<NUM_TIMING_RULES;i++)
+	{
+		violations[i] = 0;
+	}
+}
+
+const char *TimingChecker::ruleName(TimingRule rule)
+{
+	switch (rule)
+	{
+	case RULE_STATE: return "bank state";
+	case RULE_tRCD: return "tRCD";
+	case RULE_tRAS: return "tRAS";
+	case RULE_tRP: return "tRP";
+	case RULE_tRC: return "tRC";
+	case RULE_tRRD: return "tRRD";
+	case RULE_tFAW: return "tFAW";
+	case RULE_tCCD: return "tCCD";
+	case RULE_tWTR: return "tWTR";
+	case RULE_tRTW: return "tRTW";
+	case RULE_tRTP: return "tRTP";
+	case RULE_tWR: return "tWR";
+	case RULE_tRFC: return "tRFC";
+	case RULE_tREFI: return "tREFI";
+	case NUM_TIMING_RULES: break;
+	}
+	return "?";
+}
+
+RankTiming &TimingChecker::rankTiming(unsigned channel, unsigned rank, uint64_t cycle)
+{
+	if (channel >= ranks.size())
+	{
+		ranks.resize(channel+1);
+	}
+	if (rank >= ranks[channel].size())
+	{
+		ranks[channel].resize(rank+1);
+	}
+	RankTiming &rankTiming = ranks[channel][rank];
+	if (rankTiming.banks.empty())
+	{
+		rankTiming.banks.assign(config.NUM_BANKS, BankTiming());
+		for (size_t i=0;i<NUM_TIMING_RULES;i++)
+		{
+			rankTiming.read[i] = 0;
+			rankTiming.write[i] = 0;
+		}
+		rankTiming.lastRefresh = cycle;
+	}
+	return rankTiming;
+}
+
+void TimingChecker::later(uint64_t &next, uint64_t at)
+{
+	next = max(next, at);
+}
+
+void TimingChecker::require(const CommandTraceEntry &entry, TimingRule rule, uint64_t allowedAt)
+{
+	if (entry.cycle < allowedAt)
+	{
+		violation(entry, rule, allowedAt);
+	}
+}
+
+void TimingChecker::violation(const CommandTraceEntry &entry, TimingRule rule, uint64_t allowedAt)
+{
+	violations[rule]++;
+	totalViolations++;
+	if (totalViolations > maxReports)
+	{
+		return;
+	}
+	out << "channel " << entry.channel << (entry.isFake ? " (fake) " : " ");
+	BusPacket::printVerification(out, entry.cycle, entry.type, entry.rank, entry.bank, entry.row, entry.column);
+	out << "\tbreaks " << ruleName(rule);
+	if (rule != RULE_STATE)
+	{
+		out << ", allowed from cycle " << allowedAt;
+	}
+	out << endl;
+}
+
+void TimingChecker::missedRefresh(unsigned channel, unsigned rank, uint64_t from, uint64_t to)
+{
+	violations[RULE_tREFI]++;
+	totalViolations++;
+	if (totalViolations > maxReports)
+	{
+		return;
+	}
+	out << "cycle " << to << ": channel " << channel << " rank " << rank << " breaks tREFI, no REF since cycle " << from << endl;
+}
+
+void TimingChecker::check(const CommandTraceEntry &entry)
+{
+	numCommands++;
+	lastCycle = entry.cycle;
+	RankTiming &rank = rankTiming(entry.channel, entry.rank, entry.cycle);
+	if (entry.bank >= rank.banks.size())
+	{
+		ERROR("== Error - command to bank "<<entry.bank<<" at cycle "<<entry.cycle<<", the device has "<<config.NUM_BANKS);
+		exit(-1);
+	}
+	BankTiming &bank = rank.banks[entry.bank];
+	uint64_t cycle = entry.cycle;
+
+	switch (entry.type)
+	{
+	case READ:
+	case READ_P:
+		if (bank.state != RowActive || bank.openRow != entry.row)
+		{
+			violation(entry, RULE_STATE, 0);
+		}
+		require(entry, RULE_tRCD, bank.column);
+		require(entry, RULE_tCCD, rank.read[RULE_tCCD]);
+		require(entry, RULE_tWTR, rank.read[RULE_tWTR]);
+
+		later(rank.read[RULE_tCCD], cycle + config.timing.CCD_DELAY);
+		later(rank.write[RULE_tRTW], cycle + config.timing.READ_TO_WRITE_DELAY);
+		if (entry.type == READ_P)
+		{
+			bank.state = Idle;
+			later(bank.activate[RULE_tRP], cycle + config.timing.READ_AUTOPRE_DELAY);
+		}
+		else
+		{
+			later(bank.precharge[RULE_tRTP], cycle + config.timing.READ_TO_PRE_DELAY);
+		}
+		break;
+	case WRITE:
+	case WRITE_P:
+		if (bank.state != RowActive || bank.openRow != entry.row)
+		{
+			violation(entry, RULE_STATE, 0);
+		}
+		require(entry, RULE_tRCD, bank.column);
+		require(entry, RULE_tCCD, rank.write[RULE_tCCD]);
+		require(entry, RULE_tRTW, rank.write[RULE_tRTW]);
+
+		later(rank.write[RULE_tCCD], cycle + config.timing.CCD_DELAY);
+		later(rank.read[RULE_tWTR], cycle + config.timing.WRITE_TO_READ_DELAY_B);
+		if (entry.type == WRITE_P)
+		{
+			bank.state = Idle;
+			later(bank.activate[RULE_tRP], cycle + config.timing.WRITE_AUTOPRE_DELAY);
+		}
+		else
+		{
+			later(bank.precharge[RULE_tWR], cycle + config.timing.WRITE_TO_PRE_DELAY);
+		}
+		break;
+	case ACTIVATE:
+		if (bank.state != Idle)
+		{
+			violation(entry, RULE_STATE, 0);
+		}
+		require(entry, RULE_tRP, bank.activate[RULE_tRP]);
+		require(entry, RULE_tRC, bank.activate[RULE_tRC]);
+		require(entry, RULE_tRRD, bank.activate[RULE_tRRD]);
+		require(entry, RULE_tRFC, bank.activate[RULE_tRFC]);
+		if (rank.activates.size() == 4)
+		{
+			require(entry, RULE_tFAW, rank.activates.front() + config.tFAW);
+			rank.activates.pop_front();
+		}
+		rank.activates.push_back(cycle);
+
+		bank.state = RowActive;
+		bank.openRow = entry.row;
+		bank.activate[RULE_tRC] = cycle + config.tRC;
+		bank.column = cycle + config.tRCD - config.AL;
+		bank.precharge[RULE_tRAS] = cycle + config.tRAS;
+		for (size_t i=0;i<rank.banks.size();i++)
+		{
+			if (i != entry.bank)
+			{
+				later(rank.banks[i].activate[RULE_tRRD], cycle + config.tRRD);
+			}
+		}
+		break;
+	case PRECHARGE:
+		if (bank.state != RowActive)
+		{
+			violation(entry, RULE_STATE, 0);
+		}
+		require(entry, RULE_tRAS, bank.precharge[RULE_tRAS]);
+		require(entry, RULE_tRTP, bank.precharge[RULE_tRTP]);
+		require(entry, RULE_tWR, bank.precharge[RULE_tWR]);
+
+		bank.state = Idle;
+		later(bank.activate[RULE_tRP], cycle + config.tRP);
+		break;
+	case REFRESH:
+		for (size_t i=0;i<rank.banks.size();i++)
+		{
+			if (rank.banks[i].state != Idle)
+			{
+				violation(entry, RULE_STATE, 0);
+				break;
+			}
+		}
+		for (size_t i=0;i<rank.banks.size();i++)
+		{
+			require(entry, RULE_tRP, rank.banks[i].activate[RULE_tRP]);
+			require(entry, RULE_tRFC, rank.banks[i].activate[RULE_tRFC]);
+		}
+		if (cycle - rank.lastRefresh > (MAX_POSTPONED_REFRESHES+1) * refreshInterval)
+		{
+			missedRefresh(entry.channel, entry.rank, rank.lastRefresh, cycle);
+		}
+		rank.lastRefresh = cycle;
+		for (size_t i=0;i<rank.banks.size();i++)
+		{
+			rank.banks[i].state = Idle;
+			rank.banks[i].activate[RULE_tRFC] = cycle + config.tRFC;
+		}
+		break;
+	default:
+		violation(entry, RULE_STATE, 0);
+		break;
+	}
+}
+
+void TimingChecker::finish()
+{
+	for (size_t channel=0;channel<ranks.size();channel++)
+	{
+		for (size_t rank=0;rank<ranks[channel].size();rank++)
+		{
+			const RankTiming &rankTiming = ranks[channel][rank];
+			if (!rankTiming.banks.empty() && lastCycle - rankTiming.lastRefresh > (MAX_POSTPONED_REFRESHES+1) * refreshInterval)
+			{
+				missedRefresh(channel, rank, rankTiming.lastRefresh, lastCycle);
+			}
+		}
+	}
+
+	if (totalViolations > maxReports)
+	{
+		out << "(" << totalViolations - maxReports << " more not shown)" << endl;
+	}
+	out << numCommands << " commands checked, " << totalViolations << " timing violations" << endl;
+	for (size_t i=0;i<NUM_TIMING_RULES;i++)
+	{
+		if (violations[i] > 0)
+		{
+			out << "\t" << ruleName((TimingRule)i) << ": " << violations[i] << endl;
+		}
+	}
+}
+
+uint64_t TimingChecker::numViolations() const
+{
+	return totalViolations;
+}
@@ -0,0 +1,120 @@
+/*********************************************************************************
+*  Copyright (c) 2010-2011, Elliott Cooper-Balis
+*                             Paul Rosenfeld
+*                             Bruce Jacob
+*                             University of Maryland 
+*                             dramninjas [at] gmail [dot] com
+*  All rights reserved.
+*  
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*  
+*     * Redistributions of source code must retain the above copyright notice,
+*        this list of conditions and the following disclaimer.
+*  
+*     * Redistributions in binary form must reproduce the above copyright notice,
+*        this list of conditions and the following disclaimer in the documentation
+*        and/or other materials provided with the distribution.
+*  
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+*  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+*  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+*  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************************/
+#ifndef TIMINGCHECKER_H
+#define TIMINGCHECKER_H
+
+//TimingChecker.h
+//
+//Replays a recorded command trace (COMMAND_TRACE) against the device timing
+//and counts every command that breaks a JEDEC constraint
+//
+
+#include <stdint.h>
+#include <vector>
+#include <deque>
+#include <iostream>
+
+#include "SystemConfiguration.h"
+#include "BankState.h"
+#include "CommandTrace.h"
+
+namespace DRAMSim
+{
+enum TimingRule
+{
+	RULE_STATE, //command to a bank in the wrong state or to another row
+	RULE_tRCD,
+	RULE_tRAS,
+	RULE_tRP,
+	RULE_tRC,
+	RULE_tRRD,
+	RULE_tFAW,
+	RULE_tCCD,
+	RULE_tWTR,
+	RULE_tRTW,
+	RULE_tRTP,
+	RULE_tWR,
+	RULE_tRFC,
+	RULE_tREFI, //more than 8 refreshes postponed
+	NUM_TIMING_RULES
+};
+
+// Each field is the first cycle the command is allowed at, kept apart per
+// constraint so a violation can be put down to the one it breaks
+struct BankTiming
+{
+	CurrentBankState state;
+	unsigned openRow;
+	uint64_t activate[NUM_TIMING_RULES]; //by tRP, tRC, tRRD, tRFC
+	uint64_t column; //by tRCD
+	uint64_t precharge[NUM_TIMING_RULES]; //by tRAS, tRTP, tWR
+};
+
+struct RankTiming
+{
+	std::vector<BankTiming> banks;
+	std::deque<uint64_t> activates; //the last four, for tFAW
+	uint64_t read[NUM_TIMING_RULES]; //by tCCD, tWTR
+	uint64_t write[NUM_TIMING_RULES]; //by tCCD, tRTW
+	uint64_t lastRefresh; //or the first command, before there is one
+};
+
+class TimingChecker
+{
+public:
+	// prints the first maxReports violations in full, and only counts the rest
+	TimingChecker(const Config &config, std::ostream &out, uint64_t maxReports);
+	void check(const CommandTraceEntry &entry);
+	// the refresh interval check for the end of the trace, and the summary
+	void finish();
+	uint64_t numViolations() const;
+	uint64_t numCommands;
+
+	static const char *ruleName(TimingRule rule);
+
+private:
+	RankTiming &rankTiming(unsigned channel, unsigned rank, uint64_t cycle);
+	void require(const CommandTraceEntry &entry, TimingRule rule, uint64_t allowedAt);
+	void violation(const CommandTraceEntry &entry, TimingRule rule, uint64_t allowedAt);
+	void missedRefresh(unsigned channel, unsigned rank, uint64_t from, uint64_t to);
+	void later(uint64_t &next, uint64_t at);
+
+	const Config &config;
+	std::ostream &out;
+	uint64_t maxReports;
+	uint64_t refreshInterval; //tREFI in cycles
+	uint64_t lastCycle;
+	std::vector<std::vector<RankTiming> > ranks; //[channel][rank]
+	uint64_t violations[NUM_TIMING_RULES];
+	uint64_t totalViolations;
+};
+}
+
+#endif
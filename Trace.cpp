@@ -0,0 +1,857 @@
+/*********************************************************************************
+*  Copyright (c) 2010-2011, Elliott Cooper-Balis
+*                             Paul Rosenfeld
+*                             Bruce Jacob
+*                             University of Maryland 
+*                             dramninjas [at] gmail [dot] com
+*  All rights reserved.
+*  
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*  
+*     * Redistributions of source code must retain the above copyright notice,
+*        this list of conditions and the following disclaimer.
+*  
+*     * Redistributions in binary form must reproduce the above copyright notice,
+*        this list of conditions and the following disclaimer in the documentation
+*        and/or other materials provided with the distribution.
+*  
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+*  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+*  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+*  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************************/
+
+//Trace.cpp
+//
+//Trace file parsing and replay
+//
+
+#include <sstream>
+
+#include "Trace.h"
+#include "MultiChannelMemorySystem.h"
+#include "FunctionalModel.h"
+
+using namespace std;
+
+namespace DRAMSim
+{
+
+// the trace format comes from the prefix of the file name (mase_foo.trc)
+bool traceTypeFromFilename(const string &filename, TraceType &type)
+{
+	string temp = filename.substr(filename.find_last_of("/")+1);
+
+	//get the prefix of the trace name
+	temp = temp.substr(0,temp.find_first_of("_"));
+	if (temp=="mase")
+	{
+		type = mase;
+	}
+	else if (temp=="k6")
+	{
+		type = k6;
+	}
+	else if (temp=="misc")
+	{
+		type = misc;
+	}
+	else if (temp=="dom")
+	{
+		type = dom;
+	}
+	else
+	{
+		return false;
+	}
+	return true;
+}
+
+static bool parseControlRecord(string &line, TraceRecord &record, bool useClockCycle)
+{
+	istringstream iss(line);
+	string keyword, kind;
+	uint64_t cycle = 0;
+
+	iss >> keyword;
+	if (keyword == "START")
+	{
+		record.type = TRACE_START_DEFENCE;
+		iss >> cycle >> record.args[0] >> record.args[1] >> record.args[2];
+	}
+	else if (keyword == "UPDATE")
+	{
+		record.type = TRACE_UPDATE_DEFENCE;
+		iss >> cycle >> record.args[0] >> record.args[1] >> kind;
+		if (kind != "data" && kind != "inst")
+		{
+			ERROR("UPDATE record needs 'data' or 'inst', got '"<<kind<<"'");
+			exit(-1);
+		}
+		record.isData = (kind == "data");
+	}
+	else if (keyword == "END")
+	{
+		record.type = TRACE_END_DEFENCE;
+		iss >> cycle;
+	}
+	else
+	{
+		return false;
+	}
+
+	if (iss.fail())
+	{
+		ERROR("Malformed control record: '"<< line <<"'");
+		exit(-1);
+	}
+
+	if (useClockCycle)
+	{
+		record.clockCycle = cycle;
+	}
+	return true;
+}
+
+static void *parseTraceFileLine(string &line, uint64_t &addr, enum TransactionType &transType, uint64_t &clockCycle, uint64_t &securityDomain, TraceType type, bool useClockCycle)
+{
+	size_t previousIndex=0;
+	size_t spaceIndex=0;
+	uint64_t *dataBuffer = NULL;
+	string addressStr="", cmdStr="", dataStr="", ccStr="";
+
+	switch (type)
+	{
+	case k6:
+	{
+		spaceIndex = line.find_first_of(" ", 0);
+
+		addressStr = line.substr(0, spaceIndex);
+		previousIndex = spaceIndex;
+
+		spaceIndex = line.find_first_not_of(" ", previousIndex);
+		cmdStr = line.substr(spaceIndex, line.find_first_of(" ", spaceIndex) - spaceIndex);
+		previousIndex = line.find_first_of(" ", spaceIndex);
+
+		spaceIndex = line.find_first_not_of(" ", previousIndex);
+		ccStr = line.substr(spaceIndex, line.find_first_of(" ", spaceIndex) - spaceIndex);
+
+		if (cmdStr.compare("P_MEM_WR")==0 ||
+		        cmdStr.compare("BOFF")==0)
+		{
+			transType = DATA_WRITE;
+		}
+		else if (cmdStr.compare("P_FETCH")==0 ||
+		         cmdStr.compare("P_MEM_RD")==0 ||
+		         cmdStr.compare("P_LOCK_RD")==0 ||
+		         cmdStr.compare("P_LOCK_WR")==0)
+		{
+			transType = DATA_READ;
+		}
+		else
+		{
+			ERROR("== Unknown Command : "<<cmdStr);
+			exit(0);
+		}
+
+		istringstream a(addressStr.substr(2));//gets rid of 0x
+		a>>hex>>addr;
+
+		//if this is set to false, clockCycle will remain at 0, and every line read from the trace
+		//  will be allowed to be issued
+		if (useClockCycle)
+		{
+			istringstream b(ccStr);
+			b>>clockCycle;
+		}
+		break;
+	}
+	case mase:
+	{
+		spaceIndex = line.find_first_of(" ", 0);
+
+		addressStr = line.substr(0, spaceIndex);
+		previousIndex = spaceIndex;
+
+		spaceIndex = line.find_first_not_of(" ", previousIndex);
+		cmdStr = line.substr(spaceIndex, line.find_first_of(" ", spaceIndex) - spaceIndex);
+		previousIndex = line.find_first_of(" ", spaceIndex);
+
+		spaceIndex = line.find_first_not_of(" ", previousIndex);
+		ccStr = line.substr(spaceIndex, line.find_first_of(" ", spaceIndex) - spaceIndex);
+
+		if (cmdStr.compare("IFETCH")==0||
+		        cmdStr.compare("READ")==0)
+		{
+			transType = DATA_READ;
+		}
+		else if (cmdStr.compare("WRITE")==0)
+		{
+			transType = DATA_WRITE;
+		}
+		else
+		{
+			ERROR("== Unknown command in tracefile : "<<cmdStr);
+		}
+
+		istringstream a(addressStr.substr(2));//gets rid of 0x
+		a>>hex>>addr;
+
+		//if this is set to false, clockCycle will remain at 0, and every line read from the trace
+		//  will be allowed to be issued
+		if (useClockCycle)
+		{
+			istringstream b(ccStr);
+			b>>clockCycle;
+		}
+
+		break;
+	}
+	case dom:
+	{
+		// same layout as mase with a trailing security domain column
+		istringstream iss(line);
+		iss >> addressStr >> cmdStr >> ccStr >> securityDomain;
+		if (iss.fail())
+		{
+			ERROR("Malformed line: '"<< line <<"'");
+			exit(-1);
+		}
+
+		if (cmdStr.compare("IFETCH")==0||
+		        cmdStr.compare("READ")==0)
+		{
+			transType = DATA_READ;
+		}
+		else if (cmdStr.compare("WRITE")==0)
+		{
+			transType = DATA_WRITE;
+		}
+		else
+		{
+			ERROR("== Unknown command in tracefile : "<<cmdStr);
+			exit(-1);
+		}
+
+		istringstream a(addressStr.substr(2));//gets rid of 0x
+		a>>hex>>addr;
+
+		if (useClockCycle)
+		{
+			istringstream b(ccStr);
+			b>>clockCycle;
+		}
+		break;
+	}
+	case misc:
+		spaceIndex = line.find_first_of(" ", spaceIndex+1);
+		if (spaceIndex == string::npos)
+		{
+			ERROR("Malformed line: '"<< line <<"'");
+		}
+
+		addressStr = line.substr(previousIndex,spaceIndex);
+		previousIndex=spaceIndex;
+
+		spaceIndex = line.find_first_of(" ", spaceIndex+1);
+		if (spaceIndex == string::npos)
+		{
+			cmdStr = line.substr(previousIndex+1);
+		}
+		else
+		{
+			cmdStr = line.substr(previousIndex+1,spaceIndex-previousIndex-1);
+			dataStr = line.substr(spaceIndex+1);
+		}
+
+		//convert address string -> number
+		istringstream b(addressStr.substr(2)); //substr(2) chops off 0x characters
+		b >>hex>> addr;
+
+		// parse command
+		if (cmdStr.compare("read") == 0)
+		{
+			transType=DATA_READ;
+		}
+		else if (cmdStr.compare("write") == 0)
+		{
+			transType=DATA_WRITE;
+		}
+		else
+		{
+			ERROR("INVALID COMMAND '"<<cmdStr<<"'");
+			exit(-1);
+		}
+		if (SHOW_SIM_OUTPUT)
+		{
+			DEBUGN("ADDR='"<<hex<<addr<<dec<<"',CMD='"<<transType<<"'");//',DATA='"<<dataBuffer[0]<<"'");
+		}
+
+		//parse data
+		//if we are running in a no storage mode, don't allocate space, just return NULL
+#ifndef NO_STORAGE
+		if (dataStr.size() > 0 && transType == DATA_WRITE)
+		{
+			// 32 bytes of data per transaction, in a buffer as big as the
+			// largest transaction of the devices shipped (BL8 on a 64 bit
+			// bus), as that much is what a bank stores for a write
+			dataBuffer = (uint64_t *)calloc(sizeof(uint64_t),8);
+			size_t strlen = dataStr.size();
+			for (int i=0; i < 4; i++)
+			{
+				size_t startIndex = i*16;
+				if (startIndex > strlen)
+				{
+					break;
+				}
+				size_t charsLeft = min(((size_t)16), strlen - startIndex + 1);
+				string piece = dataStr.substr(i*16,charsLeft);
+				istringstream iss(piece);
+				iss >> hex >> dataBuffer[i];
+			}
+			PRINTN("\tDATA='"<<hex);
+			for (int i=0; i < 4; i++)
+			{
+				PRINTN(dataBuffer[i]);
+			}
+			PRINTN("'"<<dec);
+		}
+
+		PRINT("");
+#endif
+		break;
+	}
+	return dataBuffer;
+}
+
+/**
+ * Parses one non-empty trace line into record. Anything the line does not
+ * carry (e.g. the cycle of a misc line, or any cycle when useClockCycle is
+ * false) keeps the value it had in record, so callers should reuse one
+ * record for consecutive lines.
+ */
+void parseTraceRecord(string &line, TraceType type, bool useClockCycle, TraceRecord &record)
+{
+	if (type == dom && parseControlRecord(line, record, useClockCycle))
+	{
+		return;
+	}
+
+	// untagged traces don't belong to any defence domain
+	record.securityDomain = -1;
+	record.type = TRACE_REQUEST;
+	record.data = parseTraceFileLine(line, record.address, record.transType, record.clockCycle, record.securityDomain, type, useClockCycle);
+}
+
+void writeBinaryTraceHeader(ostream &out)
+{
+	out.write(BINARY_TRACE_MAGIC, sizeof(BINARY_TRACE_MAGIC));
+}
+
+void writeBinaryTraceRecord(CheckpointOut &cp, const TraceRecord &record)
+{
+	cp.put(record.type);
+	cp.put(record.clockCycle);
+	if (record.type == TRACE_REQUEST)
+	{
+		cp.put(record.transType);
+		cp.put(record.address);
+		cp.put(record.securityDomain);
+	}
+	else
+	{
+		cp.put(record.args);
+		cp.put(record.isData);
+	}
+}
+
+TraceFileSource::TraceFileSource(const string &filename, TraceType type, bool useClockCycle_) :
+	binaryIn(traceFile),
+	traceType(type),
+	useClockCycle(useClockCycle_),
+	binary(false),
+	lineNumber(0),
+	startCycle(0)
+{
+	traceFile.open(filename.c_str(), ios::binary);
+
+	if (!traceFile.is_open())
+	{
+		cout << "== Error - Could not open trace file"<<endl;
+		exit(0);
+	}
+
+	char magic[sizeof(BINARY_TRACE_MAGIC)] = "";
+	traceFile.read(magic, sizeof(magic));
+	binary = traceFile.gcount() == sizeof(magic) && string(magic, sizeof(magic)) == string(BINARY_TRACE_MAGIC, sizeof(magic));
+	if (!binary)
+	{
+		traceFile.clear();
+		traceFile.seekg(0);
+	}
+}
+
+TraceFileSource::~TraceFileSource()
+{
+	traceFile.close();
+}
+
+bool TraceFileSource::readRecord(TraceRecord &record)
+{
+	if (binary)
+	{
+		if (traceFile.peek() == EOF)
+		{
+			return false;
+		}
+		uint64_t cycle;
+		binaryIn.get(record.type);
+		binaryIn.get(cycle);
+		if (record.type == TRACE_REQUEST)
+		{
+			binaryIn.get(record.transType);
+			binaryIn.get(record.address);
+			binaryIn.get(record.securityDomain);
+			record.data = NULL;
+		}
+		else
+		{
+			binaryIn.get(record.args);
+			binaryIn.get(record.isData);
+		}
+		// same as a text trace, the cycle stays put without timing
+		if (useClockCycle)
+		{
+			record.clockCycle = cycle;
+		}
+		if (!binaryIn.good())
+		{
+			ERROR("== Error - Truncated binary trace");
+			exit(-1);
+		}
+		return true;
+	}
+
+	string line;
+	while (!traceFile.eof())
+	{
+		getline(traceFile, line);
+		lineNumber++;
+		if (line.size() > 0)
+		{
+			parseTraceRecord(line, traceType, useClockCycle, record);
+			return true;
+		}
+		DEBUG("WARNING: Skipping line "<<lineNumber-1<< " ('" << line << "') in tracefile");
+	}
+	return false;
+}
+
+bool TraceFileSource::next(TraceRecord &record)
+{
+	if (!pendingControl.empty())
+	{
+		record = pendingControl.front();
+		pendingControl.pop_front();
+		return true;
+	}
+
+	while (readRecord(record))
+	{
+		if (record.type == TRACE_REQUEST && record.clockCycle < startCycle)
+		{
+			if (record.data != NULL)
+			{
+				free(record.data);
+				record.data = NULL;
+			}
+			continue;
+		}
+		return true;
+	}
+	return false;
+}
+
+uint64_t TraceFileSource::tell()
+{
+	return traceFile.tellg();
+}
+
+void TraceFileSource::skipTo(uint64_t startCycle_, const TraceIndex *index)
+{
+	startCycle = startCycle_;
+	const TraceIndexEntry *entry = index ? index->find(startCycle) : NULL;
+	if (entry == NULL)
+	{
+		return;
+	}
+
+	for (size_t i=0; i<index->controlRecords.size() && index->controlRecords[i].record < entry->record; i++)
+	{
+		TraceRecord record = TraceRecord();
+		traceFile.clear();
+		traceFile.seekg(index->controlRecords[i].offset);
+		readRecord(record);
+		pendingControl.push_back(record);
+	}
+	traceFile.clear();
+	traceFile.seekg(entry->offset);
+}
+
+TraceIndex::TraceIndex() :
+	traceSize(0),
+	stride(0)
+{}
+
+string traceIndexFilename(const string &traceFilename)
+{
+	return traceFilename + ".idx";
+}
+
+static uint64_t fileSize(const string &filename)
+{
+	ifstream file(filename.c_str(), ios::binary | ios::ate);
+	return file.is_open() ? (uint64_t)file.tellg() : 0;
+}
+
+void TraceIndex::build(const string &traceFilename, TraceType type, unsigned stride_)
+{
+	TraceFileSource source(traceFilename, type, true);
+	TraceRecord record = TraceRecord();
+
+	stride = stride_;
+	traceSize = fileSize(traceFilename);
+	entries.clear();
+	controlRecords.clear();
+
+	TraceIndexEntry entry;
+	entry.offset = source.tell();
+	for (entry.record=0; source.next(record); entry.record++)
+	{
+		entry.clockCycle = record.clockCycle;
+		if (record.type != TRACE_REQUEST)
+		{
+			controlRecords.push_back(entry);
+		}
+		if (entry.record % stride == 0)
+		{
+			entries.push_back(entry);
+		}
+		if (record.type == TRACE_REQUEST && record.data != NULL)
+		{
+			free(record.data);
+			record.data = NULL;
+		}
+		entry.offset = source.tell();
+	}
+}
+
+bool TraceIndex::save(const string &filename) const
+{
+	ofstream indexFile(filename.c_str(), ios::binary);
+	CheckpointOut cp(indexFile);
+	cp.put(string("DRAMSim2 trace index"));
+	cp.put(traceSize);
+	cp.put(stride);
+	cp.put(entries);
+	cp.put(controlRecords);
+	return indexFile.is_open() && cp.good();
+}
+
+bool TraceIndex::load(const string &filename, const string &traceFilename)
+{
+	ifstream indexFile(filename.c_str(), ios::binary);
+	if (!indexFile.is_open())
+	{
+		return false;
+	}
+	CheckpointIn cp(indexFile);
+	string magic;
+	cp.get(magic);
+	if (magic != "DRAMSim2 trace index")
+	{
+		ERROR("== Error - "<<filename<<" is not a trace index");
+		return false;
+	}
+	cp.get(traceSize);
+	if (traceSize != fileSize(traceFilename))
+	{
+		ERROR("== Error - "<<filename<<" is out of date, rebuild it with DRAMSimTraceIndex");
+		return false;
+	}
+	cp.get(stride);
+	cp.get(entries);
+	cp.get(controlRecords);
+	return cp.good();
+}
+
+const TraceIndexEntry *TraceIndex::find(uint64_t clockCycle) const
+{
+	// records are in cycle order, so the entries are too
+	size_t lo = 0, hi = entries.size();
+	while (lo < hi)
+	{
+		size_t mid = (lo + hi) / 2;
+		if (entries[mid].clockCycle < clockCycle)
+		{
+			lo = mid + 1;
+		}
+		else
+		{
+			hi = mid;
+		}
+	}
+	return lo == 0 ? NULL : &entries[lo-1];
+}
+
+TraceVectorSource::TraceVectorSource(const vector<TraceRecord> &records_, uint64_t startCycle_) :
+	records(records_),
+	position(0),
+	startCycle(startCycle_)
+{}
+
+bool TraceVectorSource::next(TraceRecord &record)
+{
+	while (position < records.size() && records[position].type == TRACE_REQUEST &&
+	       records[position].clockCycle < startCycle)
+	{
+		position++;
+	}
+	if (position == records.size())
+	{
+		return false;
+	}
+	record = records[position++];
+	return true;
+}
+
+void loadTrace(const string &filename, TraceType type, bool useClockCycle, vector<TraceRecord> &records)
+{
+	TraceFileSource source(filename, type, useClockCycle);
+	TraceRecord record = TraceRecord();
+
+	while (source.next(record))
+	{
+		if (record.type == TRACE_REQUEST && record.data != NULL)
+		{
+			free(record.data);
+			record.data = NULL;
+		}
+		records.push_back(record);
+	}
+}
+
+TracePlayer::TracePlayer(MultiChannelMemorySystem *memorySystem_, TraceSource &source_) :
+	accepted(NULL),
+	memorySystem(memorySystem_),
+	source(source_),
+	record(TraceRecord()),
+	trans(NULL),
+	recordsRead(0),
+	pendingTrans(false),
+	pendingControl(false)
+{}
+
+TracePlayer::~TracePlayer()
+{
+	// make valgrind happy
+	if (trans)
+	{
+		delete trans;
+	}
+}
+
+void TracePlayer::applyControlRecord()
+{
+	switch (record.type)
+	{
+	case TRACE_START_DEFENCE:
+		memorySystem->startDefence(record.args[0], record.args[1], record.args[2]);
+		break;
+	case TRACE_UPDATE_DEFENCE:
+		memorySystem->updateDefence(record.args[0], record.args[1], record.isData);
+		break;
+	case TRACE_END_DEFENCE:
+		memorySystem->endDefence();
+		break;
+	default:
+		break;
+	}
+}
+
+void TracePlayer::makeTransaction()
+{
+	trans = new Transaction(record.transType, record.address, record.data, record.securityDomain, -1, false, -1);
+
+	// zero out the low order bits which correspond to the size of a transaction
+	unsigned throwAwayBits = memorySystem->getConfig().THROW_AWAY_BITS;
+	trans->address >>= throwAwayBits;
+	trans->address <<= throwAwayBits;
+}
+
+bool TracePlayer::issue()
+{
+	if (!memorySystem->addTransaction(trans))
+	{
+		return false;
+	}
+	// the memory system accepted our request so now it takes ownership of it
+	accepted = trans;
+	trans = NULL;
+	return true;
+}
+
+void TracePlayer::update(uint64_t currentClockCycle)
+{
+	accepted = NULL;
+
+	if (pendingControl)
+	{
+		if (currentClockCycle >= record.clockCycle)
+		{
+			applyControlRecord();
+			pendingControl = false;
+		}
+	}
+	else if (!pendingTrans)
+	{
+		//once we're out of trace this just lets the memory system spin
+		if (source.next(record))
+		{
+			recordsRead++;
+			if (record.type != TRACE_REQUEST)
+			{
+				if (currentClockCycle >= record.clockCycle)
+				{
+					applyControlRecord();
+				}
+				else
+				{
+					pendingControl = true;
+				}
+			}
+			else
+			{
+				makeTransaction();
+				pendingTrans = (currentClockCycle < record.clockCycle) || !issue();
+			}
+		}
+	}
+	else if (currentClockCycle >= record.clockCycle)
+	{
+		pendingTrans = !issue();
+	}
+}
+
+void TracePlayer::skipTo(uint64_t endCycle, FunctionalModel &model)
+{
+	accepted = NULL;
+
+	// whatever we were holding on to goes first
+	if (pendingControl)
+	{
+		if (record.clockCycle >= endCycle)
+		{
+			return;
+		}
+		model.advanceTo(record.clockCycle);
+		applyControlRecord();
+		pendingControl = false;
+	}
+	else if (pendingTrans)
+	{
+		if (record.clockCycle >= endCycle)
+		{
+			return;
+		}
+		model.advanceTo(record.clockCycle);
+		model.access(trans->address);
+		delete trans;
+		trans = NULL;
+		pendingTrans = false;
+	}
+
+	while (source.next(record))
+	{
+		recordsRead++;
+		if (record.clockCycle >= endCycle)
+		{
+			// this one belongs to the next detailed window
+			if (record.type != TRACE_REQUEST)
+			{
+				pendingControl = true;
+			}
+			else
+			{
+				makeTransaction();
+				pendingTrans = true;
+			}
+			return;
+		}
+
+		model.advanceTo(record.clockCycle);
+		if (record.type != TRACE_REQUEST)
+		{
+			applyControlRecord();
+		}
+		else
+		{
+			unsigned throwAwayBits = memorySystem->getConfig().THROW_AWAY_BITS;
+			model.access((record.address >> throwAwayBits) << throwAwayBits);
+			if (record.data != NULL)
+			{
+				free(record.data);
+			}
+		}
+	}
+}
+
+void TracePlayer::serialize(CheckpointOut &cp) const
+{
+	cp.put(recordsRead);
+	cp.put(record.type);
+	cp.put(record.clockCycle);
+	cp.put(record.transType);
+	cp.put(record.address);
+	cp.put(record.securityDomain);
+	cp.put(record.args);
+	cp.put(record.isData);
+	cp.putTransaction(trans);
+	cp.put(pendingTrans);
+	cp.put(pendingControl);
+}
+
+void TracePlayer::unserialize(CheckpointIn &cp)
+{
+	uint64_t recordsToSkip = 0;
+	cp.get(recordsToSkip);
+	for (recordsRead=0; recordsRead<recordsToSkip && source.next(record); recordsRead++)
+	{
+		if (record.type == TRACE_REQUEST && record.data != NULL)
+		{
+			free(record.data);
+		}
+	}
+
+	cp.get(record.type);
+	cp.get(record.clockCycle);
+	cp.get(record.transType);
+	cp.get(record.address);
+	cp.get(record.securityDomain);
+	cp.get(record.args);
+	cp.get(record.isData);
+	record.data = NULL;
+	delete trans;
+	trans = cp.getTransaction();
+	cp.get(pendingTrans);
+	cp.get(pendingControl);
+}
+
+} // namespace DRAMSim
@@ -0,0 +1,227 @@
+/*********************************************************************************
+*  Copyright (c) 2010-2011, Elliott Cooper-Balis
+*                             Paul Rosenfeld
+*                             Bruce Jacob
+*                             University of Maryland 
+*                             dramninjas [at] gmail [dot] com
+*  All rights reserved.
+*  
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*  
+*     * Redistributions of source code must retain the above copyright notice,
+*        this list of conditions and the following disclaimer.
+*  
+*     * Redistributions in binary form must reproduce the above copyright notice,
+*        this list of conditions and the following disclaimer in the documentation
+*        and/or other materials provided with the distribution.
+*  
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+*  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+*  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+*  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************************/
+
+#ifndef TRACE_H
+#define TRACE_H
+
+//Trace.h
+//
+//Trace file parsing and replay, shared by the trace driven front ends
+//
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <deque>
+
+#include "SystemConfiguration.h"
+#include "Transaction.h"
+#include "Checkpoint.h"
+
+namespace DRAMSim
+{
+class MultiChannelMemorySystem;
+class FunctionalModel;
+
+/**
+ * Control records are only valid in dom_ traces. They are interleaved with
+ * the requests and drive the same defence hooks gem5 calls:
+ *
+ *   START  <cycle> <cpuid> <iDefenceDomain> <dDefenceDomain>
+ *   UPDATE <cycle> <oldDomain> <newDomain> <data|inst>
+ *   END    <cycle>
+ */
+enum TraceRecordType
+{
+	TRACE_REQUEST,
+	TRACE_START_DEFENCE,
+	TRACE_UPDATE_DEFENCE,
+	TRACE_END_DEFENCE
+};
+
+// one parsed line of a trace file
+struct TraceRecord
+{
+	TraceRecordType type;
+	uint64_t clockCycle;
+
+	//requests
+	TransactionType transType;
+	uint64_t address;
+	uint64_t securityDomain;
+	void *data;
+
+	//control records (START: cpuid, iDomain, dDomain; UPDATE: old, new)
+	uint64_t args[3];
+	bool isData;
+};
+
+bool traceTypeFromFilename(const std::string &filename, TraceType &type);
+void parseTraceRecord(std::string &line, TraceType type, bool useClockCycle, TraceRecord &record);
+
+// where a TracePlayer gets its records from
+class TraceSource
+{
+public:
+	virtual ~TraceSource() {}
+	//returns false once the trace is exhausted
+	virtual bool next(TraceRecord &record) = 0;
+};
+
+/**
+ * Binary traces hold the parsed records of a text trace (without write
+ * data), so they are read without any parsing. They start with
+ * BINARY_TRACE_MAGIC and are still named after the text format they came
+ * from (mase_foo.btrc); DRAMSimTraceIndex -b converts a text trace.
+ */
+#define BINARY_TRACE_MAGIC "DRAMSim2 btrace"
+void writeBinaryTraceHeader(std::ostream &out);
+void writeBinaryTraceRecord(CheckpointOut &cp, const TraceRecord &record);
+
+// where a record starts in a trace file
+struct TraceIndexEntry
+{
+	uint64_t record;
+	uint64_t clockCycle;
+	uint64_t offset;
+};
+
+/**
+ * Sidecar index of a text or binary trace (foo.trc.idx), written by
+ * DRAMSimTraceIndex. It has an entry for every stride-th record and one for
+ * every control record, so a TraceFileSource can seek close to a cycle and
+ * still start the defences that are running there.
+ */
+class TraceIndex
+{
+public:
+	TraceIndex();
+	void build(const std::string &traceFilename, TraceType type, unsigned stride);
+	bool save(const std::string &filename) const;
+	// fails if the index is missing or was built for a different file
+	bool load(const std::string &filename, const std::string &traceFilename);
+	// the last entry before clockCycle, or NULL if there is none
+	const TraceIndexEntry *find(uint64_t clockCycle) const;
+
+	std::vector<TraceIndexEntry> entries;
+	std::vector<TraceIndexEntry> controlRecords;
+	uint64_t traceSize;
+	unsigned stride;
+};
+std::string traceIndexFilename(const std::string &traceFilename);
+
+// parses a trace file a line (or binary record) at a time
+class TraceFileSource : public TraceSource
+{
+public:
+	TraceFileSource(const std::string &filename, TraceType type, bool useClockCycle);
+	virtual ~TraceFileSource();
+	bool next(TraceRecord &record);
+	// where the record that next() returns starts
+	uint64_t tell();
+	// drops every request before startCycle; with an index the file is
+	// seeked to the last entry before it instead of parsed from the start
+	void skipTo(uint64_t startCycle, const TraceIndex *index);
+
+private:
+	bool readRecord(TraceRecord &record);
+
+	std::ifstream traceFile;
+	CheckpointIn binaryIn;
+	TraceType traceType;
+	bool useClockCycle;
+	bool binary;
+	uint64_t clockCycle;
+	int lineNumber;
+	uint64_t startCycle;
+	//control records from before the place skipTo() seeked to
+	std::deque<TraceRecord> pendingControl;
+};
+
+// replays a trace that was loaded with loadTrace(); the records are only
+// read, so any number of sources can share one vector. Requests before
+// startCycle are dropped but control records are kept, so the defences that
+// are running at startCycle still get started
+class TraceVectorSource : public TraceSource
+{
+public:
+	TraceVectorSource(const std::vector<TraceRecord> &records, uint64_t startCycle=0);
+	bool next(TraceRecord &record);
+
+private:
+	const std::vector<TraceRecord> &records;
+	size_t position;
+	uint64_t startCycle;
+};
+
+// reads a whole trace into memory; write data is dropped, so the records are
+// only good for timing runs
+void loadTrace(const std::string &filename, TraceType type, bool useClockCycle, std::vector<TraceRecord> &records);
+
+/**
+ * Issues trace records into a memory system. Call update() once per cycle
+ * before the memory system's own update(): a request is held back until its
+ * cycle comes up and then retried every cycle until the memory system
+ * accepts it.
+ */
+class TracePlayer
+{
+public:
+	TracePlayer(MultiChannelMemorySystem *memorySystem, TraceSource &source);
+	~TracePlayer();
+	void update(uint64_t currentClockCycle);
+	// hands every request due before endCycle to model instead of the
+	// memory system; control records are still applied
+	void skipTo(uint64_t endCycle, FunctionalModel &model);
+
+	// saves where we are in the trace; unserialize() skips the source ahead
+	// to the same record, so it must be given a source at its first record
+	void serialize(CheckpointOut &cp) const;
+	void unserialize(CheckpointIn &cp);
+
+	//the request accepted during the last update(), if any
+	const Transaction *accepted;
+
+private:
+	void applyControlRecord();
+	void makeTransaction();
+	bool issue();
+
+	MultiChannelMemorySystem *memorySystem;
+	TraceSource &source;
+	TraceRecord record;
+	Transaction *trans;
+	uint64_t recordsRead;
+	bool pendingTrans;
+	bool pendingControl;
+};
+}
+
+#endif
@@ -47,6 +47,8 @@
 #include "MultiChannelMemorySystem.h"
 #include "Transaction.h"
 #include "IniReader.h"
+#include "Trace.h"
+#include "Sampler.h"
 
 
 using namespace DRAMSim;
@@ -139,7 +141,7 @@ class TransactionReceiver
 void usage()
 {
 	cout << "DRAMSim2 Usage: " << endl;
-	cout << "DRAMSim -t tracefile -s system.ini -d ini/device.ini [-c #] [-p pwd] [-q] [-S 2048] [-n] [-o OPTION_A=1234,tRC=14,tFAW=19]" <<endl;
+	cout << "DRAMSim -t tracefile -s system.ini -d ini/device.ini [-c #] [-p pwd] [-q] [-S 2048] [-n] [-o OPTION_A=1234,tRC=14,tFAW=19] [-D dag0.json;dag1.json] [-R in.ckpt] [-C out.ckpt] [-P 1000000,20000,10000]" <<endl;
 	cout << "\t-t, --tracefile=FILENAME \tspecify a tracefile to run  "<<endl;
 	cout << "\t-s, --systemini=FILENAME \tspecify an ini file that describes the memory system parameters  "<<endl;
 	cout << "\t-d, --deviceini=FILENAME \tspecify an ini file that describes the device-level parameters"<<endl;
@@ -150,188 +152,13 @@ void usage()
 	cout << "\t-S, --size=# \t\t\tSize of the memory system in megabytes [default=2048M]"<<endl;
 	cout << "\t-n, --notiming \t\t\tDo not use the clock cycle information in the trace file"<<endl;
 	cout << "\t-v, --visfile \t\t\tVis output filename"<<endl;
-}
-#endif
-
-void *parseTraceFileLine(string &line, uint64_t &addr, enum TransactionType &transType, uint64_t &clockCycle, TraceType type, bool useClockCycle)
-{
-	size_t previousIndex=0;
-	size_t spaceIndex=0;
-	uint64_t *dataBuffer = NULL;
-	string addressStr="", cmdStr="", dataStr="", ccStr="";
-
-	switch (type)
-	{
-	case k6:
-	{
-		spaceIndex = line.find_first_of(" ", 0);
-
-		addressStr = line.substr(0, spaceIndex);
-		previousIndex = spaceIndex;
-
-		spaceIndex = line.find_first_not_of(" ", previousIndex);
-		cmdStr = line.substr(spaceIndex, line.find_first_of(" ", spaceIndex) - spaceIndex);
-		previousIndex = line.find_first_of(" ", spaceIndex);
-
-		spaceIndex = line.find_first_not_of(" ", previousIndex);
-		ccStr = line.substr(spaceIndex, line.find_first_of(" ", spaceIndex) - spaceIndex);
-
-		if (cmdStr.compare("P_MEM_WR")==0 ||
-		        cmdStr.compare("BOFF")==0)
-		{
-			transType = DATA_WRITE;
-		}
-		else if (cmdStr.compare("P_FETCH")==0 ||
-		         cmdStr.compare("P_MEM_RD")==0 ||
-		         cmdStr.compare("P_LOCK_RD")==0 ||
-		         cmdStr.compare("P_LOCK_WR")==0)
-		{
-			transType = DATA_READ;
-		}
-		else
-		{
-			ERROR("== Unknown Command : "<<cmdStr);
-			exit(0);
-		}
-
-		istringstream a(addressStr.substr(2));//gets rid of 0x
-		a>>hex>>addr;
-
-		//if this is set to false, clockCycle will remain at 0, and every line read from the trace
-		//  will be allowed to be issued
-		if (useClockCycle)
-		{
-			istringstream b(ccStr);
-			b>>clockCycle;
-		}
-		break;
-	}
-	case mase:
-	{
-		spaceIndex = line.find_first_of(" ", 0);
-
-		addressStr = line.substr(0, spaceIndex);
-		previousIndex = spaceIndex;
-
-		spaceIndex = line.find_first_not_of(" ", previousIndex);
-		cmdStr = line.substr(spaceIndex, line.find_first_of(" ", spaceIndex) - spaceIndex);
-		previousIndex = line.find_first_of(" ", spaceIndex);
-
-		spaceIndex = line.find_first_not_of(" ", previousIndex);
-		ccStr = line.substr(spaceIndex, line.find_first_of(" ", spaceIndex) - spaceIndex);
-
-		if (cmdStr.compare("IFETCH")==0||
-		        cmdStr.compare("READ")==0)
-		{
-			transType = DATA_READ;
-		}
-		else if (cmdStr.compare("WRITE")==0)
-		{
-			transType = DATA_WRITE;
-		}
-		else
-		{
-			ERROR("== Unknown command in tracefile : "<<cmdStr);
-		}
-
-		istringstream a(addressStr.substr(2));//gets rid of 0x
-		a>>hex>>addr;
-
-		//if this is set to false, clockCycle will remain at 0, and every line read from the trace
-		//  will be allowed to be issued
-		if (useClockCycle)
-		{
-			istringstream b(ccStr);
-			b>>clockCycle;
-		}
-
-		break;
-	}
-	case misc:
-		spaceIndex = line.find_first_of(" ", spaceIndex+1);
-		if (spaceIndex == string::npos)
-		{
-			ERROR("Malformed line: '"<< line <<"'");
-		}
-
-		addressStr = line.substr(previousIndex,spaceIndex);
-		previousIndex=spaceIndex;
-
-		spaceIndex = line.find_first_of(" ", spaceIndex+1);
-		if (spaceIndex == string::npos)
-		{
-			cmdStr = line.substr(previousIndex+1);
-		}
-		else
-		{
-			cmdStr = line.substr(previousIndex+1,spaceIndex-previousIndex-1);
-			dataStr = line.substr(spaceIndex+1);
-		}
-
-		//convert address string -> number
-		istringstream b(addressStr.substr(2)); //substr(2) chops off 0x characters
-		b >>hex>> addr;
-
-		// parse command
-		if (cmdStr.compare("read") == 0)
-		{
-			transType=DATA_READ;
-		}
-		else if (cmdStr.compare("write") == 0)
-		{
-			transType=DATA_WRITE;
-		}
-		else
-		{
-			ERROR("INVALID COMMAND '"<<cmdStr<<"'");
-			exit(-1);
-		}
-		if (SHOW_SIM_OUTPUT)
-		{
-			DEBUGN("ADDR='"<<hex<<addr<<dec<<"',CMD='"<<transType<<"'");//',DATA='"<<dataBuffer[0]<<"'");
-		}
-
-		//parse data
-		//if we are running in a no storage mode, don't allocate space, just return NULL
-#ifndef NO_STORAGE
-		if (dataStr.size() > 0 && transType == DATA_WRITE)
-		{
-			// 32 bytes of data per transaction
-			dataBuffer = (uint64_t *)calloc(sizeof(uint64_t),4);
-			size_t strlen = dataStr.size();
-			for (int i=0; i < 4; i++)
-			{
-				size_t startIndex = i*16;
-				if (startIndex > strlen)
-				{
-					break;
-				}
-				size_t charsLeft = min(((size_t)16), strlen - startIndex + 1);
-				string piece = dataStr.substr(i*16,charsLeft);
-				istringstream iss(piece);
-				iss >> hex >> dataBuffer[i];
-			}
-			PRINTN("\tDATA=");
-			BusPacket::printData(dataBuffer);
-		}
-
-		PRINT("");
-#endif
-		break;
-	}
-	return dataBuffer;
-}
-
-#ifndef _SIM_
-
-void alignTransactionAddress(Transaction &trans)
-{
-	// zero out the low order bits which correspond to the size of a transaction
-
-	unsigned throwAwayBits = THROW_AWAY_BITS;
-
-	trans.address >>= throwAwayBits;
-	trans.address <<= throwAwayBits;
+	cout << "\t-D, --defence=FILE[;FILE] \tDAG file(s) (json or DRAMSimDagCompile images) used by START records in dom_ traces, indexed by cpuid"<<endl;
+	cout << "\t-R, --restore-checkpoint=FILE \tstart from a checkpoint of the same trace instead of cycle 0"<<endl;
+	cout << "\t-C, --save-checkpoint=FILE \tsave a checkpoint after the last cycle"<<endl;
+	cout << "\t-b, --start-cycle=# \t\tstart at this cycle of the trace; uses <tracefile>.idx from DRAMSimTraceIndex if there is one"<<endl;
+	cout << "\t-e, --end-cycle=# \t\tstop at this cycle of the trace instead of after -c cycles"<<endl;
+	cout << "\t-F, --fast-forward=# \t\tRun the first # cycles on the analytical fast timing model"<<endl;
+	cout << "\t-P, --sample=PERIOD,WARMUP,WINDOW \tonly simulate WARMUP+WINDOW cycles in detail out of every PERIOD, measuring the last WINDOW"<<endl;
 }
 
 /** 
@@ -341,29 +168,7 @@ void alignTransactionAddress(Transaction &trans)
 IniReader::OverrideMap *parseParamOverrides(const string &kv_str)
 {
 	IniReader::OverrideMap *kv_map = new IniReader::OverrideMap(); 
-	size_t start = 0, comma=0, equal_sign=0;
-	// split the commas if they are there
-	while (1)
-	{
-		equal_sign = kv_str.find('=', start); 
-		if (equal_sign == string::npos)
-		{
-			break;
-		}
-
-		comma = kv_str.find(',', equal_sign);
-		if (comma == string::npos)
-		{
-			comma = kv_str.length();
-		}
-
-		string key = kv_str.substr(start, equal_sign-start);
-		string value = kv_str.substr(equal_sign+1, comma-equal_sign-1); 
-
-		(*kv_map)[key] = value; 
-		start = comma+1;
-
-	}
+	IniReader::ParseOverrides(kv_str, *kv_map);
 	return kv_map; 
 }
 
@@ -375,13 +180,19 @@ int main(int argc, char **argv)
 	string systemIniFilename("system.ini");
 	string deviceIniFilename;
 	string pwdString;
-	string *visFilename = NULL;
+	string visFilename;
+	string defenceFilenames;
+	string restoreFilename;
+	string checkpointFilename;
+	uint64_t samplePeriod=0, sampleWarmup=0, sampleWindow=0;
+	uint64_t fastForwardCycles=0;
+	uint64_t traceStartCycle=0, traceEndCycle=0;
 	unsigned megsOfMemory=2048;
 	bool useClockCycle=true;
 	
 	IniReader::OverrideMap *paramOverrides = NULL; 
 
-	unsigned numCycles=1000;
+	uint64_t numCycles=1000;
 	//getopt stuff
 	while (1)
 	{
@@ -398,10 +209,18 @@ int main(int argc, char **argv)
 			{"help", no_argument, 0, 'h'},
 			{"size", required_argument, 0, 'S'},
 			{"visfile", required_argument, 0, 'v'},
+			{"notiming", no_argument, 0, 'n'},
+			{"defence", required_argument, 0, 'D'},
+			{"restore-checkpoint", required_argument, 0, 'R'},
+			{"save-checkpoint", required_argument, 0, 'C'},
+			{"sample", required_argument, 0, 'P'},
+			{"fast-forward", required_argument, 0, 'F'},
+			{"start-cycle", required_argument, 0, 'b'},
+			{"end-cycle", required_argument, 0, 'e'},
 			{0, 0, 0, 0}
 		};
 		int option_index=0; //for getopt
-		c = getopt_long (argc, argv, "t:s:c:d:o:p:S:v:qn", long_options, &option_index);
+		c = getopt_long (argc, argv, "t:s:c:d:o:p:S:v:D:R:C:P:F:b:e:qn", long_options, &option_index);
 		if (c == -1)
 		{
 			break;
@@ -435,7 +254,7 @@ int main(int argc, char **argv)
 			deviceIniFilename = string(optarg);
 			break;
 		case 'c':
-			numCycles = atoi(optarg);
+			numCycles = strtoull(optarg, NULL, 10);
 			break;
 		case 'S':
 			megsOfMemory=atoi(optarg);
@@ -453,7 +272,32 @@ int main(int argc, char **argv)
 			paramOverrides = parseParamOverrides(string(optarg)); 
 			break;
 		case 'v':
-			visFilename = new string(optarg);
+			visFilename = string(optarg);
+			break;
+		case 'D':
+			defenceFilenames = string(optarg);
+			break;
+		case 'R':
+			restoreFilename = string(optarg);
+			break;
+		case 'C':
+			checkpointFilename = string(optarg);
+			break;
+		case 'P':
+			if (sscanf(optarg, "%lu,%lu,%lu", &samplePeriod, &sampleWarmup, &sampleWindow) != 3 || sampleWindow == 0)
+			{
+				ERROR("--sample needs PERIOD,WARMUP,WINDOW");
+				exit(-1);
+			}
+			break;
+		case 'F':
+			fastForwardCycles = strtoull(optarg, NULL, 10);
+			break;
+		case 'b':
+			traceStartCycle = strtoull(optarg, NULL, 10);
+			break;
+		case 'e':
+			traceEndCycle = strtoull(optarg, NULL, 10);
 			break;
 		case '?':
 			usage();
@@ -462,26 +306,9 @@ int main(int argc, char **argv)
 		}
 	}
 
-	// get the trace filename
-	string temp = traceFileName.substr(traceFileName.find_last_of("/")+1);
-
-	//get the prefix of the trace name
-	temp = temp.substr(0,temp.find_first_of("_"));
-	if (temp=="mase")
+	if (!traceTypeFromFilename(traceFileName, traceType))
 	{
-		traceType = mase;
-	}
-	else if (temp=="k6")
-	{
-		traceType = k6;
-	}
-	else if (temp=="misc")
-	{
-		traceType = misc;
-	}
-	else
-	{
-		ERROR("== Unknown Tracefile Type : "<<temp);
+		ERROR("== Unknown Tracefile Type : "<<traceFileName);
 		exit(0);
 	}
 
@@ -503,11 +330,7 @@ int main(int argc, char **argv)
 
 	DEBUG("== Loading trace file '"<<traceFileName<<"' == ");
 
-	ifstream traceFile;
-	string line;
-
-
-	MultiChannelMemorySystem *memorySystem = new MultiChannelMemorySystem(deviceIniFilename, systemIniFilename, pwdString, traceFileName, megsOfMemory, visFilename, paramOverrides);
+	MultiChannelMemorySystem *memorySystem = new MultiChannelMemorySystem(deviceIniFilename, systemIniFilename, pwdString, traceFileName, defenceFilenames, "", megsOfMemory, visFilename, paramOverrides);
 	// set the frequency ratio to 1:1
 	memorySystem->setCPUClockSpeed(0); 
 
@@ -524,92 +347,122 @@ int main(int argc, char **argv)
 #endif
 
 
-	uint64_t addr;
-	uint64_t clockCycle=0;
-	enum TransactionType transType;
+	TraceFileSource traceSource(traceFileName, traceType, useClockCycle);
+	TracePlayer tracePlayer(memorySystem, traceSource);
 
-	void *data = NULL;
-	int lineNumber = 0;
-	Transaction *trans=NULL;
-	bool pendingTrans = false;
-
-	traceFile.open(traceFileName.c_str());
+	// the checkpoint holds the memory system followed by our place in the trace
+	if (restoreFilename.length() > 0)
+	{
+		ifstream checkpointFile(restoreFilename.c_str(), ios::binary);
+		CheckpointIn cp(checkpointFile);
+		if (!checkpointFile.is_open() || !memorySystem->unserialize(cp))
+		{
+			ERROR("== Error - Could not restore checkpoint "<<restoreFilename);
+			exit(-1);
+		}
+		tracePlayer.unserialize(cp);
+		DEBUG("== Restored checkpoint '"<<restoreFilename<<"' at cycle "<<memorySystem->currentClockCycle<<" == ");
+	}
 
-	if (!traceFile.is_open())
+	if (traceStartCycle > 0)
 	{
-		cout << "== Error - Could not open trace file"<<endl;
-		exit(0);
+		if (restoreFilename.length() > 0 || !useClockCycle)
+		{
+			ERROR("--start-cycle can't be used with --restore-checkpoint or --notiming");
+			exit(-1);
+		}
+		TraceIndex traceIndex;
+		if (traceIndex.load(traceIndexFilename(traceFileName), traceFileName))
+		{
+			traceSource.skipTo(traceStartCycle, &traceIndex);
+		}
+		else
+		{
+			DEBUG("== No index for the trace, reading up to cycle "<<traceStartCycle<<" == ");
+			traceSource.skipTo(traceStartCycle, NULL);
+		}
+		// the memory system starts empty at the same cycle as the trace
+		memorySystem->skipCycles(traceStartCycle);
 	}
 
-	for (size_t i=0;i<numCycles;i++)
+	uint64_t startCycle = memorySystem->currentClockCycle;
+	if (traceEndCycle > 0)
 	{
-		if (!pendingTrans)
+		if (traceEndCycle <= startCycle)
 		{
-			if (!traceFile.eof())
-			{
-				getline(traceFile, line);
+			ERROR("--end-cycle has to be after the start cycle ("<<startCycle<<")");
+			exit(-1);
+		}
+		numCycles = traceEndCycle - startCycle;
+	}
 
-				if (line.size() > 0)
-				{
-					data = parseTraceFileLine(line, addr, transType,clockCycle, traceType,useClockCycle);
-					trans = new Transaction(transType, addr, data);
-					alignTransactionAddress(*trans); 
-
-					if (i>=clockCycle)
-					{
-						if (!(*memorySystem).addTransaction(trans))
-						{
-							pendingTrans = true;
-						}
-						else
-						{
+	if (fastForwardCycles > 0)
+	{
+		if (!memorySystem->setFastTiming(true))
+		{
+			ERROR("Could not switch to fast timing");
+			exit(-1);
+		}
+		uint64_t endCycle = startCycle + min(fastForwardCycles, numCycles);
+		for (uint64_t i=startCycle;i<endCycle;i++)
+		{
+			tracePlayer.update(i);
 #ifdef RETURN_TRANSACTIONS
-							transactionReceiver.add_pending(trans, i); 
-#endif
-							// the memory system accepted our request so now it takes ownership of it
-							trans = NULL; 
-						}
-					}
-					else
-					{
-						pendingTrans = true;
-					}
-				}
-				else
-				{
-					DEBUG("WARNING: Skipping line "<<lineNumber<< " ('" << line << "') in tracefile");
-				}
-				lineNumber++;
-			}
-			else
+			if (tracePlayer.accepted)
 			{
-				//we're out of trace, set pending=false and let the thing spin without adding transactions
-				pendingTrans = false; 
+				transactionReceiver.add_pending(*tracePlayer.accepted, i); 
 			}
+#endif
+
+			(*memorySystem).update();
 		}
+		memorySystem->setFastTiming(false);
+		numCycles -= endCycle - startCycle;
+		startCycle = endCycle;
+	}
 
-		else if (pendingTrans && i >= clockCycle)
+	if (samplePeriod > 0)
+	{
+		// without cycles in the trace everything would be due at once
+		if (!useClockCycle)
 		{
-			pendingTrans = !(*memorySystem).addTransaction(trans);
-			if (!pendingTrans)
-			{
+			ERROR("--sample can't be used with --notiming");
+			exit(-1);
+		}
+		Sampler sampler(memorySystem, tracePlayer, samplePeriod, sampleWarmup, sampleWindow);
+		sampler.run(startCycle, numCycles);
+		sampler.printStats();
+	}
+	else
+	{
+		for (uint64_t i=startCycle;i<startCycle+numCycles;i++)
+		{
+			tracePlayer.update(i);
 #ifdef RETURN_TRANSACTIONS
-				transactionReceiver.add_pending(trans, i); 
-#endif
-				trans=NULL;
+			if (tracePlayer.accepted)
+			{
+				transactionReceiver.add_pending(*tracePlayer.accepted, i); 
 			}
-		}
+#endif
 
-		(*memorySystem).update();
+			(*memorySystem).update();
+		}
 	}
 
-	traceFile.close();
-	memorySystem->printStats(true);
-	// make valgrind happy
-	if (trans)
+	if (checkpointFilename.length() > 0)
 	{
-		delete trans;
+		ofstream checkpointFile(checkpointFilename.c_str(), ios::binary);
+		CheckpointOut cp(checkpointFile);
+		memorySystem->serialize(cp);
+		tracePlayer.serialize(cp);
+		if (!checkpointFile.is_open() || !cp.good())
+		{
+			ERROR("== Error - Could not write checkpoint "<<checkpointFilename);
+			exit(-1);
+		}
 	}
+
+	memorySystem->printStats(true);
 	delete(memorySystem);
 }
 #endif
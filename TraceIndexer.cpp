@@ -0,0 +1,164 @@
+/*********************************************************************************
+*  Copyright (c) 2010-2011, Elliott Cooper-Balis
+*                             Paul Rosenfeld
+*                             Bruce Jacob
+*                             University of Maryland 
+*                             dramninjas [at] gmail [dot] com
+*  All rights reserved.
+*  
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*  
+*     * Redistributions of source code must retain the above copyright notice,
+*        this list of conditions and the following disclaimer.
+*  
+*     * Redistributions in binary form must reproduce the above copyright notice,
+*        this list of conditions and the following disclaimer in the documentation
+*        and/or other materials provided with the distribution.
+*  
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+*  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+*  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+*  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************************/
+
+
+
+
+//TraceIndexer.cpp
+//
+//Builds the seek index of a trace file and converts text traces to binary
+//
+
+#include <iostream>
+#include <fstream>
+#include <getopt.h>
+
+#include "SystemConfiguration.h"
+#include "Trace.h"
+
+
+using namespace DRAMSim;
+using namespace std;
+
+int SHOW_SIM_OUTPUT = 1;
+
+void usage()
+{
+	cout << "DRAMSimTraceIndex Usage: " << endl;
+	cout << "DRAMSimTraceIndex [-s #] [-b binary.btrc] tracefile" <<endl;
+	cout << "\t-s, --stride=# \t\t\tindex every #th record [default=10000]"<<endl;
+	cout << "\t-b, --binary=FILENAME \t\tconvert the trace to a binary trace and index that instead"<<endl;
+	cout << "The index is written next to the trace as <tracefile>.idx"<<endl;
+}
+
+// write data isn't kept, so binary traces are only good for timing runs
+void convertTrace(const string &traceFilename, TraceType type, const string &binaryFilename)
+{
+	ofstream binaryFile(binaryFilename.c_str(), ios::binary);
+	if (!binaryFile.is_open())
+	{
+		ERROR("== Error - Could not open "<<binaryFilename<<" for writing");
+		exit(-1);
+	}
+	writeBinaryTraceHeader(binaryFile);
+	CheckpointOut cp(binaryFile);
+
+	TraceFileSource source(traceFilename, type, true);
+	TraceRecord record = TraceRecord();
+	uint64_t numRecords = 0;
+	while (source.next(record))
+	{
+		writeBinaryTraceRecord(cp, record);
+		if (record.type == TRACE_REQUEST && record.data != NULL)
+		{
+			free(record.data);
+			record.data = NULL;
+		}
+		numRecords++;
+	}
+	if (!cp.good())
+	{
+		ERROR("== Error - Could not write "<<binaryFilename);
+		exit(-1);
+	}
+	DEBUG("== Wrote "<<numRecords<<" records to '"<<binaryFilename<<"' == ");
+}
+
+int main(int argc, char **argv)
+{
+	int c;
+	string binaryFilename;
+	unsigned stride = 10000;
+
+	while (1)
+	{
+		static struct option long_options[] =
+		{
+			{"stride", required_argument, 0, 's'},
+			{"binary", required_argument, 0, 'b'},
+			{"help", no_argument, 0, 'h'},
+			{0, 0, 0, 0}
+		};
+		int option_index=0; //for getopt
+		c = getopt_long (argc, argv, "s:b:h", long_options, &option_index);
+		if (c == -1)
+		{
+			break;
+		}
+		switch (c)
+		{
+		case 'h':
+			usage();
+			exit(0);
+			break;
+		case 's':
+			stride = atoi(optarg);
+			break;
+		case 'b':
+			binaryFilename = string(optarg);
+			break;
+		case '?':
+			usage();
+			exit(-1);
+			break;
+		}
+	}
+
+	if (optind != argc - 1 || stride == 0)
+	{
+		usage();
+		exit(-1);
+	}
+
+	string traceFilename(argv[optind]);
+	TraceType traceType;
+	if (!traceTypeFromFilename(traceFilename, traceType))
+	{
+		ERROR("== Unknown Tracefile Type : "<<traceFilename);
+		exit(-1);
+	}
+
+	if (binaryFilename.length() > 0)
+	{
+		convertTrace(traceFilename, traceType, binaryFilename);
+		traceFilename = binaryFilename;
+	}
+
+	TraceIndex index;
+	index.build(traceFilename, traceType, stride);
+	string indexFilename = traceIndexFilename(traceFilename);
+	if (!index.save(indexFilename))
+	{
+		ERROR("== Error - Could not write "<<indexFilename);
+		exit(-1);
+	}
+	DEBUG("== Wrote "<<index.entries.size()<<" entries and "<<index.controlRecords.size()<<" control records to '"<<indexFilename<<"' == ");
+	return 0;
+}
@@ -48,6 +48,8 @@ Transaction::Transaction(TransactionType transType, uint64_t addr, void *dat, ui
 	address(addr),
 	data(dat),
 	securityDomain(securityDomain),
+	timeAdded(0),
+	timeReturned(0),
 	nodeID(nodeID),
 	isFake(isFake),
 	fakeBank(fakeBank)
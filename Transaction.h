@@ -70,7 +70,7 @@ public:
 	Transaction(TransactionType transType, uint64_t addr, void *data, uint64_t securityDomain, int nodeID, bool isFake, int fakeBank);
 	Transaction(const Transaction &t);
 
-	BusPacketType getBusPacketType()
+	BusPacketType getBusPacketType(RowBufferPolicy rowBufferPolicy)
 	{
 		switch (transactionType)
 		{
@@ -58,11 +58,12 @@ int some_object::add_one_and_run(MultiChannelMemorySystem *mem, uint64_t addr)
 
 	/* create a transaction and add it */
 	bool isWrite = false; 
-	mem->addTransaction(isWrite, addr);
+	uint64_t domain = 0; 
+	mem->addTransaction(isWrite, addr, domain);
 
 	// send a read to channel 1 on the same cycle 
 	addr = 1LL<<33 | addr; 
-	mem->addTransaction(isWrite, addr);
+	mem->addTransaction(isWrite, addr, domain);
 
 	for (int i=0; i<5; i++)
 	{
@@ -74,7 +75,7 @@ int some_object::add_one_and_run(MultiChannelMemorySystem *mem, uint64_t addr)
 	// send a write to channel 0 
 	addr = 0x900012; 
 	isWrite = true; 
-	mem->addTransaction(isWrite, addr);
+	mem->addTransaction(isWrite, addr, domain);
 	
 
 	/* do a bunch of updates (i.e. clocks) -- at some point the callback will fire */
@@ -96,11 +97,12 @@ int main()
 	TransactionCompleteCB *write_cb = new Callback<some_object, void, unsigned, uint64_t, uint64_t>(&obj, &some_object::write_complete);
 
 	/* pick a DRAM part to simulate */
-	MultiChannelMemorySystem *mem = getMemorySystemInstance("ini/DDR2_micron_16M_8b_x8_sg3E.ini", "system.ini", "..", "example_app", 16384); 
+	MultiChannelMemorySystem *mem = getMemorySystemInstance("ini/DDR2_micron_16M_8b_x8_sg3E.ini", "system.ini", "..", "example_app", "", "", 16384); 
 
 
 	mem->RegisterCallbacks(read_cb, write_cb, power_callback);
-	MultiChannelMemorySystem *mem2 = getMemorySystemInstance("ini/DDR2_micron_16M_8b_x8_sg3E.ini", "system.ini", "..", "example_app", 16384); 
+	/* each instance has its own configuration, so the second one can be a different part */
+	MultiChannelMemorySystem *mem2 = getMemorySystemInstance("ini/DDR3_micron_32M_8B_x8_sg15.ini", "system.ini", "..", "example_app", "", "", 16384); 
 
 	mem2->RegisterCallbacks(read_cb, write_cb, power_callback);
 